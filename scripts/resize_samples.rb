@@ -6,6 +6,10 @@
 #
 # This script depends on libvips and ruby-vips.
 #
+# The collector can produce the resized samples during sampling instead
+# if the sizes are given in the setting window (`sample-resize-sizes` in the setting file).
+# This script is kept for the samples collected before.
+#
 
 
 require 'vips'
@@ -1,5 +1,7 @@
 #!/usr/bin/ruby -w
 
+# `bin/checker --fix` does the same for all labels and checks the images themselves as well.
+
 NAME = 'K'
 
 BMP_DIR = "../samples/#{NAME}/BMP"
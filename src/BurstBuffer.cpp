@@ -0,0 +1,66 @@
+#include "BurstBuffer.hpp"
+
+#include <algorithm>
+
+BurstBuffer::BurstBuffer(const int &capacity) :
+    _head(0),
+    _size(0)
+{
+    setCapacity(capacity);
+}
+
+void BurstBuffer::setCapacity(const int &capacity)
+{
+    const std::size_t n = static_cast<std::size_t>(std::max(0, capacity));
+    if (n == _slots.size())
+        return;
+    _slots = std::vector<SampleCollector::Sample>(n);
+    _still.assign(n, false);
+    clear();
+}
+
+int BurstBuffer::capacity() const
+{
+    return static_cast<int>(_slots.size());
+}
+
+int BurstBuffer::size() const
+{
+    return _size;
+}
+
+void BurstBuffer::push(const cv::Mat &orig_img, const cv::Mat &proc_img, const SampleManifest::Record &record, const bool &still)
+{
+    if (_slots.empty())
+        return;
+    // _head is the oldest frame once the buffer is full
+    auto &slot = _slots[_head];
+    orig_img.copyTo(slot.orig_img);
+    proc_img.copyTo(slot.proc_img);
+    slot.record = record;
+    _still[_head] = still;
+    _head = (_head + 1) % capacity();
+    if (_size < capacity())
+        ++_size;
+}
+
+void BurstBuffer::take(std::vector<SampleCollector::Sample> &samples, const bool &still_only, const int &max_amount)
+{
+    samples.clear();
+    const int first = (_head - _size + capacity()) % std::max(1, capacity());
+    for (int i = 0; i < _size; ++i)
+    {
+        const int index = (first + i) % capacity();
+        if (!still_only || _still[index])
+            samples.push_back(_slots[index]);
+    }
+    if (static_cast<int>(samples.size()) > max_amount)
+        samples.erase(samples.begin(), samples.end() - std::max(0, max_amount));
+    clear();
+}
+
+void BurstBuffer::clear()
+{
+    _head = 0;
+    _size = 0;
+}
@@ -0,0 +1,74 @@
+#ifndef BURSTBUFFER_H
+#define BURSTBUFFER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The BurstBuffer.hpp file contains the ring buffer keeping the latest detected frames for a burst of samples.
+ */
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "config.h"
+#include "SampleCollector.hpp"
+
+/**
+ * @brief The BurstBuffer class keeps the latest frames on which a hand was detected, as samples ready to be stored,
+ *        so that the frames captured just before sampling starts are not lost.
+ *
+ * The slots are allocated once. A frame pushed into a full buffer replaces the oldest one, reusing the memory of
+ * its images as long as the region of interesting keeps its size, so that filling the buffer at the camera rate
+ * allocates nothing.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ */
+class BurstBuffer
+{
+public:
+    /**
+     * @brief BurstBuffer is the constructor.
+     * @param capacity : the number of frames kept
+     */
+    explicit BurstBuffer(const int &capacity = 0);
+
+    /**
+     * @brief setCapacity sets the number of frames kept. The buffer is cleared if it changes.
+     */
+    void setCapacity(const int &capacity);
+    /**
+     * @brief capacity returns the number of frames kept.
+     */
+    int capacity() const;
+    /**
+     * @brief size returns the number of frames in the buffer.
+     */
+    int size() const;
+    /**
+     * @brief push copies a frame into the buffer, replacing the oldest one if the buffer is full.
+     * @param orig_img : the original sample image
+     * @param proc_img : the processed sample image
+     * @param record : the metadata of the sample
+     * @param still : if the hand stayed still on this frame, see #StabilityTrigger
+     */
+    void push(const cv::Mat &orig_img, const cv::Mat &proc_img, const SampleManifest::Record &record, const bool &still);
+    /**
+     * @brief take moves out the frames, from the oldest to the latest, and clears the buffer.
+     * @param samples : the frames, whose images share the memory of the buffer until the next push
+     * @param still_only : take only the frames on which the hand stayed still
+     * @param max_amount : the maximum amount of frames taken, of which the latest ones are taken
+     */
+    void take(std::vector<SampleCollector::Sample> &samples, const bool &still_only, const int &max_amount);
+    /**
+     * @brief clear drops all frames but keeps the memory.
+     */
+    void clear();
+
+private:
+    std::vector<SampleCollector::Sample> _slots;
+    std::vector<bool> _still;
+    int _head;
+    int _size;
+};
+
+#endif // BURSTBUFFER_H
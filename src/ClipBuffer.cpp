@@ -0,0 +1,70 @@
+#include "ClipBuffer.hpp"
+
+#include <algorithm>
+
+ClipBuffer::ClipBuffer(const int &length) :
+    _size(0)
+{
+    setLength(length);
+}
+
+void ClipBuffer::setLength(const int &length)
+{
+    const std::size_t n = static_cast<std::size_t>(std::max(0, length));
+    if (n == _masks.size())
+        return;
+    _masks = std::vector<cv::Mat>(n);
+    _timestamps.assign(n, 0);
+    clear();
+}
+
+int ClipBuffer::length() const
+{
+    return static_cast<int>(_masks.size());
+}
+
+int ClipBuffer::size() const
+{
+    return _size;
+}
+
+bool ClipBuffer::push(const cv::Mat &hand_mask, const cv::Rect &hand_bound, const cv::Rect &roi, const qint64 &timestamp)
+{
+    if (_masks.empty())
+        return false;
+    if (_size == length() || (_size > 0 && roi != _roi))
+        _size = 0;
+    if (_size == 0)
+        _roi = roi;
+
+    // the memory of the slot is reused as long as the region of interesting keeps its size
+    cv::Mat &mask = _masks[_size];
+    mask.create(roi.height, roi.width, CV_8UC1);
+    mask.setTo(cv::Scalar(0));
+    const cv::Rect bound = hand_bound & cv::Rect(0, 0, roi.width, roi.height);
+    if (bound.area() > 0 && hand_mask.size() == hand_bound.size())
+        hand_mask(cv::Rect(bound.x - hand_bound.x, bound.y - hand_bound.y, bound.width, bound.height))
+                .copyTo(mask(bound));
+    _timestamps[_size] = timestamp;
+    return ++_size == length();
+}
+
+void ClipBuffer::clear()
+{
+    _size = 0;
+}
+
+const std::vector<cv::Mat> &ClipBuffer::masks() const
+{
+    return _masks;
+}
+
+const std::vector<qint64> &ClipBuffer::timestamps() const
+{
+    return _timestamps;
+}
+
+cv::Point ClipBuffer::offset() const
+{
+    return _roi.tl();
+}
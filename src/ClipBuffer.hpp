@@ -0,0 +1,89 @@
+#ifndef CLIPBUFFER_H
+#define CLIPBUFFER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ClipBuffer.hpp file contains the buffer assembling consecutive hand masks into a clip.
+ */
+#include <QtGlobal>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "config.h"
+
+/**
+ * @brief The ClipBuffer class assembles the hand masks of consecutive frames into a clip of a fixed length
+ *        for dynamic gestures.
+ *
+ * The mask of each frame covers the whole region of interesting, on which the hand mask, e.g.
+ * #HandDetector::extracted_img cropped to the hand bound, is placed, so that all masks of a clip have the same size
+ * however the hand moves. A clip is restarted if the region of interesting moves or changes in size, and should
+ * be restarted by #ClipBuffer::clear if a frame is skipped, e.g. no hand is detected on it.
+ * The masks are copied into slots allocated once, whose memory is reused by the following clips.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ *
+ * @see #SampleCollector::sampleClip
+ */
+class ClipBuffer
+{
+public:
+    /**
+     * @brief ClipBuffer is the constructor.
+     * @param length : the number of frames in a clip
+     */
+    explicit ClipBuffer(const int &length = 0);
+
+    /**
+     * @brief setLength sets the number of frames in a clip. The buffer is cleared if it changes.
+     */
+    void setLength(const int &length);
+    /**
+     * @brief length returns the number of frames in a clip, or 0 if no clip is assembled.
+     */
+    int length() const;
+    /**
+     * @brief size returns the number of frames of the current clip in the buffer.
+     */
+    int size() const;
+    /**
+     * @brief push copies the hand mask of the next frame into the current clip, or starts a new clip if the last one
+     *        was completed.
+     * @param hand_mask : the mask cropped to the hand bound
+     * @param hand_bound : the position of the hand mask on the region of interesting
+     * @param roi : the region of interesting on the frame
+     * @param timestamp : the time, in milliseconds since epoch, when the frame was captured
+     * @retval true : the clip is completed, and can be taken by #ClipBuffer::masks and the other getters
+     * @retval false : more frames are needed
+     */
+    bool push(const cv::Mat &hand_mask, const cv::Rect &hand_bound, const cv::Rect &roi, const qint64 &timestamp);
+    /**
+     * @brief clear drops the current clip but keeps the memory.
+     */
+    void clear();
+    /**
+     * @brief masks returns the masks of the completed clip, of the size of the region of interesting,
+     *        which are overwritten by the next push.
+     */
+    const std::vector<cv::Mat> &masks() const;
+    /**
+     * @brief timestamps returns the timestamps of the completed clip.
+     */
+    const std::vector<qint64> &timestamps() const;
+    /**
+     * @brief offset returns the position of the masks of the completed clip on the frames,
+     *        i.e. the top-left corner of the region of interesting.
+     */
+    cv::Point offset() const;
+
+private:
+    std::vector<cv::Mat> _masks;
+    std::vector<qint64> _timestamps;
+    cv::Rect _roi;
+    int _size;
+};
+
+#endif // CLIPBUFFER_H
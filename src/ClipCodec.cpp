@@ -0,0 +1,228 @@
+#include "ClipCodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const uchar CLIP_MAGIC[4] = {'G', 'S', 'C', 'C'};
+    const uint16_t CLIP_VERSION = 1;
+    const size_t CLIP_HEADER_SIZE = 24;
+    // refuse to decode absurd dimensions from a corrupted header
+    const uint64_t CLIP_MAX_BITS = uint64_t(1) << 36;
+
+    inline size_t wordsPerFrame(const int &width, const int &height)
+    {
+        return (size_t(width)*height + 63)/64;
+    }
+
+    inline int ctz64(const uint64_t &x)
+    {
+#if defined(__GNUC__)
+        return __builtin_ctzll(x);
+#else
+        int n = 0;
+        for (uint64_t v = x; (v & 1) == 0; v >>= 1)
+            ++n;
+        return n;
+#endif
+    }
+
+    inline void putLE(std::vector<uchar> &buffer, uint64_t v, const int &bytes)
+    {
+        for (int i = 0; i < bytes; ++i, v >>= 8)
+            buffer.push_back(static_cast<uchar>(v));
+    }
+
+    inline uint64_t getLE(const uchar *p, const int &bytes)
+    {
+        uint64_t v = 0;
+        for (int i = bytes - 1; i >= 0; --i)
+            v = (v << 8) | p[i];
+        return v;
+    }
+
+    inline void putVarint(std::vector<uchar> &buffer, uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            buffer.push_back(static_cast<uchar>(v | 0x80));
+            v >>= 7;
+        }
+        buffer.push_back(static_cast<uchar>(v));
+    }
+
+    inline bool getVarint(const uchar *&p, const uchar *end, uint64_t &v)
+    {
+        v = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7)
+        {
+            const uchar b = *p++;
+            v |= uint64_t(b & 0x7F) << shift;
+            if ((b & 0x80) == 0)
+                return true;
+        }
+        return false;
+    }
+
+    void pack(const cv::Mat &mask, std::vector<uint64_t> &words)
+    {
+        std::fill(words.begin(), words.end(), 0);
+        size_t i = 0;
+        for (int y = 0; y < mask.rows; ++y)
+        {
+            const uchar *p = mask.ptr<uchar>(y);
+            for (int x = 0; x < mask.cols; ++x, ++i)
+                if (p[x] != 0)
+                    words[i >> 6] |= uint64_t(1) << (i & 63);
+        }
+    }
+
+    void unpack(const uint64_t *words, cv::Mat &mask)
+    {
+        size_t i = 0;
+        for (int y = 0; y < mask.rows; ++y)
+        {
+            uchar *p = mask.ptr<uchar>(y);
+            for (int x = 0; x < mask.cols; ++x, ++i)
+                p[x] = (words[i >> 6] >> (i & 63)) & 1 ? 255 : 0;
+        }
+    }
+
+    void setBits(std::vector<uint64_t> &words, uint64_t pos, uint64_t run)
+    {
+        while (run > 0)
+        {
+            const int offset = static_cast<int>(pos & 63);
+            const int n = static_cast<int>(std::min<uint64_t>(run, 64 - offset));
+            words[pos >> 6] |= (n == 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1) << offset;
+            pos += n;
+            run -= n;
+        }
+    }
+}
+
+bool ClipCodec::isClip(const uchar *data, const size_t &size)
+{
+    return size >= CLIP_HEADER_SIZE && std::memcmp(data, CLIP_MAGIC, sizeof(CLIP_MAGIC)) == 0;
+}
+
+bool ClipCodec::encode(const Clip &clip, std::vector<uchar> &buffer)
+{
+    const size_t frames = clip.masks.size();
+    if (frames == 0 || frames > 0xFFFF || clip.timestamps.size() != frames)
+        return false;
+    const cv::Size size = clip.masks.front().size();
+    if (size.width < 1 || size.height < 1 || size.width > 0xFFFF || size.height > 0xFFFF)
+        return false;
+    for (const auto &m : clip.masks)
+        if (m.size() != size || m.type() != CV_8UC1)
+            return false;
+
+    const size_t words = wordsPerFrame(size.width, size.height);
+    buffer.clear();
+    // masks usually take a few runs per row and change a little between frames
+    buffer.reserve(CLIP_HEADER_SIZE + 8*frames + frames*size.height*4);
+    buffer.insert(buffer.end(), CLIP_MAGIC, CLIP_MAGIC + sizeof(CLIP_MAGIC));
+    putLE(buffer, CLIP_VERSION, 2);
+    putLE(buffer, frames, 2);
+    putLE(buffer, size.width, 2);
+    putLE(buffer, size.height, 2);
+    putLE(buffer, static_cast<uint16_t>(clip.offset.x), 2);
+    putLE(buffer, static_cast<uint16_t>(clip.offset.y), 2);
+    putLE(buffer, 0, 4); // payload size, filled at last
+    putLE(buffer, 0, 4);
+    for (const auto &t : clip.timestamps)
+        putLE(buffer, static_cast<uint64_t>(t), 8);
+
+    const size_t payload = buffer.size();
+    std::vector<uint64_t> prev(words, 0), curr(words);
+    uint64_t run = 0;
+    bool bit = false;
+    for (const auto &m : clip.masks)
+    {
+        pack(m, curr);
+        for (size_t i = 0; i < words; ++i)
+        {
+            const uint64_t w = curr[i] ^ prev[i];
+            // look for the next bit differing from the current run, a whole word at a time
+            int pos = 0;
+            while (pos < 64)
+            {
+                const uint64_t x = (bit ? ~w : w) >> pos;
+                if (x == 0)
+                {
+                    run += 64 - pos;
+                    break;
+                }
+                const int n = ctz64(x);
+                run += n;
+                pos += n;
+                putVarint(buffer, run);
+                run = 0;
+                bit = !bit;
+            }
+        }
+        prev.swap(curr);
+    }
+    putVarint(buffer, run);
+
+    const uint64_t payload_size = buffer.size() - payload;
+    if (payload_size > 0xFFFFFFFF)
+        return false;
+    for (int i = 0; i < 4; ++i)
+        buffer[16 + i] = static_cast<uchar>(payload_size >> (8*i));
+    return true;
+}
+
+bool ClipCodec::decode(const uchar *data, const size_t &size, Clip &clip)
+{
+    if (!isClip(data, size) || getLE(data + 4, 2) != CLIP_VERSION)
+        return false;
+    const size_t frames = getLE(data + 6, 2);
+    const int width = static_cast<int>(getLE(data + 8, 2));
+    const int height = static_cast<int>(getLE(data + 10, 2));
+    const uint64_t payload_size = getLE(data + 16, 4);
+    if (frames == 0 || width == 0 || height == 0 ||
+            size != CLIP_HEADER_SIZE + 8*frames + payload_size)
+        return false;
+    const size_t words = wordsPerFrame(width, height);
+    const uint64_t total = uint64_t(frames)*words*64;
+    if (total > CLIP_MAX_BITS)
+        return false;
+
+    clip.offset.x = static_cast<int16_t>(getLE(data + 12, 2));
+    clip.offset.y = static_cast<int16_t>(getLE(data + 14, 2));
+    clip.timestamps.resize(frames);
+    for (size_t t = 0; t < frames; ++t)
+        clip.timestamps[t] = static_cast<int64_t>(getLE(data + CLIP_HEADER_SIZE + 8*t, 8));
+
+    std::vector<uint64_t> bits(frames*words, 0);
+    const uchar *p = data + CLIP_HEADER_SIZE + 8*frames;
+    const uchar *end = p + payload_size;
+    uint64_t pos = 0;
+    bool bit = false;
+    while (pos < total)
+    {
+        uint64_t run;
+        if (!getVarint(p, end, run) || run > total - pos)
+            return false;
+        if (bit)
+            setBits(bits, pos, run);
+        pos += run;
+        bit = !bit;
+    }
+    if (p != end)
+        return false;
+
+    // undo the deltas between consecutive frames
+    for (size_t i = words; i < bits.size(); ++i)
+        bits[i] ^= bits[i - words];
+    clip.masks.resize(frames);
+    for (size_t t = 0; t < frames; ++t)
+    {
+        clip.masks[t].create(height, width, CV_8UC1);
+        unpack(bits.data() + t*words, clip.masks[t]);
+    }
+    return true;
+}
@@ -0,0 +1,85 @@
+#ifndef CLIPCODEC_H
+#define CLIPCODEC_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ClipCodec.hpp file contains the encoder and decoder of sample clips, sequences of hand masks.
+ */
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The ClipCodec class encodes and decodes clips of consecutive binary hand masks for dynamic gestures.
+ *
+ * A clip of T frames of W x H masks is stored as one record of T x H x W bits. Each mask is packed into 64-bit words,
+ * one bit per pixel in row-major order with each frame padded to whole words, and XOR-ed with the previous frame,
+ * so that only the pixels changed between two frames are set. The resulting bits are run-length encoded as the
+ * lengths of alternating runs of 0s and 1s, starting with 0s, each in an unsigned LEB128 varint.
+ *
+ * The record consists of a 24-byte header, the timestamps of the frames and the encoded bits.
+ * All numbers are little-endian.
+ *
+ * | offset | type        | field                                                   |
+ * |--------|-------------|---------------------------------------------------------|
+ * | 0      | char x 4    | magic, `GSCC`                                           |
+ * | 4      | uint16      | format version                                          |
+ * | 6      | uint16      | number of frames, T                                     |
+ * | 8      | uint16 x 2  | width and height of the masks                           |
+ * | 12     | int16 x 2   | position of the masks, i.e. the region of interesting, on the frames |
+ * | 16     | uint32      | size of the encoded bits in bytes                       |
+ * | 20     | uint32      | reserved, 0                                             |
+ * | 24     | int64 x T   | timestamps of the frames in milliseconds since epoch    |
+ * | 24+8T  | varint ...  | the encoded bits                                        |
+ *
+ * A clip is thus read by one sequential read of its file.
+ */
+class ClipCodec
+{
+public:
+    /**
+     * @brief The Clip struct is a sequence of hand masks with their timing.
+     */
+    struct Clip
+    {
+        /**
+         * @brief masks is the binary masks of the same size, in which nonzero pixels belong to the hand.
+         *        The decoded masks are 0 or 255.
+         */
+        std::vector<cv::Mat> masks;
+        /**
+         * @brief timestamps is the time, in milliseconds since epoch, when each frame was captured.
+         */
+        std::vector<int64_t> timestamps;
+        /**
+         * @brief offset is the position of the masks on the frames.
+         */
+        cv::Point offset;
+    };
+
+    /**
+     * @brief encode encodes a clip.
+     * @param clip : the clip, of at most 65535 single-channel 8-bit masks no larger than 65535 x 65535
+     * @param buffer : the encoded file content
+     * @retval true : successfully encoded
+     * @retval false : the clip is empty, or its masks or timestamps mismatch
+     */
+    static bool encode(const Clip &clip, std::vector<uchar> &buffer);
+    /**
+     * @brief decode decodes a clip file.
+     * @param data : the file content
+     * @param size : size of the file content in bytes
+     * @param clip : the decoded clip
+     * @retval true : successfully decoded
+     * @retval false : the content is not a valid clip file
+     */
+    static bool decode(const uchar *data, const size_t &size, Clip &clip);
+    /**
+     * @brief isClip tells if the given content starts with the clip magic.
+     */
+    static bool isClip(const uchar *data, const size_t &size);
+};
+
+#endif // CLIPCODEC_H
@@ -1,69 +1,188 @@
 #include "CvQtImgConvertor.hpp"
 
+#include <QPixmapCache>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#  include <tmmintrin.h>
+#  define CVQT_SSSE3 __attribute__((target("ssse3")))
+#elif defined(_MSC_VER) && defined(_M_X64)
+#  include <tmmintrin.h>
+#  define CVQT_SSSE3
+#endif
+
+namespace
+{
+    /**
+     * The QImageAllocator class ties the lifetime of a QImage to the cv::Mat sharing its pixels.
+     * The QImage is held by the user data of the reference counter of the Mat,
+     * and released with the last Mat referring to it.
+     */
+    class QImageAllocator : public cv::MatAllocator
+    {
+    public:
+        cv::UMatData *allocate(int dims, const int *sizes, int type, void *data, size_t *step,
+                               int flags, cv::UMatUsageFlags usage_flags) const override
+        {
+            // buffers newly required by a shared mat are allocated as usual
+            return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data, step, flags, usage_flags);
+        }
+        bool allocate(cv::UMatData *u, int access_flags, cv::UMatUsageFlags usage_flags) const override
+        {
+            return cv::Mat::getStdAllocator()->allocate(u, access_flags, usage_flags);
+        }
+        void deallocate(cv::UMatData *u) const override
+        {
+            if (u == nullptr)
+                return;
+            delete static_cast<QImage *>(u->userdata);
+            delete u;
+        }
+
+        cv::Mat share(const QImage &image, const int &type) const
+        {
+            QImage *owner = new QImage(image);
+            cv::UMatData *u = new cv::UMatData(this);
+            u->data = u->origdata = const_cast<uchar *>(owner->constBits());
+            u->size = static_cast<size_t>(owner->bytesPerLine())*owner->height();
+            u->userdata = owner;
+            u->refcount = 1;
+            cv::Mat mat(owner->height(), owner->width(), type, u->data, static_cast<size_t>(owner->bytesPerLine()));
+            mat.u = u;
+            return mat;
+        }
+
+        static const QImageAllocator *instance()
+        {
+            // never destroyed, since mats may be released during static destruction
+            static const QImageAllocator *allocator = new QImageAllocator;
+            return allocator;
+        }
+    };
+
+    void releaseMat(void *mat)
+    {
+        delete static_cast<cv::Mat *>(mat);
+    }
+
+    QImage shareMat(const cv::Mat &mat, const QImage::Format &format)
+    {
+        // the const constructor makes the image detach on write instead of writing into the mat
+        return QImage(static_cast<const uchar *>(mat.data), mat.cols, mat.rows, static_cast<int>(mat.step), format,
+                      releaseMat, new cv::Mat(mat));
+    }
+
+    cv::Mat &reusableMat(cv::Mat &buffer)
+    {
+        // allocate a new buffer if the previous one is still referred by others
+        if (buffer.u != nullptr && buffer.u->refcount > 1)
+            buffer.release();
+        return buffer;
+    }
+
+#if QT_VERSION < QT_VERSION_CHECK(5,14,0)
+    QImage &reusableImage(const int &width, const int &height, const QImage::Format &format)
+    {
+        thread_local QImage buffer;
+        if (!buffer.isDetached() || buffer.width() != width || buffer.height() != height || buffer.format() != format)
+            buffer = QImage(width, height, format);
+        return buffer;
+    }
+#endif
+
+#ifdef CVQT_SSSE3
+    CVQT_SSSE3 int swapRedBlueSsse3(const uchar *src, uchar *dst, const int &pixels)
+    {
+        // 5 pixels per iteration; the 16th byte is copied as is and rewritten by the next iteration
+        const __m128i mask = _mm_setr_epi8(2, 1, 0, 5, 4, 3, 8, 7, 6, 11, 10, 9, 14, 13, 12, 15);
+        int x = 0;
+        for (; x + 6 <= pixels; x += 5)
+        {
+            const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x*3));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x*3), _mm_shuffle_epi8(v, mask));
+        }
+        return x;
+    }
+#endif
+}
+
+void CvQtImgConvertor::swapRedBlue(const uchar *src, uchar *dst, const int &pixels)
+{
+    int x = 0;
+#ifdef CVQT_SSSE3
+    static const bool ssse3 = cv::checkHardwareSupport(CV_CPU_SSSE3);
+    if (ssse3)
+        x = swapRedBlueSsse3(src, dst, pixels);
+#endif
+    for (src += x*3, dst += x*3; x < pixels; ++x, src += 3, dst += 3)
+    {
+        const uchar b = src[0];
+        dst[1] = src[1];
+        dst[0] = src[2];
+        dst[2] = b;
+    }
+}
+
 cv::Mat CvQtImgConvertor::qImage2CvMat(const QImage &input_image)
 {
+    if (input_image.isNull())
+        return cv::Mat();
+
     auto input_format = input_image.format();
-    if (input_format == QImage::Format_ARGB32 || input_format == QImage::Format_ARGB32_Premultiplied)
+    if (input_format == QImage::Format_ARGB32 || input_format == QImage::Format_ARGB32_Premultiplied ||
+        input_format == QImage::Format_RGB32)
     {
-        return cv::Mat(input_image.height(),
-                       input_image.width(),
-                       CV_8UC4,
-                       const_cast<uchar*>(input_image.bits()),
-                       static_cast<size_t>(input_image.bytesPerLine()));
+        return QImageAllocator::instance()->share(input_image, CV_8UC4);
     }
-    else if (input_format == QImage::Format_Indexed8)
+#if QT_VERSION >= QT_VERSION_CHECK(5,5,0)
+    else if (input_format == QImage::Format_Grayscale8)
     {
-        return cv::Mat(input_image.height(),
-                       input_image.width(),
-                       CV_8UC4,
-                       const_cast<uchar*>(input_image.bits()),
-                       static_cast<size_t>(input_image.bytesPerLine()));
+        return QImageAllocator::instance()->share(input_image, CV_8UC1);
     }
-    else if (input_format == QImage::Format_RGB32 || input_format == QImage::Format_RGB888)
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+    else if (input_format == QImage::Format_BGR888)
     {
-        QImage temp;
-        if (input_format == QImage::Format_RGB888)
-            temp = input_image.convertToFormat(QImage::Format_RGB32).rgbSwapped();
-        else
-            temp = input_image.rgbSwapped();
-        return cv::Mat(temp.height(),
-                       temp.width(),
-                       CV_8UC3,
-                       const_cast<uchar*>(temp.bits()),
-                       static_cast<size_t>(temp.bytesPerLine()));
+        return QImageAllocator::instance()->share(input_image, CV_8UC3);
+    }
+#endif
+    else if (input_format == QImage::Format_RGB888)
+    {
+        thread_local cv::Mat converted;
+        cv::Mat &buffer = reusableMat(converted);
+        buffer.create(input_image.height(), input_image.width(), CV_8UC3);
+        for (int y = 0; y < buffer.rows; ++y)
+            swapRedBlue(input_image.constScanLine(y), buffer.ptr(y), buffer.cols);
+        return buffer;
     }
 
-    // qWarning() << "CvQtImgConvertor() -- Unsupported QImage Input Format:" << input_image.format();
-    return cv::Mat();
+    return QImageAllocator::instance()->share(input_image.convertToFormat(QImage::Format_ARGB32), CV_8UC4);
 }
 
 QImage CvQtImgConvertor::cvMat2QImage(const cv::Mat& input_mat)
 {
+    if (input_mat.empty())
+        return QImage();
+
     auto input_format = input_mat.type();
     if (input_format == CV_8UC4)
     {
-        return QImage(input_mat.data,
-                      input_mat.cols,
-                      input_mat.rows,
-                      static_cast<int>(input_mat.step),
-                      QImage::Format_ARGB32);
+        return shareMat(input_mat, QImage::Format_ARGB32);
     }
     else if (input_format == CV_8UC3)
     {
-        return QImage(input_mat.data,
-                      input_mat.cols,
-                      input_mat.rows,
-                      static_cast<int>(input_mat.step),
-                      QImage::Format_RGB888).rgbSwapped();
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+        return shareMat(input_mat, QImage::Format_BGR888);
+#else
+        QImage &buffer = reusableImage(input_mat.cols, input_mat.rows, QImage::Format_RGB888);
+        for (int y = 0; y < input_mat.rows; ++y)
+            swapRedBlue(input_mat.ptr(y), buffer.scanLine(y), input_mat.cols);
+        return buffer;
+#endif
     }
     else if (input_format == CV_8UC1)
     {
 #if QT_VERSION >= QT_VERSION_CHECK(5,5,0)
-        return QImage(input_mat.data,
-                      input_mat.cols,
-                      input_mat.rows,
-                      static_cast<int>(input_mat.step),
-                      QImage::Format_Grayscale8);
+        return shareMat(input_mat, QImage::Format_Grayscale8);
 #else
         QVector<QRgb> colorTable;
         if (colorTable.isEmpty())
@@ -72,11 +191,7 @@ QImage CvQtImgConvertor::cvMat2QImage(const cv::Mat& input_mat)
             for (int i = 0; i < 256; ++i)
                 colorTable[i] = qRgb(i,i,i);
         }
-        QImage temp(input_mat.data,
-                    input_mat.cols,
-                    input_mat.rows,
-                    static_cast<int>(input_mat.step),
-                    QImage::Format_Indexed8);
+        QImage temp = shareMat(input_mat, QImage::Format_Indexed8);
         temp.setColorTable(colorTable);
         return temp;
 #endif
@@ -85,3 +200,32 @@ QImage CvQtImgConvertor::cvMat2QImage(const cv::Mat& input_mat)
     return QImage();
 }
 
+QPixmap CvQtImgConvertor::cvMat2QPixmap(const cv::Mat &input_mat, const QSize &target_size)
+{
+    if (input_mat.empty() || target_size.isEmpty())
+        return cvMat2QPixmap(input_mat);
+    const QSize size = QSize(input_mat.cols, input_mat.rows).scaled(target_size, Qt::KeepAspectRatio);
+    if (size.width() == input_mat.cols && size.height() == input_mat.rows)
+        return cvMat2QPixmap(input_mat);
+
+    thread_local cv::Mat scaled;
+    cv::resize(input_mat, reusableMat(scaled), cv::Size(size.width(), size.height()), 0, 0, cv::INTER_AREA);
+    return cvMat2QPixmap(scaled);
+}
+
+QPixmap CvQtImgConvertor::fitPixmap(const QPixmap &img, const QSize &target_size)
+{
+    if (img.isNull() || target_size.isEmpty() || img.size().scaled(target_size, Qt::KeepAspectRatio) == img.size())
+        return img;
+
+    const QString key = QString("fit-%1-%2x%3").arg(QString::number(img.cacheKey()),
+                                                    QString::number(target_size.width()),
+                                                    QString::number(target_size.height()));
+    QPixmap scaled;
+    if (!QPixmapCache::find(key, &scaled))
+    {
+        scaled = img.scaled(target_size, Qt::KeepAspectRatio);
+        QPixmapCache::insert(key, scaled);
+    }
+    return scaled;
+}
@@ -7,16 +7,30 @@
  */
 #include <QImage>
 #include <QPixmap>
+#include <QSize>
 
 #include <opencv2/opencv.hpp>
 
 /**
  * @brief The ImgConvertor class provides a convertor between Qt image and opencv mat.
+ *
+ * Whenever the pixel layouts of the two sides match, the converted image shares the buffer of the input image
+ * instead of copying it. The buffer is reference-counted by both sides: a shared QImage keeps a reference to the
+ * cv::Mat, and a shared cv::Mat keeps a reference to the QImage, so that either one can outlive the other.
+ * A shared buffer should be treated as read-only; QImage detaches on write, while cv::Mat writes through.
+ *
+ * Otherwise, the pixels are converted into a buffer reused across calls of the same thread,
+ * as long as no image returned previously still refers to it.
  */
 class CvQtImgConvertor {
 public:
     /**
      * @brief qImage2CvMat is a converter from QImage to cv::Mat
+     *
+     * `Format_Grayscale8`, `Format_BGR888`, `Format_RGB32` and `Format_ARGB32` images are shared into
+     * `CV_8UC1`, `CV_8UC3`, and `CV_8UC4` (BGRA) mats respectively. `Format_RGB888` images are converted into
+     * `CV_8UC3` mats, and images in other formats are converted into `CV_8UC4` mats.
+     *
      * @param input_image : an image in the format of QImage
      * @return the image in the format of cv::Mat
      */
@@ -32,6 +46,11 @@ public:
     }
     /**
      * @brief cvMat2QImage is a converter from cv::Mat to QImage
+     *
+     * `CV_8UC1` and `CV_8UC4` mats are always shared. `CV_8UC3` mats are shared as `Format_BGR888` images
+     * since Qt 5.14, and converted into `Format_RGB888` images before.
+     * A mat wrapping external data without reference counting is shared without being kept alive.
+     *
      * @param input_image : an image in the format of cv::Mat
      * @return the image in the format of QImage
      */
@@ -45,6 +64,39 @@ public:
     {
         return QPixmap::fromImage(cvMat2QImage(input_mat));
     }
+    /**
+     * @brief cvMat2QPixmap is a converter from cv::Mat to QPixmap fitting in the given size
+     *
+     * The mat is resized by OpenCV with `INTER_AREA` to the largest size within `target_size` keeping its aspect ratio,
+     * before being converted, so that only the pixels to be displayed are converted.
+     *
+     * @param input_image : an image in the format of cv::Mat
+     * @param target_size : size of the widget displaying the image
+     * @return the image in the format of QPixmap
+     */
+    static QPixmap cvMat2QPixmap(const cv::Mat & input_mat, const QSize &target_size);
+    /**
+     * @brief fitPixmap scales a pixmap to the largest size within the given size keeping its aspect ratio.
+     *
+     * A pixmap fitting the size already, e.g. one given by #CvQtImgConvertor::cvMat2QPixmap with the same size,
+     * is returned as it is. Otherwise, the scaled pixmap is kept in `QPixmapCache`, so that a pixmap displayed
+     * repeatedly on a widget whose size does not change is scaled only once. This function is for the GUI thread only.
+     *
+     * @param img : the pixmap
+     * @param target_size : size of the widget displaying the pixmap
+     * @return the scaled pixmap
+     */
+    static QPixmap fitPixmap(const QPixmap &img, const QSize &target_size);
+    /**
+     * @brief swapRedBlue swaps the first and the third channels of 3-channel pixels, i.e. converts BGR from/to RGB.
+     *
+     * SSSE3 is used if supported by the CPU. In-place swapping is allowed.
+     *
+     * @param src : the source pixels
+     * @param dst : the destination pixels
+     * @param pixels : number of pixels
+     */
+    static void swapRedBlue(const uchar *src, uchar *dst, const int &pixels);
 };
 
 #endif // CVQTIMGCONVERTOR_H
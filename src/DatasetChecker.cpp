@@ -0,0 +1,784 @@
+#include "DatasetChecker.hpp"
+#include "DatasetReader.hpp"
+#include "QoiCodec.hpp"
+#include "SampleManifest.hpp"
+
+#include <QDir>
+#include <QFile>
+#include <QRunnable>
+#include <QThread>
+
+#include <opencv2/opencv.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+
+#ifdef __linux__
+#  include <dirent.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <sys/stat.h>
+#  include <sys/syscall.h>
+#endif
+
+namespace
+{
+    // bytes read from the beginning and the end of each file for validation
+    const qint64 HEAD_SIZE = 512;
+    const qint64 TAIL_SIZE = 16;
+
+    inline quint16 le16(const uchar *p)
+    {
+        return quint16(p[0]) | (quint16(p[1]) << 8);
+    }
+    inline quint32 le32(const uchar *p)
+    {
+        return quint32(p[0]) | (quint32(p[1]) << 8) | (quint32(p[2]) << 16) | (quint32(p[3]) << 24);
+    }
+    inline quint16 be16(const uchar *p)
+    {
+        return (quint16(p[0]) << 8) | quint16(p[1]);
+    }
+    inline quint32 be32(const uchar *p)
+    {
+        return (quint32(p[0]) << 24) | (quint32(p[1]) << 16) | (quint32(p[2]) << 8) | quint32(p[3]);
+    }
+
+    inline bool parseId(const std::string &name, quint32 &id)
+    {
+        if (name.empty() || name.size() > 10)
+            return false;
+        quint64 v = 0;
+        for (const char &c : name)
+        {
+            if (c < '0' || c > '9')
+                return false;
+            v = v*10 + (c - '0');
+        }
+        if (v > 0xFFFFFFFFu)
+            return false;
+        id = static_cast<quint32>(v);
+        return true;
+    }
+
+#ifdef __linux__
+    struct Dirent64
+    {
+        quint64 d_ino;
+        qint64 d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[256];
+    };
+
+    class FolderHandle
+    {
+    public:
+        explicit FolderHandle(const QString &path) :
+            _fd(::open(QFile::encodeName(path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC))
+        {}
+        ~FolderHandle()
+        {
+            if (_fd > -1)
+                ::close(_fd);
+        }
+        int fd() const
+        {
+            return _fd;
+        }
+    private:
+        int _fd;
+    };
+
+    class SampleFile
+    {
+    public:
+        SampleFile(const FolderHandle &folder, const std::string &name) :
+            _fd(folder.fd() < 0 ? -1 : ::openat(folder.fd(), name.c_str(), O_RDONLY | O_CLOEXEC)),
+            _size(-1)
+        {
+            struct stat st;
+            if (_fd > -1 && ::fstat(_fd, &st) == 0 && S_ISREG(st.st_mode))
+                _size = st.st_size;
+        }
+        ~SampleFile()
+        {
+            if (_fd > -1)
+                ::close(_fd);
+        }
+        qint64 size() const
+        {
+            return _size;
+        }
+        bool read(const qint64 &offset, uchar *buffer, const qint64 &n)
+        {
+            qint64 done = 0;
+            while (done < n)
+            {
+                ssize_t r = ::pread(_fd, buffer + done, n - done, offset + done);
+                if (r <= 0)
+                    return false;
+                done += r;
+            }
+            return true;
+        }
+    private:
+        int _fd;
+        qint64 _size;
+    };
+#else
+    class FolderHandle
+    {
+    public:
+        explicit FolderHandle(const QString &path) : _dir(path) {}
+        const QDir &dir() const
+        {
+            return _dir;
+        }
+    private:
+        QDir _dir;
+    };
+
+    class SampleFile
+    {
+    public:
+        SampleFile(const FolderHandle &folder, const std::string &name) :
+            _file(folder.dir().filePath(QFile::decodeName(name.c_str()))),
+            _size(-1)
+        {
+            if (_file.open(QIODevice::ReadOnly))
+                _size = _file.size();
+        }
+        qint64 size() const
+        {
+            return _size;
+        }
+        bool read(const qint64 &offset, uchar *buffer, const qint64 &n)
+        {
+            return _file.seek(offset) && _file.read(reinterpret_cast<char *>(buffer), n) == n;
+        }
+    private:
+        QFile _file;
+        qint64 _size;
+    };
+#endif
+}
+
+class DatasetChecker::Task : public QRunnable
+{
+public:
+    explicit Task(const std::function<void()> &f) : _f(f) {}
+    void run() override
+    {
+        _f();
+    }
+private:
+    std::function<void()> _f;
+};
+
+DatasetChecker::DatasetChecker(const int &threads)
+{
+    _pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+}
+
+bool DatasetChecker::check(const QString &dataset_dir, const bool &fix, Report &report)
+{
+    report = Report();
+    QDir dir(dataset_dir);
+    if (!dir.exists())
+        return false;
+
+    std::vector<Label> labels;
+    for (const auto &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+    {
+        labels.push_back(Label());
+        labels.back().name = name;
+        labels.back().path = dir.filePath(name);
+    }
+
+    // list the sample directories of all labels concurrently
+    for (auto &label : labels)
+        _pool.start(new Task([this, &label]() { _list(label); }));
+    _pool.waitForDone();
+
+    // validate files in chunks such that a large label is shared by all threads
+    for (auto &label : labels)
+    {
+        std::vector<Folder *> folders = {&label.orig, &label.proc};
+        for (auto &f : label.resized)
+            folders.push_back(&f);
+        for (auto folder : folders)
+            for (size_t begin = 0, n = folder->entries.size(); begin < n; begin += DATASET_CHECKER_CHUNK_SIZE)
+            {
+                size_t end = std::min(n, begin + DATASET_CHECKER_CHUNK_SIZE);
+                _pool.start(new Task([this, folder, begin, end]() { _validate(*folder, begin, end); }));
+            }
+    }
+    _pool.waitForDone();
+
+    for (auto &label : labels)
+        _pool.start(new Task([this, &label, fix]() { _reconcile(label, fix); }));
+    _pool.waitForDone();
+
+    QStringList index_labels;
+    std::vector<qint32> index_sample_labels;
+    std::vector<quint32> index_sample_ids;
+    for (auto &label : labels)
+    {
+        Report &r = label.report;
+        report.files += r.files;
+        for (int p = 0; p < PROBLEM_COUNT; ++p)
+            report.problems[p] += r.problems[p];
+        report.issues.insert(report.issues.end(), r.issues.begin(), r.issues.end());
+        report.manifest_dropped += r.manifest_dropped;
+        report.manifest_missing += r.manifest_missing;
+        report.removed += r.removed;
+        report.regenerated += r.regenerated;
+        if (!label.proc.exists)
+            continue;
+
+        ++report.labels;
+        report.samples += label.samples.size();
+        qint32 label_index = index_labels.size();
+        index_labels.append(label.name);
+        index_sample_labels.insert(index_sample_labels.end(), label.samples.size(), label_index);
+        index_sample_ids.insert(index_sample_ids.end(), label.samples.begin(), label.samples.end());
+    }
+    report.indexed = DatasetReader::saveIndex(dataset_dir, index_labels, index_sample_labels, index_sample_ids);
+    return true;
+}
+
+QString DatasetChecker::describe(const PROBLEM &problem)
+{
+    switch (problem)
+    {
+    case PROBLEM_ORPHAN:
+        return "orphan";
+    case PROBLEM_EMPTY:
+        return "empty";
+    case PROBLEM_UNDECODABLE:
+        return "undecodable";
+    case PROBLEM_SIZE_MISMATCH:
+        return "size mismatch";
+    case PROBLEM_MISSING_RESIZE:
+        return "missing resized sample";
+    case PROBLEM_UNKNOWN_FILE:
+        return "unknown file";
+    default:
+        return "";
+    }
+}
+
+bool DatasetChecker::listFiles(const QString &dir_path, std::vector<std::string> &names)
+{
+    names.clear();
+#ifdef __linux__
+    int fd = ::open(QFile::encodeName(dir_path).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    // a large buffer gets thousands of entries per system call
+    std::vector<char> buffer(1 << 18);
+    bool success = true;
+    while (true)
+    {
+        long n = ::syscall(SYS_getdents64, fd, buffer.data(), buffer.size());
+        if (n <= 0)
+        {
+            success = n == 0;
+            break;
+        }
+        for (long pos = 0; pos < n;)
+        {
+            const Dirent64 *d = reinterpret_cast<const Dirent64 *>(buffer.data() + pos);
+            pos += d->d_reclen;
+            if (d->d_type != DT_REG && d->d_type != DT_UNKNOWN)
+                continue;
+            if (d->d_name[0] == '.' && (d->d_name[1] == '\0' || (d->d_name[1] == '.' && d->d_name[2] == '\0')))
+                continue;
+            names.emplace_back(d->d_name);
+        }
+    }
+    ::close(fd);
+    return success;
+#else
+    QDir dir(dir_path);
+    if (!dir.exists())
+        return false;
+    for (const auto &f : dir.entryList(QDir::Files | QDir::Hidden | QDir::System, QDir::Unsorted))
+        names.push_back(QFile::encodeName(f).toStdString());
+    return true;
+#endif
+}
+
+DatasetChecker::HEADER DatasetChecker::readImageHeader(const uchar *head, const qint64 &head_size,
+                                                       const uchar *tail, const qint64 &tail_size,
+                                                       const qint64 &file_size, int &width, int &height)
+{
+    // BMP
+    if (head_size >= 2 && head[0] == 'B' && head[1] == 'M')
+    {
+        if (head_size < 26)
+            return HEADER_INVALID;
+        const quint32 offset = le32(head + 10);
+        const quint32 dib_size = le32(head + 14);
+        int bpp;
+        quint32 compression = 0;
+        if (dib_size == 12)
+        {
+            width = le16(head + 18);
+            height = le16(head + 20);
+            bpp = le16(head + 24);
+        }
+        else if (dib_size >= 40 && head_size >= 34)
+        {
+            width = static_cast<qint32>(le32(head + 18));
+            // negative for top-down bitmaps
+            height = std::abs(static_cast<qint32>(le32(head + 22)));
+            bpp = le16(head + 28);
+            compression = le32(head + 30);
+        }
+        else
+            return HEADER_INVALID;
+        if (width <= 0 || height <= 0 || bpp == 0 || offset >= file_size)
+            return HEADER_INVALID;
+        // the size of the pixel data is known only without compression, i.e. BI_RGB or BI_BITFIELDS
+        if ((compression == 0 || compression == 3) &&
+            offset + (static_cast<qint64>(width)*bpp + 31)/32*4*height > file_size)
+            return HEADER_INVALID;
+        return HEADER_VALID;
+    }
+
+    // binary PNM, P4, P5 and P6
+    if (head_size >= 2 && head[0] == 'P' && head[1] >= '4' && head[1] <= '6')
+    {
+        const int fields_count = head[1] == '4' ? 2 : 3;
+        int fields[3] = {0, 0, 1};
+        qint64 pos = 2;
+        for (int i = 0; i < fields_count; ++i)
+        {
+            while (pos < head_size && (std::isspace(head[pos]) || head[pos] == '#'))
+            {
+                if (head[pos] == '#')
+                    while (pos < head_size && head[pos] != '\n')
+                        ++pos;
+                else
+                    ++pos;
+            }
+            if (pos >= head_size)
+                return file_size > head_size ? HEADER_UNKNOWN : HEADER_INVALID;
+            if (!std::isdigit(head[pos]))
+                return HEADER_INVALID;
+            fields[i] = 0;
+            while (pos < head_size && std::isdigit(head[pos]))
+            {
+                fields[i] = fields[i]*10 + (head[pos] - '0');
+                if (fields[i] > 0xFFFF)
+                    return HEADER_INVALID;
+                ++pos;
+            }
+        }
+        if (pos >= head_size || !std::isspace(head[pos]) || fields[0] < 1 || fields[1] < 1 || fields[2] < 1)
+            return HEADER_INVALID;
+        width = fields[0];
+        height = fields[1];
+        const qint64 depth = fields[2] > 255 ? 2 : 1;
+        qint64 payload;
+        if (head[1] == '4')
+            payload = (static_cast<qint64>(width) + 7)/8*height;
+        else if (head[1] == '5')
+            payload = static_cast<qint64>(width)*height*depth;
+        else
+            payload = static_cast<qint64>(width)*height*depth*3;
+        return pos + 1 + payload > file_size ? HEADER_INVALID : HEADER_VALID;
+    }
+
+    // PNG
+    static const uchar PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (head_size >= 8 && std::memcmp(head, PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) == 0)
+    {
+        // the file ends with the IEND chunk, whose length and CRC are fixed
+        static const uchar PNG_IEND[12] = {0, 0, 0, 0, 'I', 'E', 'N', 'D', 0xAE, 0x42, 0x60, 0x82};
+        if (head_size < 24 || std::memcmp(head + 12, "IHDR", 4) != 0 ||
+            tail_size < 12 || std::memcmp(tail + tail_size - 12, PNG_IEND, sizeof(PNG_IEND)) != 0)
+            return HEADER_INVALID;
+        width = static_cast<int>(be32(head + 16));
+        height = static_cast<int>(be32(head + 20));
+        return width > 0 && height > 0 ? HEADER_VALID : HEADER_INVALID;
+    }
+
+    // QOI
+    if (QoiCodec::isQoi(head, head_size))
+    {
+        // the file ends with an 8-byte end marker
+        static const uchar QOI_END_MARKER[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+        if (tail_size < 8 || std::memcmp(tail + tail_size - 8, QOI_END_MARKER, sizeof(QOI_END_MARKER)) != 0)
+            return HEADER_INVALID;
+        width = static_cast<int>(be32(head + 4));
+        height = static_cast<int>(be32(head + 8));
+        return width > 0 && height > 0 ? HEADER_VALID : HEADER_INVALID;
+    }
+
+    // WebP
+    if (head_size >= 12 && std::memcmp(head, "RIFF", 4) == 0 && std::memcmp(head + 8, "WEBP", 4) == 0)
+    {
+        // the RIFF header records the size of the whole file
+        if (head_size < 30 || static_cast<qint64>(le32(head + 4)) + 8 > file_size)
+            return HEADER_INVALID;
+        if (std::memcmp(head + 12, "VP8L", 4) == 0)
+        {
+            // lossless bitstream: a signature byte followed by 14-bit width - 1 and height - 1
+            if (head[20] != 0x2F)
+                return HEADER_INVALID;
+            const quint32 bits = le32(head + 21);
+            width = static_cast<int>(bits & 0x3FFF) + 1;
+            height = static_cast<int>((bits >> 14) & 0x3FFF) + 1;
+            return HEADER_VALID;
+        }
+        if (std::memcmp(head + 12, "VP8 ", 4) == 0)
+        {
+            // lossy bitstream: a start code in the key frame header followed by 14-bit width and height
+            if (head[23] != 0x9D || head[24] != 0x01 || head[25] != 0x2A)
+                return HEADER_INVALID;
+            width = le16(head + 26) & 0x3FFF;
+            height = le16(head + 28) & 0x3FFF;
+            return width > 0 && height > 0 ? HEADER_VALID : HEADER_INVALID;
+        }
+        if (std::memcmp(head + 12, "VP8X", 4) == 0)
+        {
+            // extended format: 24-bit canvas width - 1 and height - 1
+            width = static_cast<int>(head[24] | (head[25] << 8) | (head[26] << 16)) + 1;
+            height = static_cast<int>(head[27] | (head[28] << 8) | (head[29] << 16)) + 1;
+            return HEADER_VALID;
+        }
+        return HEADER_INVALID;
+    }
+
+    // JPEG
+    if (head_size >= 2 && head[0] == 0xFF && head[1] == 0xD8)
+    {
+        // the file ends with the EOI marker
+        if (tail_size < 2 || tail[tail_size - 2] != 0xFF || tail[tail_size - 1] != 0xD9)
+            return HEADER_INVALID;
+        qint64 pos = 2;
+        while (pos + 4 <= head_size)
+        {
+            if (head[pos] != 0xFF)
+                return HEADER_INVALID;
+            const uchar marker = head[pos + 1];
+            if (marker == 0xFF)
+            {
+                ++pos;
+                continue;
+            }
+            // SOF markers, except DHT, JPG and DAC who share the range
+            if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC)
+            {
+                if (pos + 9 > head_size)
+                    return HEADER_UNKNOWN;
+                height = be16(head + pos + 5);
+                width = be16(head + pos + 7);
+                return width > 0 && height > 0 ? HEADER_VALID : HEADER_INVALID;
+            }
+            const quint16 length = be16(head + pos + 2);
+            if (length < 2)
+                return HEADER_INVALID;
+            pos += 2 + length;
+        }
+        // the frame header is beyond the bytes read, e.g. after a large EXIF segment
+        return HEADER_UNKNOWN;
+    }
+
+    return HEADER_UNKNOWN;
+}
+
+void DatasetChecker::_list(Label &label)
+{
+    auto list = [](Folder &folder)
+    {
+        std::vector<std::string> names;
+        folder.exists = listFiles(folder.path, names);
+        folder.entries.resize(names.size());
+        for (size_t i = 0; i < names.size(); ++i)
+        {
+            Entry &e = folder.entries[i];
+            e.name = std::move(names[i]);
+            if (!parseId(e.name, e.id))
+                e.problem = PROBLEM_UNKNOWN_FILE;
+        }
+    };
+
+    QDir dir(label.path);
+    label.orig.path = dir.filePath(SAMPLE_ORIG_FORMAT);
+    label.proc.path = dir.filePath(SAMPLE_PROC_FORMAT);
+    list(label.orig);
+    list(label.proc);
+    if (!label.orig.exists && !label.proc.exists)
+        return;
+
+    for (const auto &d : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+    {
+        bool ok;
+        int size = d.toInt(&ok);
+        if (!ok || size < 1)
+            continue;
+        label.resized.push_back(Folder());
+        label.resized.back().path = dir.filePath(d);
+        label.resized.back().size = size;
+        list(label.resized.back());
+    }
+}
+
+void DatasetChecker::_validate(Folder &folder, const size_t &begin, const size_t &end)
+{
+    FolderHandle handle(folder.path);
+    uchar head[HEAD_SIZE];
+    uchar tail[TAIL_SIZE];
+    std::vector<uchar> content;
+    for (size_t i = begin; i < end; ++i)
+    {
+        Entry &e = folder.entries[i];
+        if (e.problem != PROBLEM_NONE)
+            continue;
+
+        SampleFile file(handle, e.name);
+        if (file.size() < 0)
+        {
+            e.problem = PROBLEM_UNKNOWN_FILE;
+            continue;
+        }
+        if (file.size() == 0)
+        {
+            e.problem = PROBLEM_EMPTY;
+            continue;
+        }
+        const qint64 head_size = std::min(file.size(), HEAD_SIZE);
+        const qint64 tail_size = std::min(file.size(), TAIL_SIZE);
+        if (!file.read(0, head, head_size) || !file.read(file.size() - tail_size, tail, tail_size))
+        {
+            e.problem = PROBLEM_UNDECODABLE;
+            continue;
+        }
+
+        HEADER h = readImageHeader(head, head_size, tail, tail_size, file.size(), e.width, e.height);
+        if (h == HEADER_UNKNOWN)
+        {
+            // decode the entire file as the last resort
+            cv::Mat img;
+            content.resize(file.size());
+            if (file.read(0, content.data(), file.size()))
+            {
+                try
+                {
+                    img = cv::imdecode(cv::Mat(1, static_cast<int>(file.size()), CV_8UC1, content.data()),
+                                       cv::IMREAD_UNCHANGED);
+                }
+                catch (const cv::Exception &)
+                {}
+            }
+            h = img.empty() ? HEADER_INVALID : HEADER_VALID;
+            e.width = img.cols;
+            e.height = img.rows;
+        }
+
+        if (h == HEADER_INVALID)
+            e.problem = PROBLEM_UNDECODABLE;
+        else if (folder.size > 0 && (e.width != folder.size || e.height != folder.size))
+            e.problem = PROBLEM_SIZE_MISMATCH;
+    }
+}
+
+void DatasetChecker::_reconcile(Label &label, const bool &fix)
+{
+    Report &r = label.report;
+    auto file_path = [](const Folder &folder, const std::string &name)
+    {
+        return folder.path + '/' + QFile::decodeName(name.c_str());
+    };
+    auto report = [&](const Folder &folder, const std::string &name, const PROBLEM &problem)
+    {
+        ++r.problems[problem];
+        r.issues.push_back({file_path(folder, name), problem});
+    };
+    auto remove = [&](const Folder &folder, const std::string &name)
+    {
+        if (fix && QFile::remove(file_path(folder, name)))
+            ++r.removed;
+    };
+    // the entries named as samples in the order of their id
+    auto sorted = [&](const Folder &folder) -> std::vector<const Entry *>
+    {
+        std::vector<const Entry *> entries;
+        entries.reserve(folder.entries.size());
+        for (const auto &e : folder.entries)
+        {
+            if (e.problem == PROBLEM_UNKNOWN_FILE)
+                report(folder, e.name, e.problem);
+            else
+                entries.push_back(&e);
+        }
+        std::sort(entries.begin(), entries.end(), [](const Entry *a, const Entry *b) { return a->id < b->id; });
+        return entries;
+    };
+
+    r.files = label.orig.entries.size() + label.proc.entries.size();
+    for (const auto &f : label.resized)
+        r.files += f.entries.size();
+    if (!label.orig.exists && !label.proc.exists)
+        return;
+
+    SampleManifest::Table table;
+    QString manifest_path = QDir(label.path).filePath(SampleManifest::file_name);
+    bool has_manifest = SampleManifest::load(manifest_path, table);
+    // the last record wins if a sample id was reused
+    std::unordered_map<quint32, int> records;
+    for (int row = 0; row < table.rows; ++row)
+        records[table.column<quint32>(SampleManifest::COLUMN_SAMPLE_ID)[row]] = row;
+
+    // pair the original images and the masks by id
+    auto orig = sorted(label.orig);
+    auto proc = sorted(label.proc);
+    for (size_t i = 0, j = 0; i < orig.size() || j < proc.size();)
+    {
+        const Entry *o = nullptr, *p = nullptr;
+        if (j >= proc.size() || (i < orig.size() && orig[i]->id < proc[j]->id))
+            o = orig[i++];
+        else if (i >= orig.size() || proc[j]->id < orig[i]->id)
+            p = proc[j++];
+        else
+        {
+            o = orig[i++];
+            p = proc[j++];
+        }
+
+        bool valid = o != nullptr && p != nullptr;
+        if (o != nullptr && o->problem != PROBLEM_NONE)
+        {
+            report(label.orig, o->name, o->problem);
+            valid = false;
+        }
+        if (p != nullptr && p->problem != PROBLEM_NONE)
+        {
+            report(label.proc, p->name, p->problem);
+            valid = false;
+        }
+        if (p == nullptr && o->problem == PROBLEM_NONE)
+            report(label.orig, o->name, PROBLEM_ORPHAN);
+        if (o == nullptr && p->problem == PROBLEM_NONE)
+            report(label.proc, p->name, PROBLEM_ORPHAN);
+
+        if (valid)
+        {
+            // the mask is cropped from the original image by the bounding box of the hand
+            bool matched = p->width <= o->width && p->height <= o->height;
+            auto rec = records.find(p->id);
+            if (matched && rec != records.end())
+            {
+                SampleManifest::Record record = table.record(rec->second);
+                if ((record.roi.area() > 0 &&
+                     (record.roi.width != o->width || record.roi.height != o->height)) ||
+                    (record.hand_bound.area() > 0 &&
+                     (record.hand_bound.width != p->width || record.hand_bound.height != p->height)))
+                    matched = false;
+            }
+            if (!matched)
+            {
+                report(label.proc, p->name, PROBLEM_SIZE_MISMATCH);
+                valid = false;
+            }
+        }
+
+        if (valid)
+            label.samples.push_back(p->id);
+        else
+        {
+            if (o != nullptr)
+                remove(label.orig, o->name);
+            if (p != nullptr)
+                remove(label.proc, p->name);
+        }
+    }
+
+    // the resized samples follow the valid samples
+    const QByteArray format = "." + QByteArray(SAMPLE_PROC_FORMAT).toLower();
+    for (const auto &folder : label.resized)
+    {
+        auto regenerate = [&](const quint32 &id)
+        {
+            if (!fix)
+                return;
+            QString name = QString::number(id);
+            cv::Mat mask = cv::imread(QFile::encodeName(QDir(label.proc.path).filePath(name)).toStdString(),
+                                      cv::IMREAD_GRAYSCALE);
+            std::vector<uchar> buffer;
+            if (mask.empty())
+                return;
+            cv::Mat resized(folder.size, folder.size, CV_8UC1);
+            DatasetReader::letterbox(mask, resized);
+            if (!cv::imencode(format.toStdString(), resized, buffer))
+                return;
+            QFile file(QDir(folder.path).filePath(name));
+            if (file.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+                file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size())
+                    == static_cast<qint64>(buffer.size()))
+                ++r.regenerated;
+        };
+
+        auto entries = sorted(folder);
+        size_t k = 0;
+        for (const auto &id : label.samples)
+        {
+            for (; k < entries.size() && entries[k]->id < id; ++k)
+            {
+                report(folder, entries[k]->name,
+                       entries[k]->problem == PROBLEM_NONE ? PROBLEM_ORPHAN : entries[k]->problem);
+                remove(folder, entries[k]->name);
+            }
+            if (k < entries.size() && entries[k]->id == id)
+            {
+                if (entries[k]->problem != PROBLEM_NONE)
+                {
+                    report(folder, entries[k]->name, entries[k]->problem);
+                    regenerate(id);
+                }
+                ++k;
+            }
+            else
+            {
+                report(folder, QFile::encodeName(QString::number(id)).toStdString(), PROBLEM_MISSING_RESIZE);
+                regenerate(id);
+            }
+        }
+        for (; k < entries.size(); ++k)
+        {
+            report(folder, entries[k]->name,
+                   entries[k]->problem == PROBLEM_NONE ? PROBLEM_ORPHAN : entries[k]->problem);
+            remove(folder, entries[k]->name);
+        }
+    }
+
+    // rebuild the manifest with one record per valid sample, in the sampling order
+    SampleManifest::Table rebuilt;
+    for (int row = 0; row < table.rows; ++row)
+    {
+        quint32 id = table.column<quint32>(SampleManifest::COLUMN_SAMPLE_ID)[row];
+        if (records[id] == row && std::binary_search(label.samples.begin(), label.samples.end(), id))
+            rebuilt.append(table.record(row));
+        else
+            ++r.manifest_dropped;
+    }
+    for (const auto &id : label.samples)
+    {
+        if (records.find(id) != records.end())
+            continue;
+        SampleManifest::Record record;
+        record.sample_id = id;
+        rebuilt.append(record);
+        ++r.manifest_missing;
+    }
+    if (fix && (r.manifest_dropped > 0 || r.manifest_missing > 0 || (!has_manifest && label.proc.exists)))
+        SampleManifest::save(manifest_path, rebuilt);
+}
@@ -0,0 +1,202 @@
+#ifndef DATASETCHECKER_H
+#define DATASETCHECKER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The DatasetChecker.hpp file contains the class of verifying and re-indexing a collected dataset.
+ */
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+/**
+ * @brief The DatasetChecker class verifies a dataset in the directory layout made by #SampleCollector .
+ *
+ * All labels are scanned concurrently. For each label, the sample directories are listed in batches,
+ * using `getdents64` on Linux, and each file is validated by reading only its header and its last few bytes.
+ * A file is reported if it
+ *
+ *  - has no counterpart in the original or the processed image directory (orphan);
+ *  - is empty;
+ *  - cannot be decoded, i.e. a corrupted header or a truncated body;
+ *  - has dimensions mismatched with its counterpart, with the manifest record, or with its resized size.
+ *
+ * Afterwards, the index file of the dataset, #DATASET_INDEX_FILE_NAME , is rebuilt to list the valid samples.
+ * In fixing mode, the invalid samples are removed, the missing or invalid resized samples are regenerated,
+ * and the manifest of each label is rewritten to keep one record per valid sample.
+ *
+ * This class replaces `scripts/sample_cleaner.rb`.
+ *
+ * @see #DatasetReader::saveIndex
+ */
+class DatasetChecker
+{
+public:
+    /**
+     * @brief PROBLEM is the kind of problems found on a file.
+     */
+    enum PROBLEM
+    {
+        PROBLEM_NONE = 0,
+        PROBLEM_ORPHAN,            //!< the counterpart of the file is missing
+        PROBLEM_EMPTY,             //!< the file is empty
+        PROBLEM_UNDECODABLE,       //!< the file is not a valid image or is truncated
+        PROBLEM_SIZE_MISMATCH,     //!< dimensions of the image are unexpected
+        PROBLEM_MISSING_RESIZE,    //!< the resized sample of a valid sample is missing
+        PROBLEM_UNKNOWN_FILE,      //!< the file is not named as a sample, which is never removed
+        PROBLEM_COUNT
+    };
+    /**
+     * @brief The Issue struct is a problem found on a file.
+     */
+    struct Issue
+    {
+        QString file_path;
+        PROBLEM problem;
+    };
+    /**
+     * @brief The Report struct is the result of checking a dataset.
+     */
+    struct Report
+    {
+        int labels = 0;
+        /**
+         * @brief files is the number of files checked.
+         */
+        qint64 files = 0;
+        /**
+         * @brief samples is the number of valid samples.
+         */
+        qint64 samples = 0;
+        /**
+         * @brief problems is the number of files found with each #DatasetChecker::PROBLEM .
+         */
+        qint64 problems[PROBLEM_COUNT] = {};
+        /**
+         * @brief issues is the list of the problems found.
+         */
+        std::vector<Issue> issues;
+        /**
+         * @brief manifest_dropped is the number of manifest records without a valid sample.
+         */
+        qint64 manifest_dropped = 0;
+        /**
+         * @brief manifest_missing is the number of valid samples without a manifest record.
+         */
+        qint64 manifest_missing = 0;
+        /**
+         * @brief removed is the number of files removed in fixing mode.
+         */
+        qint64 removed = 0;
+        /**
+         * @brief regenerated is the number of resized samples regenerated in fixing mode.
+         */
+        qint64 regenerated = 0;
+        /**
+         * @brief indexed tells if the index file is successfully rebuilt.
+         */
+        bool indexed = false;
+    };
+    /**
+     * @brief HEADER is the result of #DatasetChecker::readImageHeader .
+     */
+    enum HEADER
+    {
+        HEADER_VALID,   //!< the header is valid and the file is complete
+        HEADER_INVALID, //!< the header is corrupted or the file is truncated
+        HEADER_UNKNOWN  //!< the format is not supported; the file needs to be decoded entirely
+    };
+
+    /**
+     * @brief DatasetChecker is the constructor.
+     * @param threads : number of the checking threads. Use the ideal thread count if 0 is given.
+     */
+    explicit DatasetChecker(const int &threads = 0);
+
+    /**
+     * @brief check verifies a dataset and rebuilds its index.
+     * @param dataset_dir : path of the dataset
+     * @param fix : remove invalid samples, regenerate resized samples and rewrite manifests or not
+     * @param report : the result
+     * @retval true : successfully checked
+     * @retval false : the dataset directory does not exist
+     */
+    bool check(const QString &dataset_dir, const bool &fix, Report &report);
+
+    /**
+     * @brief describe returns a short description of the given problem.
+     */
+    static QString describe(const PROBLEM &problem);
+    /**
+     * @brief listFiles lists the names of the regular files in a directory.
+     *
+     * On Linux, the directory entries are read in large batches through `getdents64` without `stat` on each file.
+     *
+     * @param dir_path : path of the directory
+     * @param names : the names of the files
+     * @retval true : successfully listed
+     * @retval false : failed to open the directory
+     */
+    static bool listFiles(const QString &dir_path, std::vector<std::string> &names);
+    /**
+     * @brief readImageHeader parses the dimensions of an image from the beginning and the end of its file.
+     *
+     * BMP, PNM (`P4`, `P5` and `P6`), PNG, JPEG, WebP and QOI are supported.
+     *
+     * @param head : the first bytes of the file
+     * @param head_size : number of bytes in `head`
+     * @param tail : the last bytes of the file
+     * @param tail_size : number of bytes in `tail`
+     * @param file_size : size of the file
+     * @param width : width of the image
+     * @param height : height of the image
+     * @return whether the file is valid
+     */
+    static HEADER readImageHeader(const uchar *head, const qint64 &head_size,
+                                  const uchar *tail, const qint64 &tail_size,
+                                  const qint64 &file_size, int &width, int &height);
+
+private:
+    DatasetChecker(const DatasetChecker &) = delete;
+    DatasetChecker &operator=(const DatasetChecker &) = delete;
+
+    struct Entry
+    {
+        quint32 id = 0;
+        std::string name;
+        int width = 0;
+        int height = 0;
+        PROBLEM problem = PROBLEM_NONE;
+    };
+    struct Folder
+    {
+        QString path;
+        int size = 0;  // size of the resized samples, 0 for the original and processed images
+        bool exists = false;
+        std::vector<Entry> entries;
+    };
+    struct Label
+    {
+        QString name;
+        QString path;
+        Folder orig;
+        Folder proc;
+        std::vector<Folder> resized;
+        std::vector<quint32> samples;
+        Report report;
+    };
+    class Task;
+
+    QThreadPool _pool;
+
+    void _list(Label &label);
+    void _validate(Folder &folder, const size_t &begin, const size_t &end);
+    void _reconcile(Label &label, const bool &fix);
+};
+
+#endif // DATASETCHECKER_H
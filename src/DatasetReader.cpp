@@ -0,0 +1,607 @@
+#include "DatasetReader.hpp"
+
+#include <QDir>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QMutexLocker>
+#include <QThread>
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+namespace
+{
+    const char PACK_MAGIC[4] = {'G', 'S', 'P', 'K'};
+    const quint16 PACK_VERSION = 1;
+
+    struct PackHeader
+    {
+        char magic[4];
+        quint16 version;
+        quint16 sample_size;
+        quint32 count;
+        quint32 label_bytes;
+    };
+
+    const char INDEX_MAGIC[4] = {'G', 'S', 'I', 'X'};
+    const quint16 INDEX_VERSION = 1;
+
+    struct IndexHeader
+    {
+        char magic[4];
+        quint16 version;
+        quint16 reserved;
+        quint32 label_bytes;
+        quint32 count;
+    };
+
+    inline qint64 alignTo(const qint64 &offset, const qint64 &alignment)
+    {
+        return (offset + alignment - 1) / alignment * alignment;
+    }
+}
+
+class DatasetReader::BatchIterator::FillTask : public QRunnable
+{
+public:
+    FillTask(BatchIterator *it, const int &slot) : _it(it), _slot(slot) {}
+    void run() override
+    {
+        _it->_fill(_slot);
+    }
+private:
+    BatchIterator *_it;
+    int _slot;
+};
+
+DatasetReader::DatasetReader() :
+    labels(_labels),
+    sample_size(_sample_size),
+    _sample_size(0),
+    _pack(nullptr),
+    _pack_data(nullptr),
+    _pack_labels(nullptr),
+    _pack_ids(nullptr),
+    _pack_masks(nullptr),
+    _pack_count(0)
+{}
+
+DatasetReader::~DatasetReader()
+{
+    close();
+}
+
+bool DatasetReader::open(const QString &path, const int &sample_size)
+{
+    close();
+    QFileInfo info(path);
+    if (info.isFile())
+        return _openPack(path);
+    if (info.isDir() && sample_size > 0)
+        return _openDirectory(path, sample_size);
+    return false;
+}
+
+void DatasetReader::close()
+{
+    if (_pack != nullptr)
+    {
+        delete _pack; // unmaps the file
+        _pack = nullptr;
+    }
+    _pack_data = nullptr;
+    _pack_labels = nullptr;
+    _pack_ids = nullptr;
+    _pack_masks = nullptr;
+    _pack_count = 0;
+    _labels.clear();
+    _files.clear();
+    _sample_labels.clear();
+    _sample_ids.clear();
+    _sample_size = 0;
+}
+
+int DatasetReader::size() const
+{
+    return _pack != nullptr ? _pack_count : _files.size();
+}
+
+qint32 DatasetReader::label(const int &index) const
+{
+    return _pack != nullptr ? _pack_labels[index] : _sample_labels[index];
+}
+
+quint32 DatasetReader::sampleId(const int &index) const
+{
+    return _pack != nullptr ? _pack_ids[index] : _sample_ids[index];
+}
+
+bool DatasetReader::decode(const int &index, uchar *dst) const
+{
+    const size_t bytes = static_cast<size_t>(_sample_size)*_sample_size;
+    if (_pack != nullptr)
+    {
+        std::memcpy(dst, _pack_masks + bytes*index, bytes);
+        return true;
+    }
+
+    cv::Mat out(_sample_size, _sample_size, CV_8UC1, dst);
+    QFile file(_files[index]);
+    if (!file.open(QIODevice::ReadOnly) || file.size() == 0)
+    {
+        out.setTo(cv::Scalar(0));
+        return false;
+    }
+
+    // map the file to avoid an extra copy of its content; fall back to read it if mapping is not supported
+    QByteArray content;
+    const uchar *data = file.map(0, file.size());
+    if (data == nullptr)
+    {
+        content = file.readAll();
+        data = reinterpret_cast<const uchar *>(content.constData());
+    }
+
+    int width, height;
+    qint64 offset;
+    cv::Mat img;
+    if (readPgmHeader(data, file.size(), width, height, offset))
+        img = cv::Mat(height, width, CV_8UC1, const_cast<uchar *>(data + offset));
+    else
+        img = cv::imdecode(cv::Mat(1, static_cast<int>(file.size()), CV_8UC1, const_cast<uchar *>(data)),
+                           cv::IMREAD_GRAYSCALE);
+
+    bool success = !img.empty();
+    if (!success)
+        out.setTo(cv::Scalar(0));
+    else if (img.rows == _sample_size && img.cols == _sample_size)
+        img.copyTo(out);
+    else
+        letterbox(img, out);
+    return success;
+}
+
+bool DatasetReader::pack(const QString &dataset_dir, const QString &pack_file, const int &sample_size)
+{
+    DatasetReader reader;
+    if (sample_size < 1 || sample_size > 0xFFFF || !QFileInfo(dataset_dir).isDir() ||
+        !reader.open(dataset_dir, sample_size))
+        return false;
+
+    QByteArray label_names = reader.labels.join('\n').toUtf8();
+    PackHeader header;
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    header.sample_size = sample_size;
+    header.count = reader.size();
+    header.label_bytes = label_names.size();
+
+    QString tmp_path = pack_file + ".tmp";
+    QFile file(tmp_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    auto pad = [&file](const qint64 &alignment)
+    {
+        qint64 n = alignTo(file.pos(), alignment) - file.pos();
+        return n == 0 || file.write(QByteArray(static_cast<int>(n), 0)) == n;
+    };
+
+    bool success = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header) &&
+                   file.write(label_names) == label_names.size() &&
+                   pad(8) &&
+                   file.write(reinterpret_cast<const char *>(reader._sample_labels.data()), sizeof(qint32)*header.count)
+                       == static_cast<qint64>(sizeof(qint32)*header.count) &&
+                   file.write(reinterpret_cast<const char *>(reader._sample_ids.data()), sizeof(quint32)*header.count)
+                       == static_cast<qint64>(sizeof(quint32)*header.count) &&
+                   pad(64);
+
+    if (success)
+    {
+        BatchIterator it(reader, DATASET_READER_PACK_BATCH_SIZE);
+        Batch batch;
+        const qint64 bytes = static_cast<qint64>(sample_size)*sample_size;
+        while (success && it.next(batch))
+            success = file.write(reinterpret_cast<const char *>(batch.data), bytes*batch.count) == bytes*batch.count;
+    }
+    file.close();
+    if (!success)
+    {
+        file.remove();
+        return false;
+    }
+    QFile::remove(pack_file);
+    return QFile::rename(tmp_path, pack_file);
+}
+
+void DatasetReader::letterbox(const cv::Mat &src, cv::Mat &dst)
+{
+    // written into the buffer of dst in place, which may wrap external memory such as a batch
+    CV_Assert(dst.type() == CV_8UC1 && dst.rows == dst.cols && dst.rows > 0);
+    if (src.empty())
+    {
+        dst.setTo(cv::Scalar(0));
+        return;
+    }
+    CV_Assert(src.type() == CV_8UC1);
+    cv::Mat integral;
+    cv::integral(src, integral, CV_64F);
+    _letterbox(integral, src.size(), dst.cols, dst);
+}
+
+void DatasetReader::letterbox(const cv::Mat &src, const std::vector<int> &sizes, std::vector<cv::Mat> &dsts)
+{
+    CV_Assert(src.empty() || src.type() == CV_8UC1);
+    dsts.resize(sizes.size());
+    if (src.empty())
+    {
+        for (auto &d : dsts)
+            d.release();
+        return;
+    }
+
+    // One integral image serves all target sizes.
+    // It is in double, which holds the sums of 8-bit pixels exactly for an image of any size.
+    cv::Mat integral;
+    cv::integral(src, integral, CV_64F);
+    for (size_t i = 0; i < sizes.size(); ++i)
+        _letterbox(integral, src.size(), sizes[i], dsts[i]);
+}
+
+void DatasetReader::_letterbox(const cv::Mat &integral, const cv::Size &src_size, const int &size, cv::Mat &dst)
+{
+    dst.create(size, size, CV_8UC1);
+    dst.setTo(cv::Scalar(0));
+
+    // scale the longer side to the target size and center the image
+    double scale = double(size)/std::max(src_size.width, src_size.height);
+    const int w = std::max(1, std::min(size, static_cast<int>(std::lround(src_size.width*scale))));
+    const int h = std::max(1, std::min(size, static_cast<int>(std::lround(src_size.height*scale))));
+    const int x0 = (size - w)/2, y0 = (size - h)/2;
+
+    // Boundaries of the output pixels on the source image.
+    // The integral of a piecewise constant image is bilinear inside each pixel,
+    // so that interpolating the integral image gives the exact sum over fractional boxes.
+    std::vector<int> xi(w + 1);
+    std::vector<double> xf(w + 1);
+    for (int i = 0; i <= w; ++i)
+    {
+        double x = double(i)*src_size.width/w;
+        xi[i] = std::min(static_cast<int>(x), src_size.width - 1);
+        xf[i] = x - xi[i];
+    }
+    const double inv_area = double(w)*h/(double(src_size.width)*src_size.height);
+
+    std::vector<double> prev(w + 1), curr(w + 1);
+    auto interpolateRow = [&](const int &j, std::vector<double> &row)
+    {
+        double y = double(j)*src_size.height/h;
+        int yi = std::min(static_cast<int>(y), src_size.height - 1);
+        double yf = y - yi;
+        const double *r0 = integral.ptr<double>(yi);
+        const double *r1 = integral.ptr<double>(yi + 1);
+        for (int i = 0; i <= w; ++i)
+        {
+            double top = r0[xi[i]] + xf[i]*(r0[xi[i] + 1] - r0[xi[i]]);
+            double bottom = r1[xi[i]] + xf[i]*(r1[xi[i] + 1] - r1[xi[i]]);
+            row[i] = top + yf*(bottom - top);
+        }
+    };
+
+    interpolateRow(0, prev);
+    for (int j = 0; j < h; ++j)
+    {
+        interpolateRow(j + 1, curr);
+        uchar *out = dst.ptr<uchar>(y0 + j) + x0;
+        for (int i = 0; i < w; ++i)
+        {
+            double v = (curr[i + 1] - curr[i] - prev[i + 1] + prev[i])*inv_area;
+            out[i] = cv::saturate_cast<uchar>(v);
+        }
+        std::swap(prev, curr);
+    }
+}
+
+bool DatasetReader::readPgmHeader(const uchar *data, const qint64 &size, int &width, int &height, qint64 &offset)
+{
+    if (size < 2 || data[0] != 'P' || data[1] != '5')
+        return false;
+    qint64 pos = 2;
+    int fields[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        // skip whitespace and comments
+        while (pos < size && (std::isspace(data[pos]) || data[pos] == '#'))
+        {
+            if (data[pos] == '#')
+                while (pos < size && data[pos] != '\n')
+                    ++pos;
+            else
+                ++pos;
+        }
+        if (pos >= size || !std::isdigit(data[pos]))
+            return false;
+        fields[i] = 0;
+        while (pos < size && std::isdigit(data[pos]))
+        {
+            fields[i] = fields[i]*10 + (data[pos] - '0');
+            if (fields[i] > 0xFFFF)
+                return false;
+            ++pos;
+        }
+    }
+    // a single whitespace separates the header and the pixel data
+    if (pos >= size || !std::isspace(data[pos]) || fields[2] < 1 || fields[2] > 255)
+        return false;
+    width = fields[0];
+    height = fields[1];
+    offset = pos + 1;
+    return width > 0 && height > 0 && offset + static_cast<qint64>(width)*height <= size;
+}
+
+bool DatasetReader::_openPack(const QString &file_path)
+{
+    _pack = new QFile(file_path);
+    if (!_pack->open(QIODevice::ReadOnly) || _pack->size() < static_cast<qint64>(sizeof(PackHeader)) ||
+        (_pack_data = _pack->map(0, _pack->size())) == nullptr)
+    {
+        close();
+        return false;
+    }
+
+    PackHeader header;
+    std::memcpy(&header, _pack_data, sizeof(header));
+    qint64 labels_offset = alignTo(sizeof(header) + header.label_bytes, 8);
+    qint64 ids_offset = labels_offset + sizeof(qint32)*static_cast<qint64>(header.count);
+    qint64 masks_offset = alignTo(ids_offset + sizeof(quint32)*static_cast<qint64>(header.count), 64);
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version > PACK_VERSION ||
+        header.sample_size == 0 ||
+        masks_offset + static_cast<qint64>(header.sample_size)*header.sample_size*header.count > _pack->size())
+    {
+        close();
+        return false;
+    }
+
+    _labels = QString::fromUtf8(reinterpret_cast<const char *>(_pack_data + sizeof(header)),
+                                header.label_bytes).split('\n');
+    _sample_size = header.sample_size;
+    _pack_count = header.count;
+    _pack_labels = reinterpret_cast<const qint32 *>(_pack_data + labels_offset);
+    _pack_ids = reinterpret_cast<const quint32 *>(_pack_data + ids_offset);
+    _pack_masks = _pack_data + masks_offset;
+    return true;
+}
+
+bool DatasetReader::_openDirectory(const QString &dir_path, const int &sample_size)
+{
+    if (_openIndex(dir_path, sample_size))
+        return true;
+
+    QDir dir(dir_path);
+    QString size_dir = QString::number(sample_size);
+    for (const auto &label : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name))
+    {
+        QDir label_dir(dir.filePath(label));
+        QDir sample_dir(label_dir.filePath(size_dir));
+        if (!sample_dir.exists())
+            sample_dir.setPath(label_dir.filePath(SAMPLE_PROC_FORMAT));
+        if (!sample_dir.exists())
+            continue;
+
+        qint32 label_index = _labels.size();
+        _labels.append(label);
+        for (const auto &f : sample_dir.entryList(QDir::Files | QDir::NoDotAndDotDot, QDir::Name))
+        {
+            bool ok;
+            quint32 id = f.toUInt(&ok);
+            if (!ok)
+                continue;
+            _files.append(sample_dir.filePath(f));
+            _sample_labels.push_back(label_index);
+            _sample_ids.push_back(id);
+        }
+    }
+    _sample_size = sample_size;
+    return true;
+}
+
+bool DatasetReader::_openIndex(const QString &dir_path, const int &sample_size)
+{
+    QDir dir(dir_path);
+    QFileInfo index_info(dir.filePath(DATASET_INDEX_FILE_NAME));
+    if (!index_info.isFile())
+        return false;
+    // a label created after indexing changes the modified time of the dataset directory
+    QDateTime indexed = index_info.lastModified();
+    if (QFileInfo(dir_path).lastModified() > indexed)
+        return false;
+
+    QFile file(index_info.filePath());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray content = file.readAll();
+    IndexHeader header;
+    if (content.size() < static_cast<int>(sizeof(header)))
+        return false;
+    std::memcpy(&header, content.constData(), sizeof(header));
+    qint64 labels_offset = alignTo(sizeof(header) + header.label_bytes, 4);
+    qint64 ids_offset = labels_offset + sizeof(qint32)*static_cast<qint64>(header.count);
+    if (std::memcmp(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC)) != 0 || header.version > INDEX_VERSION ||
+        ids_offset + static_cast<qint64>(sizeof(quint32)*header.count) > static_cast<qint64>(content.size()))
+        return false;
+
+    QStringList labels;
+    if (header.label_bytes > 0)
+        labels = QString::fromUtf8(content.constData() + sizeof(header), header.label_bytes).split('\n');
+    // samples added or removed after indexing change the modified time of their directory
+    QString size_dir = QString::number(sample_size);
+    QStringList sample_dirs;
+    for (const auto &label : labels)
+    {
+        QDir label_dir(dir.filePath(label));
+        QFileInfo info(label_dir.filePath(size_dir));
+        if (!info.isDir())
+            info.setFile(label_dir.filePath(SAMPLE_PROC_FORMAT));
+        if (!info.isDir() || info.lastModified() > indexed)
+            return false;
+        sample_dirs.append(info.filePath());
+    }
+
+    const qint32 *sample_labels = reinterpret_cast<const qint32 *>(content.constData() + labels_offset);
+    const quint32 *sample_ids = reinterpret_cast<const quint32 *>(content.constData() + ids_offset);
+    for (quint32 i = 0; i < header.count; ++i)
+        if (sample_labels[i] < 0 || sample_labels[i] >= labels.size())
+            return false;
+
+    _labels = labels;
+    _sample_labels.assign(sample_labels, sample_labels + header.count);
+    _sample_ids.assign(sample_ids, sample_ids + header.count);
+    _files.reserve(header.count);
+    for (quint32 i = 0; i < header.count; ++i)
+        _files.append(sample_dirs[sample_labels[i]] + '/' + QString::number(sample_ids[i]));
+    _sample_size = sample_size;
+    return true;
+}
+
+bool DatasetReader::saveIndex(const QString &dataset_dir, const QStringList &labels,
+                              const std::vector<qint32> &sample_labels, const std::vector<quint32> &sample_ids)
+{
+    if (sample_labels.size() != sample_ids.size())
+        return false;
+
+    QByteArray label_names = labels.join('\n').toUtf8();
+    IndexHeader header;
+    std::memcpy(header.magic, INDEX_MAGIC, sizeof(INDEX_MAGIC));
+    header.version = INDEX_VERSION;
+    header.reserved = 0;
+    header.label_bytes = label_names.size();
+    header.count = static_cast<quint32>(sample_ids.size());
+
+    QByteArray content;
+    content.append(reinterpret_cast<const char *>(&header), sizeof(header));
+    content.append(label_names);
+    content.append(QByteArray(static_cast<int>(alignTo(content.size(), 4) - content.size()), 0));
+    content.append(reinterpret_cast<const char *>(sample_labels.data()), sizeof(qint32)*header.count);
+    content.append(reinterpret_cast<const char *>(sample_ids.data()), sizeof(quint32)*header.count);
+
+    // written in place, instead of renaming a temporary file, so that the index is not older than the dataset directory;
+    // a partially written index is rejected by its size check when being opened
+    QFile file(QDir(dataset_dir).filePath(DATASET_INDEX_FILE_NAME));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    if (file.write(content) != content.size())
+    {
+        file.remove();
+        return false;
+    }
+    return true;
+}
+
+DatasetReader::BatchIterator::BatchIterator(const DatasetReader &reader, const int &batch_size,
+                                            const bool &shuffle, const unsigned int &seed,
+                                            const int &prefetch, const int &threads) :
+    _reader(reader),
+    _batch_size(std::max(1, batch_size)),
+    _batches((reader.size() + _batch_size - 1) / _batch_size),
+    _next_batch(0),
+    _consuming(-1),
+    _order(reader.size()),
+    _zero_copy(reader._pack != nullptr && !shuffle)
+{
+    for (int i = 0, n = reader.size(); i < n; ++i)
+        _order[i] = i;
+    if (shuffle)
+        std::shuffle(_order.begin(), _order.end(), std::mt19937(seed));
+
+    if (_zero_copy)
+        return;
+
+    _pool.setMaxThreadCount(threads > 0 ? threads : QThread::idealThreadCount());
+    _slots.resize(std::min(_batches, std::max(2, prefetch > 0 ? prefetch : _pool.maxThreadCount())));
+    const size_t bytes = static_cast<size_t>(reader.sample_size)*reader.sample_size*_batch_size;
+    for (int i = 0, n = static_cast<int>(_slots.size()); i < n; ++i)
+    {
+        _slots[i].data.resize(bytes);
+        _slots[i].labels.resize(_batch_size);
+        _slots[i].sample_ids.resize(_batch_size);
+        _schedule(i, i);
+    }
+}
+
+DatasetReader::BatchIterator::~BatchIterator()
+{
+    _pool.waitForDone();
+}
+
+int DatasetReader::BatchIterator::batches() const
+{
+    return _batches;
+}
+
+bool DatasetReader::BatchIterator::next(Batch &batch)
+{
+    if (_next_batch >= _batches)
+        return false;
+    const int batch_index = _next_batch++;
+    const int first = batch_index*_batch_size;
+    const int count = std::min(_batch_size, _reader.size() - first);
+
+    if (_zero_copy)
+    {
+        batch.data = _reader._pack_masks + static_cast<size_t>(_reader.sample_size)*_reader.sample_size*first;
+        batch.labels = _reader._pack_labels + first;
+        batch.sample_ids = _reader._pack_ids + first;
+        batch.count = count;
+        return true;
+    }
+
+    QMutexLocker lock(&_mutex);
+    // recycle the slot consumed last time for the batch after the prefetched ones
+    if (_consuming > -1)
+    {
+        _slots[_consuming].state = SLOT_EMPTY;
+        int refill = _slots[_consuming].batch_index + static_cast<int>(_slots.size());
+        if (refill < _batches)
+            _schedule(_consuming, refill);
+    }
+    _consuming = batch_index % static_cast<int>(_slots.size());
+    Slot &slot = _slots[_consuming];
+    while (slot.state != SLOT_READY || slot.batch_index != batch_index)
+        _ready.wait(&_mutex);
+
+    batch.data = slot.data.data();
+    batch.labels = slot.labels.data();
+    batch.sample_ids = slot.sample_ids.data();
+    batch.count = slot.count;
+    return true;
+}
+
+void DatasetReader::BatchIterator::_schedule(const int &slot, const int &batch_index)
+{
+    _slots[slot].state = SLOT_FILLING;
+    _slots[slot].batch_index = batch_index;
+    _pool.start(new FillTask(this, slot));
+}
+
+void DatasetReader::BatchIterator::_fill(const int &slot)
+{
+    Slot &s = _slots[slot];
+    const int first = s.batch_index*_batch_size;
+    const int count = std::min(_batch_size, _reader.size() - first);
+    const size_t bytes = static_cast<size_t>(_reader.sample_size)*_reader.sample_size;
+    for (int i = 0; i < count; ++i)
+    {
+        const int index = _order[first + i];
+        bool success = _reader.decode(index, s.data.data() + bytes*i);
+        s.labels[i] = success ? _reader.label(index) : -1;
+        s.sample_ids[i] = _reader.sampleId(index);
+    }
+
+    QMutexLocker lock(&_mutex);
+    s.count = count;
+    s.state = SLOT_READY;
+    _ready.wakeAll();
+}
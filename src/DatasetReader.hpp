@@ -0,0 +1,277 @@
+#ifndef DATASETREADER_H
+#define DATASETREADER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The DatasetReader.hpp file contains the class of reading the collected samples in batches.
+ */
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QFile>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QThreadPool>
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+#include "config.h"
+
+/**
+ * @brief The DatasetReader class opens a collected dataset and provides its samples, as fixed-size masks, to the training code.
+ *
+ * Two layouts are supported:
+ *
+ *  - the directory layout made by #SampleCollector , i.e. `dataset/label_name/PGM/sample`.
+ *    If a directory named by the sample size, e.g. `dataset/label_name/64/`, exists, the resized samples in it are used;
+ *    otherwise the samples in the `PGM` directory are resized with letterboxing during decoding.
+ *    If the dataset has an index file, #DATASET_INDEX_FILE_NAME , newer than its sample directories,
+ *    only the samples listed in it are read, without listing the directories.
+ *  - the packed layout made by #DatasetReader::pack , i.e. a single file holding all masks of one size contiguously.
+ *    The file is memory-mapped and batches point into the mapping directly when the samples are read in order.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe. The dataset must keep opened while a #DatasetReader::BatchIterator is in use.
+ *
+ * Usage:
+ *
+ *      DatasetReader reader;
+ *      reader.open("samples", 64);
+ *      DatasetReader::BatchIterator it(reader, 256, true);
+ *      DatasetReader::Batch batch;
+ *      while (it.next(batch))
+ *          train(batch.data, batch.labels, batch.count);
+ *
+ * @see #DatasetReader::BatchIterator
+ */
+class DatasetReader
+{
+public:
+    /**
+     * @brief The Batch struct is a batch of samples.
+     *
+     * The pointers are valid until the next call of #DatasetReader::BatchIterator::next .
+     */
+    struct Batch
+    {
+        /**
+         * @brief data is the masks, `count x sample_size x sample_size` bytes, stored contiguously in row-major order.
+         */
+        const uchar *data = nullptr;
+        /**
+         * @brief labels is the index, into #DatasetReader::labels , of each sample, or -1 if the sample failed to be decoded.
+         */
+        const qint32 *labels = nullptr;
+        /**
+         * @brief sample_ids is the name of each sample file.
+         */
+        const quint32 *sample_ids = nullptr;
+        /**
+         * @brief count is the number of samples in this batch. Only the last batch may have less samples than the batch size.
+         */
+        int count = 0;
+    };
+
+    /**
+     * @brief The BatchIterator class yields batches of a dataset with prefetching.
+     *
+     * Batches are decoded by a thread pool ahead of the consumer.
+     * In the packed layout, without shuffling, no decoding is needed and the batches point into the memory-mapped file.
+     */
+    class BatchIterator
+    {
+    public:
+        /**
+         * @brief BatchIterator is the constructor.
+         * @param reader : an opened dataset
+         * @param batch_size : the maximum number of samples per batch
+         * @param shuffle : read the samples in random order or not
+         * @param seed : seed of the random order
+         * @param prefetch : number of batches decoded ahead. Use the number of threads of the pool if 0 is given.
+         * @param threads : number of decoding threads. Use the ideal thread count if 0 is given.
+         */
+        BatchIterator(const DatasetReader &reader, const int &batch_size,
+                      const bool &shuffle = false, const unsigned int &seed = 0,
+                      const int &prefetch = 0, const int &threads = 0);
+        ~BatchIterator();
+        /**
+         * @brief next fetches the next batch. It blocks until the batch is ready.
+         * @param batch : the next batch
+         * @retval true : a batch is fetched
+         * @retval false : all batches have been fetched
+         */
+        bool next(Batch &batch);
+        /**
+         * @brief batches is the total number of batches.
+         */
+        int batches() const;
+
+    private:
+        BatchIterator(const BatchIterator &) = delete;
+        BatchIterator &operator=(const BatchIterator &) = delete;
+
+        enum SLOT_STATE
+        {
+            SLOT_EMPTY,
+            SLOT_FILLING,
+            SLOT_READY
+        };
+        struct Slot
+        {
+            SLOT_STATE state = SLOT_EMPTY;
+            int batch_index = -1;
+            int count = 0;
+            std::vector<uchar> data;
+            std::vector<qint32> labels;
+            std::vector<quint32> sample_ids;
+        };
+        class FillTask;
+
+        const DatasetReader &_reader;
+        int _batch_size;
+        int _batches;
+        int _next_batch;
+        int _consuming;
+        std::vector<int> _order;
+        std::vector<Slot> _slots;
+        bool _zero_copy;
+        QMutex _mutex;
+        QWaitCondition _ready;
+        QThreadPool _pool;
+
+        void _schedule(const int &slot, const int &batch_index);
+        void _fill(const int &slot);
+    };
+
+    /**
+     * @brief labels is the names of the labels in the dataset.
+     */
+    const QStringList &labels;
+    /**
+     * @brief sample_size is the width and height of the masks.
+     */
+    const int &sample_size;
+
+    DatasetReader();
+    ~DatasetReader();
+
+    /**
+     * @brief open opens a dataset.
+     * @param path : path of the dataset directory, or path of a packed file
+     * @param sample_size : width and height of the masks yielded. It is ignored when a packed file is opened.
+     * @retval true : successfully opened
+     * @retval false : the path is neither a dataset directory nor a valid packed file
+     */
+    bool open(const QString &path, const int &sample_size);
+    /**
+     * @brief close closes the dataset.
+     */
+    void close();
+    /**
+     * @brief size returns the number of samples in the dataset.
+     */
+    int size() const;
+    /**
+     * @brief decode decodes one sample into the given buffer.
+     * @param index : index of the sample
+     * @param dst : buffer with at least `sample_size x sample_size` bytes
+     * @retval true : successfully decoded
+     * @retval false : failed to read or decode the sample file. The buffer is zeroed.
+     */
+    bool decode(const int &index, uchar *dst) const;
+    /**
+     * @brief label returns the label index of the given sample.
+     */
+    qint32 label(const int &index) const;
+    /**
+     * @brief sampleId returns the name of the given sample file.
+     */
+    quint32 sampleId(const int &index) const;
+
+    /**
+     * @brief pack writes all samples of a dataset into a single packed file.
+     * @param dataset_dir : path of the dataset in the directory layout
+     * @param pack_file : path of the packed file that will be written
+     * @param sample_size : width and height of the packed masks
+     * @retval true : successfully packed
+     * @retval false : failed to open the dataset or to write the packed file
+     */
+    static bool pack(const QString &dataset_dir, const QString &pack_file, const int &sample_size);
+    /**
+     * @brief saveIndex writes the index file of a dataset in the directory layout.
+     *
+     * The file, #DATASET_INDEX_FILE_NAME in the dataset directory, consists of
+     *
+     *      header: "GSIX" (4 bytes), version (uint16), reserved (uint16), label bytes (uint32), count (uint32)
+     *      label names joined by '\n', padded to 4 bytes
+     *      count x label index (int32)
+     *      count x sample id (uint32)
+     *
+     * @param dataset_dir : path of the dataset
+     * @param labels : names of the labels
+     * @param sample_labels : the label index of each sample
+     * @param sample_ids : the name of each sample file
+     * @retval true : successfully saved
+     * @retval false : failed to write the file
+     */
+    static bool saveIndex(const QString &dataset_dir, const QStringList &labels,
+                          const std::vector<qint32> &sample_labels, const std::vector<quint32> &sample_ids);
+    /**
+     * @brief letterbox resizes the given mask to fit in a square, keeping aspect ratio, and pads the rest with black.
+     *
+     * This is the same as what `scripts/resize_samples.rb` does. Each pixel of the result is the exact average of
+     * the source area it covers, computed from the integral image of the mask.
+     * The collector and the checker both resize samples by this function, so that their results are identical.
+     *
+     * @param src : the mask of type `CV_8UC1`. An empty one gives a black result.
+     * @param dst : the square destination of type `CV_8UC1`, whose size is the target size.
+     *              It must be allocated by the caller and is written in place.
+     */
+    static void letterbox(const cv::Mat &src, cv::Mat &dst);
+    /**
+     * @brief letterbox resizes the given mask to several square sizes at once, sharing one integral image.
+     * @param src : the mask of type `CV_8UC1`
+     * @param sizes : width and height of each result
+     * @param dsts : the results, in the order of `sizes`
+     *
+     * @see #DatasetReader::letterbox(const cv::Mat &, cv::Mat &)
+     */
+    static void letterbox(const cv::Mat &src, const std::vector<int> &sizes, std::vector<cv::Mat> &dsts);
+    /**
+     * @brief readPgmHeader parses the header of a binary (P5) PGM image.
+     * @param data : the file content
+     * @param size : size of the file content in bytes
+     * @param width : width of the image
+     * @param height : height of the image
+     * @param offset : offset of the pixel data from the beginning of the file
+     * @retval true : a valid 8-bit P5 header is found
+     * @retval false : otherwise
+     */
+    static bool readPgmHeader(const uchar *data, const qint64 &size, int &width, int &height, qint64 &offset);
+
+private:
+    DatasetReader(const DatasetReader &) = delete;
+    DatasetReader &operator=(const DatasetReader &) = delete;
+
+    QStringList _labels;
+    int _sample_size;
+    // directory layout
+    QStringList _files;
+    std::vector<qint32> _sample_labels;
+    std::vector<quint32> _sample_ids;
+    // packed layout
+    QFile *_pack;
+    const uchar *_pack_data;
+    const qint32 *_pack_labels;
+    const quint32 *_pack_ids;
+    const uchar *_pack_masks;
+    int _pack_count;
+
+    static void _letterbox(const cv::Mat &integral, const cv::Size &src_size, const int &size, cv::Mat &dst);
+    bool _openPack(const QString &file_path);
+    bool _openDirectory(const QString &dir_path, const int &sample_size);
+    bool _openIndex(const QString &dir_path, const int &sample_size);
+};
+
+#endif // DATASETREADER_H
@@ -0,0 +1,523 @@
+#include "FramePipeline.hpp"
+
+#include <QMutexLocker>
+#include <QMetaObject>
+#include <QDateTime>
+
+#include <algorithm>
+
+FramePipeline::FramePipeline(HandDetector *hand_detector, SampleCollector *sample_collector) :
+    QObject(nullptr),
+    _hand_detector(hand_detector),
+    _sample_collector(sample_collector),
+    _recorder(new SessionRecorder),
+    _landmarks(new LandmarkStream),
+    _camera(nullptr),
+    _timer(nullptr),
+    _last_detection(0),
+    _last_capture(0),
+    _frame_id(0),
+    _capture_interval(1000/CAMERA_FPS),
+    _sampling(false),
+    _sampling_amount(0),
+    _samples_collected(0),
+    _detection_interval(1000/CAMERA_FPS),
+    _monitor_enabled(0),
+    _counters_enabled(0),
+    _frozen(0),
+    _tracking_enabled(0),
+    _burst_seconds(0),
+    _burst_stable_frames(0),
+    _clip_length(0),
+    _preview_updated(false),
+    _monitor_updated(false)
+{
+    connect(_recorder, SIGNAL(recordFailed(QString)), this, SIGNAL(recordingFailed()));
+    connect(_landmarks, SIGNAL(writeFailed(QString)), this, SIGNAL(recordingFailed()));
+    _hand_detector->moveToThread(&_thread);
+    moveToThread(&_thread);
+    _thread.start();
+}
+
+FramePipeline::~FramePipeline()
+{
+    releaseCamera();
+    _thread.quit();
+    _thread.wait();
+    delete _recorder;
+    delete _landmarks;
+    delete _camera;
+}
+
+void FramePipeline::openCamera(const int &device, const int &fps, const cv::Size &frame_size)
+{
+    QMetaObject::invokeMethod(this, "_open", Qt::QueuedConnection,
+                              Q_ARG(int, device), Q_ARG(int, fps),
+                              Q_ARG(int, frame_size.width), Q_ARG(int, frame_size.height));
+}
+
+void FramePipeline::releaseCamera()
+{
+    QMetaObject::invokeMethod(this, "_release", Qt::BlockingQueuedConnection);
+}
+
+void FramePipeline::startSampling(const int &amount, const int &stable_frames,
+                                  const QString &recording_path, const QString &label,
+                                  const QString &landmark_path)
+{
+    QMetaObject::invokeMethod(this, "_startSampling", Qt::QueuedConnection,
+                              Q_ARG(int, amount), Q_ARG(int, stable_frames),
+                              Q_ARG(QString, recording_path), Q_ARG(QString, label),
+                              Q_ARG(QString, landmark_path));
+}
+
+void FramePipeline::stopSampling()
+{
+    QMetaObject::invokeMethod(this, "_stopSampling", Qt::BlockingQueuedConnection);
+}
+
+void FramePipeline::setRoi(const cv::Rect &roi)
+{
+    QMutexLocker lock(&_mutex);
+    _roi = roi;
+}
+
+void FramePipeline::setDetectionFps(const int &fps)
+{
+    _detection_interval.store(fps > 0 ? 1000/fps : 0);
+}
+
+void FramePipeline::setMonitorEnabled(const bool &enable)
+{
+    _monitor_enabled.store(enable ? 1 : 0);
+}
+
+void FramePipeline::setFrozen(const bool &freeze)
+{
+    _frozen.store(freeze ? 1 : 0);
+}
+
+void FramePipeline::setTrackingEnabled(const bool &enable)
+{
+    _tracking_enabled.store(enable ? 1 : 0);
+}
+
+void FramePipeline::setBurst(const int &seconds, const int &stable_frames)
+{
+    _burst_stable_frames.store(stable_frames);
+    _burst_seconds.store(qBound(0, seconds, BURST_MAX_SECONDS));
+}
+
+void FramePipeline::setClipLength(const int &frames)
+{
+    _clip_length.store(qBound(0, frames, SAMPLING_CLIP_MAX_LENGTH));
+}
+
+void FramePipeline::setCountersEnabled(const bool &enable)
+{
+    _counters_enabled.store(enable ? 1 : 0);
+}
+
+FramePipeline::Counters FramePipeline::counters()
+{
+    QMutexLocker lock(&_mutex);
+    return _counters;
+}
+
+bool FramePipeline::takePreviewFrame(cv::Mat &frame, cv::Rect &roi, DetectionResult &result)
+{
+    QMutexLocker lock(&_mutex);
+    if (!_preview_updated)
+        return false;
+    frame = _preview_frame;
+    roi = _preview_roi;
+    result = _result;
+    _preview_frame.release();
+    _preview_updated = false;
+    return true;
+}
+
+bool FramePipeline::takeMonitorImages(std::vector<cv::Mat> &images, DetectionResult &result)
+{
+    QMutexLocker lock(&_mutex);
+    if (!_monitor_updated)
+        return false;
+    result = _result;
+    images.swap(_monitor_images);
+    _monitor_images.clear();
+    _monitor_updated = false;
+    return true;
+}
+
+void FramePipeline::fitFrame(cv::Mat &frame, const cv::Size &frame_size)
+{
+    // resize and keep aspect ratio
+    cv::resize(frame, frame,
+               cv::Size(frame.cols*frame_size.height/frame.rows, frame_size.height),
+               0, 0, cv::INTER_AREA);
+    if (frame.cols > frame_size.width)
+        frame = frame(cv::Rect((frame.cols - frame_size.width)/2, 0, frame_size.width, frame_size.height));
+    cv::flip(frame, frame, 1);
+}
+
+SampleManifest::Record FramePipeline::sampleRecord(const HandDetector *hand_detector, const cv::Rect &roi)
+{
+    SampleManifest::Record record;
+    record.roi = roi;
+    record.skin_color_ycrcb = hand_detector->skin_color_ycrcb;
+    record.skin_color_lower_bound = record.skin_color_ycrcb ? hand_detector->skin_color_ycrcb_lower_bound
+                                                            : hand_detector->skin_color_lower_bound;
+    record.skin_color_upper_bound = record.skin_color_ycrcb ? hand_detector->skin_color_ycrcb_upper_bound
+                                                            : hand_detector->skin_color_upper_bound;
+    record.background_subtraction = hand_detector->background_subtraction;
+    record.morphology = hand_detector->morphology;
+    record.skin_color_calibration = hand_detector->skin_color_calibration;
+    record.hand_bound = hand_detector->result.hand_bound;
+    record.hand_center = hand_detector->result.hand_center;
+    record.palm_radius = hand_detector->result.palm_radius;
+    record.finger_count = static_cast<int>(hand_detector->result.fingers.size());
+    record.contour_area = hand_detector->result.contour_area;
+    return record;
+}
+
+void FramePipeline::_open(int device, int fps, int width, int height)
+{
+    if (_camera == nullptr)
+        _camera = new cv::VideoCapture;
+    if (!_camera->isOpened())
+    {
+        _camera->open(device);
+        if (!_camera->isOpened())
+        {
+            emit cameraFailed();
+            return;
+        }
+    }
+    if (_timer == nullptr)
+    {
+        _timer = new QTimer(this);
+        _timer->setTimerType(Qt::PreciseTimer);
+        connect(_timer, SIGNAL(timeout()), this, SLOT(_process()));
+    }
+    _frame_size = cv::Size(width, height);
+    _clock.start();
+    _last_detection = -1000;
+    _last_capture = 0;
+    _frame_id = 0;
+    _capture_interval = 1000/std::max(1, fps);
+    _motion_gate.reset();
+    _tracker.reset();
+    _burst.clear();
+    _burst_stability.reset();
+    {
+        QMutexLocker lock(&_mutex);
+        _counters = Counters();
+    }
+    _timer->start(_capture_interval);
+    emit cameraOpened();
+}
+
+void FramePipeline::_release()
+{
+    if (_timer != nullptr)
+        _timer->stop();
+    _sampling = false;
+    _recorder->close();
+    _landmarks->close();
+    // FIXME exception caused by opencv when releasing the camera
+    //    if (_camera != nullptr && _camera->isOpened())
+    //        _camera->release();
+}
+
+void FramePipeline::_startSampling(int amount, int stable_frames, QString recording_path, QString label, QString landmark_path)
+{
+    _sampling = amount > 0;
+    _sampling_amount = amount;
+    _samples_collected = 0;
+    _stability.setFrames(stable_frames);
+    _stability.reset();
+    _clip.setLength(_clip_length.load());
+    _clip.clear();
+    _recorder->close();
+    _landmarks->close();
+    // the frames kept in the burst buffer are stills
+    if (_sampling && _clip.length() == 0)
+        _commitBurst();
+    // the frames kept in the burst buffer are not recorded
+    if (_sampling && !recording_path.isEmpty() &&
+            !_recorder->open(recording_path, _frame_size, 1000.0/_capture_interval, label))
+        emit recordingFailed();
+    if (_sampling && !landmark_path.isEmpty() && !_landmarks->open(landmark_path))
+        emit recordingFailed();
+}
+
+void FramePipeline::_stopSampling()
+{
+    _sampling = false;
+    _recorder->close();
+    _landmarks->close();
+}
+
+void FramePipeline::_process()
+{
+    // frames keep being grabbed but not decoded while frozen, so that the camera buffers no stale frame
+    const bool frozen = _frozen.load() != 0 && !_sampling && !_frozen_frame.empty();
+    cv::Mat frame;
+    if (_camera == nullptr || !_camera->isOpened() ||
+            (frozen ? !_camera->grab() : !_camera->read(frame) || frame.empty()))
+    {
+        _release();
+        emit cameraFailed();
+        return;
+    }
+
+    const qint64 timestamp = QDateTime::currentMSecsSinceEpoch();
+    ++_frame_id;
+    const bool count = _counters_enabled.load() != 0;
+    qint64 dropped = 0;
+    if (count)
+    {
+        // ticks of the timer are skipped while the previous frame is being processed
+        const qint64 now = _clock.elapsed();
+        if (_last_capture > 0 && now - _last_capture > _capture_interval*3/2)
+            dropped = (now - _last_capture)/_capture_interval - 1;
+        _last_capture = now;
+    }
+    else
+        _last_capture = 0;
+    if (frozen)
+        frame = _frozen_frame;
+    else
+    {
+        fitFrame(frame, _frame_size);
+        // the first frame after freezing is kept
+        if (_frozen.load() != 0 && !_sampling)
+            _frozen_frame = frame;
+        else
+            _frozen_frame.release();
+        _frozen_roi = cv::Rect();
+    }
+
+    cv::Rect roi;
+    {
+        QMutexLocker lock(&_mutex);
+        roi = _roi & cv::Rect(0, 0, frame.cols, frame.rows);
+    }
+
+    const bool monitor = _monitor_enabled.load() != 0;
+    const bool sample_due = _sampling && !_sample_collector->deny();
+    // the buffer is reallocated only if the burst or the capturing rate changed
+    _burst.setCapacity(_burst_seconds.load()*1000/_capture_interval);
+    _burst_stability.setFrames(_burst_stable_frames.load());
+    const bool burst = !_sampling && !frozen && roi.area() > 0 && _burst.capacity() > 0;
+    if (!burst)
+        _burst_stability.reset();
+    // the landmarks of every frame are streamed while sampling
+    const bool streaming = _sampling && _landmarks->isOpen();
+    const bool forced = sample_due || burst || streaming ||
+            _hand_detector->waitting_bg || _hand_detector->waitting_calibration;
+    // the hand should stay still on consecutive frames detected for sampling
+    if (!sample_due)
+        _stability.reset();
+    const qint64 now = _clock.elapsed();
+    qint64 detection_time = -1;
+    const bool due = roi.area() > 0 && (forced || (monitor && now - _last_detection >= _detection_interval.load()));
+    bool gated = false;
+    bool tracked = false;
+    const int samples_collected = _samples_collected;
+    if (due)
+    {
+        _last_detection = now;
+        // the result and the monitor images of the last detection are kept if the scene and the parameters did not change,
+        // while the gate is bypassed for a sample, which is taken on its own frame, and for a frozen frame
+        if (forced || frozen)
+            _motion_gate.reset();
+        else
+            gated = !_motion_gate.changed(frame(roi)) && !_hand_detector->outdated();
+    }
+    if (due && !gated)
+    {
+        QElapsedTimer timer;
+        if (count)
+            timer.start();
+        // a hand tracked reliably from the last detection is not detected again, unless the parameters changed
+        const bool tracking = !forced && !frozen && _tracking_enabled.load() != 0;
+        if (tracking && !_hand_detector->outdated())
+            tracked = _tracker.track(frame(roi));
+        bool detected = tracked;
+        if (!tracked)
+        {
+            // the detector redoes only the steps affected by the changed parameters if given the same frozen frame
+            detected = frozen && roi == _frozen_roi ? _hand_detector->redetect() : _hand_detector->detect(frame(roi));
+            if (frozen)
+                _frozen_roi = roi;
+            if (tracking)
+                _tracker.lock(frame(roi), _hand_detector->result);
+            else
+                _tracker.reset();
+        }
+        if (count)
+            detection_time = timer.nsecsElapsed();
+        if (sample_due && _clip.length() > 0)
+            _sampleClip(detected, roi, timestamp);
+        else if (sample_due)
+            _sample(detected, roi);
+        else if (burst)
+            _record(detected, roi, timestamp);
+        if (streaming)
+            _landmarks->append(_frame_id, timestamp, _hand_detector->result, roi.tl());
+        // the detector and the tracker reuse their buffers for the next frame
+        std::vector<cv::Mat> images;
+        if (monitor && tracked)
+        {
+            images.push_back(frame(roi).clone());
+            images.push_back(_tracker.filtered_img.clone());
+            images.push_back(_tracker.extracted_img.clone());
+        }
+        else if (monitor)
+        {
+            images.push_back(_hand_detector->interesting_img.clone());
+            images.push_back(_hand_detector->filtered_img.clone());
+            if (!_hand_detector->extracted_img.empty())
+                images.push_back(_hand_detector->extracted_img.clone());
+        }
+        QMutexLocker lock(&_mutex);
+        _result = tracked ? _tracker.result : _hand_detector->result;
+        if (monitor)
+        {
+            _monitor_images.swap(images);
+            _monitor_updated = true;
+        }
+    }
+    else if (!monitor && !_sampling)
+    {
+        // no detection is going on, so that the last one gets out of date
+        _motion_gate.reset();
+        _tracker.reset();
+        QMutexLocker lock(&_mutex);
+        _result.detected = false;
+    }
+
+    if (_recorder->isOpen())
+    {
+        // a captured frame is never modified, so that the recorder shares it
+        _recorder->record(frame, timestamp, roi, _samples_collected > samples_collected);
+        if (!_sampling)
+            _recorder->close();
+    }
+    if (!_sampling)
+        _landmarks->close();
+
+    QMutexLocker lock(&_mutex);
+    _preview_frame = frame;
+    _preview_roi = roi;
+    _preview_updated = true;
+    if (count)
+    {
+        ++_counters.frames;
+        _counters.dropped += dropped;
+        if (gated)
+            ++_counters.gated;
+        if (tracked)
+            ++_counters.tracked;
+        if (detection_time >= 0)
+        {
+            ++_counters.detections;
+            _counters.detection_time += detection_time;
+        }
+    }
+}
+
+void FramePipeline::_record(const bool &detected, const cv::Rect &roi, const qint64 &timestamp)
+{
+    const bool still = _burst_stability.update(_hand_detector->filtered_img, _hand_detector->result);
+    if (!detected)
+        return;
+    SampleManifest::Record record = sampleRecord(_hand_detector, roi);
+    record.timestamp = timestamp;
+    _burst.push(_hand_detector->interesting_img, _hand_detector->extracted_img, record, still);
+}
+
+void FramePipeline::_commitBurst()
+{
+    std::vector<SampleCollector::Sample> samples;
+    _burst.take(samples, true, _sampling_amount);
+    if (samples.empty())
+        return;
+
+    if (!_sample_collector->sample(samples))
+    {
+        _sampling = false;
+        emit sampleFailed();
+        return;
+    }
+
+    _samples_collected = static_cast<int>(samples.size()) - _sample_collector->skipped();
+    if (_samples_collected == 0)
+        return;
+    emit sampleCollected(_samples_collected);
+    if (_samples_collected >= _sampling_amount)
+    {
+        _sampling = false;
+        emit samplingFinished();
+    }
+}
+
+void FramePipeline::_sampleClip(const bool &detected, const cv::Rect &roi, const qint64 &timestamp)
+{
+    // a clip is made of consecutive frames with a hand
+    if (!detected)
+    {
+        _clip.clear();
+        emit sampleMissed();
+        return;
+    }
+    if (!_clip.push(_hand_detector->extracted_img, _hand_detector->result.hand_bound, roi, timestamp))
+        return;
+
+    if (!_sample_collector->sampleClip(_clip.masks(), _clip.timestamps(), _clip.offset()))
+    {
+        _sampling = false;
+        emit sampleFailed();
+        return;
+    }
+
+    emit sampleCollected(++_samples_collected);
+    if (_samples_collected >= _sampling_amount)
+    {
+        _sampling = false;
+        emit samplingFinished();
+    }
+}
+
+void FramePipeline::_sample(const bool &detected, const cv::Rect &roi)
+{
+    const bool still = _stability.update(_hand_detector->filtered_img, _hand_detector->result);
+    if (!detected)
+    {
+        emit sampleMissed();
+        return;
+    }
+    if (!still)
+        return;
+
+    if (!_sample_collector->sample(_hand_detector->interesting_img, _hand_detector->extracted_img,
+                                   sampleRecord(_hand_detector, roi)))
+    {
+        _sampling = false;
+        emit sampleFailed();
+        return;
+    }
+    if (_sample_collector->skipped() > 0)
+    {
+        emit sampleSkipped();
+        return;
+    }
+
+    emit sampleCollected(++_samples_collected);
+    if (_samples_collected >= _sampling_amount)
+    {
+        _sampling = false;
+        emit samplingFinished();
+    }
+}
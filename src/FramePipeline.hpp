@@ -0,0 +1,336 @@
+#ifndef FRAMEPIPELINE_H
+#define FRAMEPIPELINE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The FramePipeline.hpp file contains the class capturing, detecting and sampling frames in a worker thread.
+ */
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QElapsedTimer>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "config.h"
+#include "HandDetector.hpp"
+#include "SampleCollector.hpp"
+#include "MotionGate.hpp"
+#include "HandTracker.hpp"
+#include "StabilityTrigger.hpp"
+#include "BurstBuffer.hpp"
+#include "ClipBuffer.hpp"
+#include "SessionRecorder.hpp"
+#include "LandmarkStream.hpp"
+
+/**
+ * @brief The FramePipeline class captures frames from the camera, detects hands and takes samples in its own thread.
+ *
+ * Frames are captured at the camera rate. Hands are detected at #Settings::detection_fps while the monitor window
+ * is shown, and on every frame when a sample is due or the background image is being set.
+ * A sample is due once #SampleCollector::deny allows, and is taken as soon as the hand has stayed still on
+ * a number of consecutive frames according to a #StabilityTrigger .
+ * If a clip length is set, a sample is instead a clip of the hand masks on that number of consecutive frames,
+ * assembled by a #ClipBuffer on masks of the whole region of interesting, so that the hand can move freely, and restarted
+ * whenever no hand is detected or the region of interesting moves.
+ * If a burst is set, hands are detected on every frame while not sampling, and the latest frames with a still hand
+ * are kept in a #BurstBuffer . They are stored in one batch as the first samples once sampling starts, so that the
+ * frames captured while the operator confirms the start are not lost.
+ * While sampling, the captured frames can be recorded into a lossless video by a #SessionRecorder , and the hand
+ * landmarks of every frame can be streamed into a binary file by a #LandmarkStream .
+ * A detection for the monitor window is skipped, and the last result is kept, if the region of interesting
+ * has not changed since the last detection according to a #MotionGate , and no parameter of the detector was changed.
+ * If tracking is enabled, a hand detected for the monitor window is followed over the next frames by a #HandTracker
+ * instead of being detected again, until it is lost or #TRACKING_INTERVAL frames have passed.
+ * The results are handed off to the GUI thread through two slots, one for the preview video and one for the monitor
+ * images. Each slot holds only the latest frame, which replaces the one not yet taken, so that the GUI can take frames
+ * at its own refresh rate and a slow repaint never delays capturing, detection or sampling.
+ *
+ * The given #HandDetector is moved into the worker thread, so that its slots are called between two frames.
+ * Its parameters, in #DetectorParams , can be set from the GUI thread directly and are picked up at the next frame.
+ * The given #SampleCollector stays in the thread owning it. Its sessions should be begun and ended only while this
+ * pipeline is not sampling.
+ *
+ * Unless stated otherwise, the public functions of this class should be called from the thread owning it.
+ */
+class FramePipeline : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The Counters struct holds the performance counters of the pipeline since the camera was opened.
+     *
+     * @see #FramePipeline::setCountersEnabled
+     */
+    struct Counters
+    {
+        /**
+         * @brief frames is the number of frames captured.
+         */
+        qint64 frames = 0;
+        /**
+         * @brief dropped is the number of frames not captured since the pipeline was busy when they were due.
+         */
+        qint64 dropped = 0;
+        /**
+         * @brief detections is the number of detections performed.
+         */
+        qint64 detections = 0;
+        /**
+         * @brief detection_time is the total time spent on detection in nanoseconds.
+         */
+        qint64 detection_time = 0;
+        /**
+         * @brief gated is the number of detections skipped since the scene did not change, see #MotionGate .
+         */
+        qint64 gated = 0;
+        /**
+         * @brief tracked is the number of detections replaced by tracking, see #HandTracker .
+         */
+        qint64 tracked = 0;
+    };
+
+    /**
+     * @brief FramePipeline is the constructor. The worker thread is started immediately.
+     * @param hand_detector : the hand detector, who will be moved into the worker thread
+     * @param sample_collector : the sample collector
+     */
+    FramePipeline(HandDetector *hand_detector, SampleCollector *sample_collector);
+    /**
+     * @brief ~FramePipeline releases the camera and stops the worker thread.
+     */
+    ~FramePipeline();
+
+    /**
+     * @brief openCamera opens a camera and starts capturing.
+     *
+     * Either #FramePipeline::cameraOpened or #FramePipeline::cameraFailed is emitted afterwards.
+     *
+     * @param device : index of the camera
+     * @param fps : capturing rate
+     * @param frame_size : size to which captured frames are resized and cropped
+     */
+    void openCamera(const int &device, const int &fps, const cv::Size &frame_size);
+    /**
+     * @brief releaseCamera stops capturing. It blocks until the worker thread stops capturing.
+     */
+    void releaseCamera();
+    /**
+     * @brief startSampling starts taking samples until the given amount of samples are collected.
+     *
+     * #FramePipeline::sampleCollected is emitted after each sample, and #FramePipeline::samplingFinished after the last one.
+     *
+     * @param amount : the amount of samples
+     * @param stable_frames : the number of consecutive frames on which the hand should stay still before a sample is taken,
+     *                        or 0 to take a sample on any frame with a hand detected
+     * @param recording_path : path of the video into which the frames are recorded until sampling stops,
+     *                         or empty to record nothing. #FramePipeline::recordingFailed is emitted if failed.
+     * @param label : the label of the samples, written beside the recorded frames
+     * @param landmark_path : path of the file into which the hand landmarks of every frame are streamed until sampling
+     *                        stops, or empty to stream nothing. Hands are detected on every frame then.
+     *                        #FramePipeline::recordingFailed is emitted if failed.
+     */
+    void startSampling(const int &amount, const int &stable_frames = 0,
+                       const QString &recording_path = QString(), const QString &label = QString(),
+                       const QString &landmark_path = QString());
+    /**
+     * @brief stopSampling stops taking samples. It blocks until the worker thread stops sampling.
+     */
+    void stopSampling();
+    /**
+     * @brief setRoi sets the region of interesting on the frames. It is thread-safe.
+     */
+    void setRoi(const cv::Rect &roi);
+    /**
+     * @brief setDetectionFps sets the rate of detecting hands while not sampling. It is thread-safe.
+     */
+    void setDetectionFps(const int &fps);
+    /**
+     * @brief setMonitorEnabled sets if the monitor images are needed. It is thread-safe.
+     *
+     * No detection is performed for the monitor, nor monitor images are handed off, if disabled.
+     */
+    void setMonitorEnabled(const bool &enable);
+    /**
+     * @brief setCountersEnabled sets if the performance counters are updated. It is thread-safe.
+     *
+     * Nothing is counted or timed if disabled, which is the default.
+     */
+    void setCountersEnabled(const bool &enable);
+    /**
+     * @brief setFrozen freezes the video on the current frame or not. It is thread-safe.
+     *
+     * While frozen, the same frame is previewed and detected again and again, so that the parameters of the detector
+     * can be tuned on it. Only the steps of detection affected by the changed parameters are performed again,
+     * see #HandDetector::redetect . Frames are captured as usual while sampling.
+     */
+    void setFrozen(const bool &freeze);
+    /**
+     * @brief setTrackingEnabled sets if a detected hand is tracked over the next frames for the monitor window.
+     *        It is thread-safe.
+     *
+     * Samples are always taken from full detections.
+     */
+    void setTrackingEnabled(const bool &enable);
+    /**
+     * @brief setBurst sets the length of the frames kept before sampling starts. It is thread-safe.
+     * @param seconds : the length in seconds, or 0 to keep no frame, which is the default
+     * @param stable_frames : the number of consecutive frames on which the hand should stay still to keep a frame
+     */
+    void setBurst(const int &seconds, const int &stable_frames);
+    /**
+     * @brief setClipLength sets the number of consecutive frames stored as one clip per sample. It is thread-safe.
+     *
+     * It is taken when sampling starts. No frame kept before sampling starts is stored in clip mode.
+     *
+     * @param frames : the number of frames, or 0 to take stills, which is the default
+     *
+     * @see #SampleCollector::sampleClip
+     */
+    void setClipLength(const int &frames);
+    /**
+     * @brief counters returns the performance counters. It is thread-safe.
+     */
+    Counters counters();
+    /**
+     * @brief takePreviewFrame takes the latest captured frame. It is thread-safe.
+     *
+     * Nothing is drawn on the frame. The region of interesting and the hand geometry are given separately
+     * to be drawn as overlays.
+     *
+     * @param frame : the frame
+     * @param roi : the region of interesting on the frame
+     * @param result : the hand geometry of the latest detection, relative to the region of interesting
+     * @retval true : a new frame is taken
+     * @retval false : no frame was captured since last time
+     */
+    bool takePreviewFrame(cv::Mat &frame, cv::Rect &roi, DetectionResult &result);
+    /**
+     * @brief takeMonitorImages takes the intermediate images of the latest detection. It is thread-safe.
+     * @param images : #HandDetector::interesting_img , #HandDetector::filtered_img
+     *                 and, if a hand was detected, #HandDetector::extracted_img
+     * @param result : the hand geometry, relative to the region of interesting
+     * @retval true : new images are taken
+     * @retval false : no detection was performed since last time
+     */
+    bool takeMonitorImages(std::vector<cv::Mat> &images, DetectionResult &result);
+
+    /**
+     * @brief fitFrame resizes a captured frame to the height of the given size keeping its aspect ratio,
+     *        crops its center to the width of the given size, and mirrors it horizontally.
+     * @param frame : the captured frame, which is replaced by the result
+     * @param frame_size : the size of the result
+     */
+    static void fitFrame(cv::Mat &frame, const cv::Size &frame_size);
+    /**
+     * @brief sampleRecord returns the manifest record of the last detection performed by the given detector.
+     * @param hand_detector : the detector
+     * @param roi : the region of interesting given to the detector
+     * @return the record without the sample id and the timestamp, which are filled by #SampleCollector::sample
+     */
+    static SampleManifest::Record sampleRecord(const HandDetector *hand_detector, const cv::Rect &roi);
+
+signals:
+    /**
+     * @brief cameraOpened is emitted when the camera starts capturing.
+     */
+    void cameraOpened();
+    /**
+     * @brief cameraFailed is emitted when the camera failed to open or to capture a frame. Capturing stops then.
+     */
+    void cameraFailed();
+    /**
+     * @brief sampleCollected is emitted after a sample is taken.
+     * @param count : the number of samples collected since #FramePipeline::startSampling
+     */
+    void sampleCollected(const int &count);
+    /**
+     * @brief sampleMissed is emitted when a sample is due but no hand is detected.
+     */
+    void sampleMissed();
+    /**
+     * @brief sampleSkipped is emitted when a sample is not stored since it is nearly identical to a recent one.
+     *
+     * @see #SampleCollector::skipped
+     */
+    void sampleSkipped();
+    /**
+     * @brief sampleFailed is emitted when a sample failed to be stored. Sampling stops then.
+     */
+    void sampleFailed();
+    /**
+     * @brief samplingFinished is emitted after the amount of samples given to #FramePipeline::startSampling are collected.
+     */
+    void samplingFinished();
+    /**
+     * @brief recordingFailed is emitted when the recording or the landmark stream of a sampling session failed
+     *        to be opened or written. Sampling goes on.
+     */
+    void recordingFailed();
+
+private slots:
+    void _open(int device, int fps, int width, int height);
+    void _release();
+    void _startSampling(int amount, int stable_frames, QString recording_path, QString label, QString landmark_path);
+    void _stopSampling();
+    void _process();
+
+private:
+    FramePipeline(const FramePipeline &) = delete;
+    FramePipeline &operator=(const FramePipeline &) = delete;
+
+    void _sample(const bool &detected, const cv::Rect &roi);
+    void _sampleClip(const bool &detected, const cv::Rect &roi, const qint64 &timestamp);
+    void _record(const bool &detected, const cv::Rect &roi, const qint64 &timestamp);
+    void _commitBurst();
+
+    QThread _thread;
+    HandDetector *_hand_detector;
+    SampleCollector *_sample_collector;
+    SessionRecorder *_recorder;
+    LandmarkStream *_landmarks;
+    // owned by the worker thread
+    cv::VideoCapture *_camera;
+    QTimer *_timer;
+    cv::Size _frame_size;
+    QElapsedTimer _clock;
+    qint64 _last_detection;
+    qint64 _last_capture;
+    quint32 _frame_id;
+    int _capture_interval;
+    bool _sampling;
+    int _sampling_amount;
+    int _samples_collected;
+    cv::Mat _frozen_frame;
+    cv::Rect _frozen_roi;
+    MotionGate _motion_gate;
+    HandTracker _tracker;
+    StabilityTrigger _stability;
+    BurstBuffer _burst;
+    StabilityTrigger _burst_stability;
+    ClipBuffer _clip;
+    // shared with the other threads
+    QAtomicInt _detection_interval;
+    QAtomicInt _monitor_enabled;
+    QAtomicInt _counters_enabled;
+    QAtomicInt _frozen;
+    QAtomicInt _tracking_enabled;
+    QAtomicInt _burst_seconds;
+    QAtomicInt _burst_stable_frames;
+    QAtomicInt _clip_length;
+    QMutex _mutex;
+    cv::Rect _roi;
+    cv::Mat _preview_frame;
+    cv::Rect _preview_roi;
+    bool _preview_updated;
+    DetectionResult _result;
+    Counters _counters;
+    std::vector<cv::Mat> _monitor_images;
+    bool _monitor_updated;
+};
+
+#endif // FRAMEPIPELINE_H
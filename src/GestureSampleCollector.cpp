@@ -13,10 +13,14 @@ GestureSampleCollector::GestureSampleCollector(HandDetector *hand_detector,
     _settings(Settings::getInstance()),
     _work_status(STATUS_IDLE),
     _camera_fps(CAMERA_FPS),
-    _camera(new cv::VideoCapture),
-    _camera_capture_timer(new QTimer),
     _hand_detector(hand_detector),
-    _sample_collector(sample_collector)
+    _sample_collector(sample_collector),
+    _pipeline(new FramePipeline(hand_detector, sample_collector)),
+    _preview_timer(new QTimer),
+    _monitor_timer(new QTimer),
+    _hud_timer(new QTimer),
+    _hud_enabled(false),
+    _hud_bytes(0)
 {
     connect(main_view, SIGNAL(mainViewClosing()), this, SLOT(windowClosing()));
     connect(main_view, SIGNAL(cameraRequest()), this, SLOT(openCamera()));
@@ -26,17 +30,40 @@ GestureSampleCollector::GestureSampleCollector(HandDetector *hand_detector,
     connect(main_view, SIGNAL(settingsWindowRequest()), this, SLOT(openSettingsWindow()));
     connect(main_view, SIGNAL(settingsWindowGestureTabRequest()), this, SLOT(openSettingsWindowGestureTab()));
 
-    connect(settings_view, SIGNAL(changeSkinColorLowerBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterLowerBound(int,int,int)));
-    connect(settings_view, SIGNAL(changeSkinColorUpperBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterUpperBound(int,int,int)));
-    connect(settings_view, SIGNAL(changeDetectionArea(int)), _hand_detector, SLOT(setDetectionArea(int)));
-    connect(settings_view, SIGNAL(changeMorphology(bool)), _hand_detector, SLOT(setMorphology(bool)));
+    // the parameters are published to the detector in the worker thread without queuing an event per slider tick
+    connect(settings_view, SIGNAL(changeSkinColorLowerBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterLowerBound(int,int,int)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeSkinColorUpperBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterUpperBound(int,int,int)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeSkinColorYCrCb(bool)), _hand_detector, SLOT(setSkinColorFilterYCrCb(bool)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeSkinColorYCrCbLowerBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterYCrCbLowerBound(int,int,int)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeSkinColorYCrCbUpperBound(int,int,int)), _hand_detector, SLOT(setSkinColorFilterYCrCbUpperBound(int,int,int)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeDetectionArea(int)), _hand_detector, SLOT(setDetectionArea(int)), Qt::DirectConnection);
+    connect(settings_view, SIGNAL(changeMorphology(bool)), _hand_detector, SLOT(setMorphology(bool)), Qt::DirectConnection);
     connect(settings_view, SIGNAL(backgroundSettingRequest()), _hand_detector, SLOT(setBackgroundImage()));
     connect(settings_view, SIGNAL(backgroundClearingRequest()), _hand_detector, SLOT(clearBackgroundImage()));
+    connect(settings_view, SIGNAL(skinColorCalibrationRequest()), _hand_detector, SLOT(calibrateSkinColor()));
+    connect(settings_view, SIGNAL(skinColorCalibrationClearingRequest()), _hand_detector, SLOT(clearSkinColorCalibration()));
     connect(settings_view, SIGNAL(changeRoiRange(int,int,int,int)), this, SLOT(verifyRoiRange(int,int,int,int)));
     connect(settings_view, SIGNAL(changeLabelList()), main_view, SLOT(reloadLabelList()));
+    connect(settings_view, SIGNAL(changeRefreshRates(int,int,int)), this, SLOT(setRefreshRates(int,int,int)));
+    connect(settings_view, SIGNAL(changeHud(bool)), this, SLOT(setHudEnabled(bool)));
+    connect(settings_view, SIGNAL(changeTracking(bool)), this, SLOT(setTrackingEnabled(bool)));
+    connect(settings_view, SIGNAL(freezeFrameRequest(bool)), this, SLOT(setFrameFrozen(bool)));
 
-    connect(_hand_detector, SIGNAL(backgroundImageSet()), this, SLOT(updateBackgroundImage()));
+    connect(_sample_collector, SIGNAL(storageFailed(QString)), this, SLOT(_handleStorageError()));
+
+    connect(_pipeline, SIGNAL(cameraOpened()), this, SLOT(_cameraOpened()));
+    connect(_pipeline, SIGNAL(cameraFailed()), this, SLOT(_cameraFailed()));
+    connect(_pipeline, SIGNAL(sampleCollected(int)), this, SLOT(_sampleCollected(int)));
+    connect(_pipeline, SIGNAL(sampleMissed()), this, SLOT(_sampleMissed()));
+    connect(_pipeline, SIGNAL(sampleSkipped()), this, SLOT(_sampleSkipped()));
+    connect(_pipeline, SIGNAL(sampleFailed()), this, SLOT(_sampleFailed()));
+    connect(_pipeline, SIGNAL(samplingFinished()), this, SLOT(_samplingFinished()));
+    connect(_pipeline, SIGNAL(recordingFailed()), this, SLOT(_recordingFailed()));
+
+    connect(_hand_detector, SIGNAL(backgroundImageSet(QImage)), this, SLOT(updateBackgroundImage(QImage)));
     connect(_hand_detector, SIGNAL(backgroundImageCleared()), settings_view, SLOT(clearBackgroundImage()));
+    connect(_hand_detector, SIGNAL(skinColorCalibrated()), this, SLOT(_skinColorCalibrated()));
+    connect(_hand_detector, SIGNAL(skinColorCalibrationCleared()), this, SLOT(_skinColorCalibrationCleared()));
 
     connect(this, SIGNAL(cameraOpened()), main_view, SLOT(cameraStarted()));
     connect(this, SIGNAL(cameraOpened()), settings_view, SLOT(enableBackgroundSetting()));
@@ -46,16 +73,26 @@ GestureSampleCollector::GestureSampleCollector(HandDetector *hand_detector,
     connect(this, SIGNAL(samplingTaskStarted()), main_view, SLOT(samplingTaskStarted()));
     connect(this, SIGNAL(samplingTaskStopped()), main_view, SLOT(samplingTaskStopped()));
     connect(this, SIGNAL(samplingTaskStopped()), this, SLOT(_changeWorkStatusToNothing()));
-    
-    connect(_camera_capture_timer, SIGNAL(timeout()), this, SLOT(captureFrame()));
 
+    connect(_preview_timer, SIGNAL(timeout()), this, SLOT(_refreshPreview()));
+    connect(_monitor_timer, SIGNAL(timeout()), this, SLOT(_refreshMonitor()));
+    connect(_hud_timer, SIGNAL(timeout()), this, SLOT(_refreshHud()));
+
+    setRefreshRates(_settings->preview_fps, _settings->monitor_fps, _settings->detection_fps);
+    _hud_timer->setInterval(HUD_REFRESH_INTERVAL);
+    setHudEnabled(_settings->show_hud);
+    setTrackingEnabled(_settings->hand_tracking);
+    _pipeline->setBurst(_settings->burst_seconds, _settings->sampling_stable_frames);
     settings_view->setToCurrentSettings();
 }
 
 GestureSampleCollector::~GestureSampleCollector()
 {
-    delete _camera_capture_timer;
-    delete _camera;
+    delete _preview_timer;
+    delete _monitor_timer;
+    delete _hud_timer;
+    // stop the worker thread before deleting the detector and the collector it uses
+    delete _pipeline;
     delete _hand_detector;
     delete _sample_collector;
 }
@@ -83,6 +120,42 @@ void GestureSampleCollector::openMonitorWindow()
 {
     monitor_view->show();
     monitor_view->raise();
+    _pipeline->setMonitorEnabled(true);
+}
+
+void GestureSampleCollector::setRefreshRates(const int &preview_fps, const int &monitor_fps, const int &detection_fps)
+{
+    _preview_timer->setInterval(1000/qBound(1, preview_fps, CAMERA_FPS));
+    _monitor_timer->setInterval(1000/qBound(1, monitor_fps, CAMERA_FPS));
+    _pipeline->setDetectionFps(qBound(1, detection_fps, CAMERA_FPS));
+}
+
+void GestureSampleCollector::setTrackingEnabled(const bool &enable)
+{
+    _pipeline->setTrackingEnabled(enable);
+}
+
+void GestureSampleCollector::setHudEnabled(const bool &enable)
+{
+    _hud_enabled = enable;
+    _pipeline->setCountersEnabled(enable);
+    if (!enable)
+    {
+        _hud_timer->stop();
+        main_view->updateHud(QString());
+    }
+    else if (_preview_timer->isActive() && !_hud_timer->isActive())
+    {
+        _hud_counters = _pipeline->counters();
+        _hud_bytes = _sample_collector->bytesStored();
+        _hud_clock.start();
+        _hud_timer->start();
+    }
+}
+
+void GestureSampleCollector::setFrameFrozen(const bool &freeze)
+{
+    _pipeline->setFrozen(freeze);
 }
 
 void GestureSampleCollector::verifyRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y)
@@ -91,6 +164,7 @@ void GestureSampleCollector::verifyRoiRange(const int &start_x, const int &end_x
     _roi.y = 9;
     _roi.width = 320;
     _roi.height = 320;
+    _pipeline->setRoi(_roi);
     // _roi.x = main_view->getVideoFrameWidth() * start_x/100;
     // _roi.y = main_view->getVideoFrameHeight() * start_y/100;
     // _roi.width = main_view->getVideoFrameWidth() * (end_x-start_x)/100;
@@ -110,69 +184,32 @@ void GestureSampleCollector::verifyRoiRange(const int &start_x, const int &end_x
     // }
 }
 
-void GestureSampleCollector::updateBackgroundImage()
+void GestureSampleCollector::updateBackgroundImage(const QImage &img)
 {
-    settings_view->setBackgroundImage(
-                CvQtImgConvertor::cvMat2QPixmap(
-                    this->_hand_detector->background_img
-                    )
-                );
+    // the image is a copy sent by the detector, whose own buffers belong to the thread of the pipeline
+    settings_view->setBackgroundImage(QPixmap::fromImage(img));
 }
 
 void GestureSampleCollector::openCamera()
 {
-    if (_camera->isOpened())
-    {
-        _camera->open(0);
-        if (!_camera->isOpened())
-        {
-            _handleCameraError();
-            return;
-        }
-    }
-    emit cameraOpened();
-    _camera_capture_timer->start(1000/_camera_fps);
+    _pipeline->openCamera(0, _camera_fps,
+                          cv::Size(main_view->getVideoFrameWidth(), main_view->getVideoFrameHeight()));
 }
 
 void GestureSampleCollector::releaseCamera()
 {
-    _camera_capture_timer->stop();
-    // FIXME exception caused by opencv when releasing the camera
-    //    if (_camera->isOpened())
-    //        _camera->release();
-}
-
-void GestureSampleCollector::captureFrame()
-{
-    if (_camera->isOpened())
-    {
-        cv::Mat captured_frame;
-        _camera->read(captured_frame);
-        if (!captured_frame.empty())
-        {
-            // resize and keep aspect ratio
-            cv::resize(captured_frame, captured_frame,
-                       cv::Size(captured_frame.cols*main_view->getVideoFrameHeight()/captured_frame.rows,
-                                main_view->getVideoFrameHeight()));
-            captured_frame(
-                        cv::Rect(
-                            (captured_frame.cols - main_view->getVideoFrameWidth())/2, 0,
-                            main_view->getVideoFrameWidth(), main_view->getVideoFrameHeight()
-                            )
-                        ).copyTo(captured_frame);
-            cv::flip(captured_frame, captured_frame, 1);
-            _processCapturedFrame(captured_frame);
-            return;
-        }
-    }
-    _handleCameraError();
+    _preview_timer->stop();
+    _monitor_timer->stop();
+    _hud_timer->stop();
+    main_view->updateHud(QString());
+    _pipeline->releaseCamera();
 }
 
 void GestureSampleCollector::startSamplingTask(const int &label_index, const QString &folder_path)
 {
     if (_work_status == STATUS_SAMPLING)
         return;
-    if (!_camera->isOpened())
+    if (!_preview_timer->isActive())
     {
         _handleCameraError();
         return;
@@ -203,8 +240,16 @@ void GestureSampleCollector::startSamplingTask(const int &label_index, const QSt
             _samples_collected = 0;
             _settings->setSampleStoragePath(folder_path);
             _settings->setSelectedGesture(label_index);
+            _sample_collector->beginSession();
             emit samplingTaskStarted();
             _work_status = STATUS_SAMPLING;
+            const QString session = QDir(_sample_collector->storage_path).filePath(
+                        QString("session-%1").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss")));
+            _pipeline->setClipLength(_settings->sampling_clip_length);
+            _pipeline->startSampling(_settings->sampling_amount_per_time, _settings->sampling_stable_frames,
+                                     _settings->record_sessions ? session + RECORDING_FILE_SUFFIX : QString(),
+                                     _settings->gesture_list.at(label_index),
+                                     _settings->stream_landmarks ? session + LANDMARK_STREAM_FILE_SUFFIX : QString());
         }
         else
             emit samplingTaskStopped();
@@ -231,69 +276,161 @@ void GestureSampleCollector::_changeWorkStatusToNothing()
     _work_status = STATUS_IDLE;
 }
 
+void GestureSampleCollector::_handleStorageError()
+{
+    if (_work_status != STATUS_SAMPLING)
+        return;
+    // following failures of the same batch are ignored
+    _work_status = STATUS_IDLE;
+    _handleSamplingError(SAMPLING_ERROR_STORAGE_IMAGE);
+}
+
 void GestureSampleCollector::_handleCameraError()
 {
-    _camera_capture_timer->stop();
+    _preview_timer->stop();
+    _monitor_timer->stop();
+    _hud_timer->stop();
+    main_view->updateHud(QString());
     emit cameraReleased();
     QMessageBox::critical(main_view, tr("Error"), tr("Failed to open camera."));
 }
 
-void GestureSampleCollector::_processCapturedFrame(cv::Mat &captured_frame)
+void GestureSampleCollector::_cameraOpened()
 {
-    if (monitor_view->isVisible() || _hand_detector->waitting_bg || _work_status == STATUS_SAMPLING)
-    {
-        bool detected = _hand_detector->detect(captured_frame(_roi));
-
-        if (_work_status == STATUS_SAMPLING && !_sample_collector->deny())
-        {
-            if (detected)
-                _sample(_hand_detector->interesting_img, _hand_detector->extracted_img);
-            else
-                main_view->appendText(tr("[Error] Sampling failed. Nothing detected."));
-        }
-           
+    _preview_timer->start();
+    _monitor_timer->start();
+    // the counters of the pipeline were reset when the camera was opened
+    setHudEnabled(_hud_enabled);
+    emit cameraOpened();
+}
 
-        if (monitor_view->isVisible())
-        {
-            if (_hand_detector->extracted_img.empty())
-                monitor_view->updateMonitorImage3(
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->interesting_img),
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->filtered_img),
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->convexity_img)
-                            );
-            else
-                monitor_view->updateMonitorImage4(
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->interesting_img),
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->filtered_img),
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->convexity_img),
-                            CvQtImgConvertor::cvMat2QPixmap(_hand_detector->extracted_img)
-                            );
-        }
-    }
-    
-    cv::rectangle(captured_frame, _roi, HandDetector::COLOR_GREEN, 2);
-    main_view->updateVideoFrame(CvQtImgConvertor::cvMat2QPixmap(captured_frame));
+void GestureSampleCollector::_cameraFailed()
+{
+    _handleCameraError();
+}
 
+void GestureSampleCollector::_refreshPreview()
+{
+    cv::Mat frame;
+    cv::Rect roi;
+    DetectionResult result;
+    if (!_pipeline->takePreviewFrame(frame, roi, result))
+        return;
+    main_view->updateVideoFrame(CvQtImgConvertor::cvMat2QPixmap(frame, main_view->getVideoFrameSize()));
+    main_view->updateVideoOverlay(QSize(frame.cols, frame.rows), QRect(roi.x, roi.y, roi.width, roi.height), result);
 }
 
-void GestureSampleCollector::_sample(const cv::Mat &orig_img, const cv::Mat &proc_img)
+void GestureSampleCollector::_refreshMonitor()
 {
-    if (_sample_collector->sample(orig_img, proc_img))
-    {
-        _samples_collected++;
-        main_view->updateText(QString(tr("[Info] Collected: %1 / %2")).arg(
-                                      QString::number(++_sampling_trails).rightJustified(3, ' '),
-                                      QString::number(_settings->sampling_amount_per_time))
-                                  );
-        if (_sampling_trails >= _settings->sampling_amount_per_time)
-            _samplingCompleted();
-    }
+    const bool visible = monitor_view->isVisible();
+    _pipeline->setMonitorEnabled(visible);
+
+    std::vector<cv::Mat> images;
+    DetectionResult result;
+    if (!visible || !_pipeline->takeMonitorImages(images, result) || images.size() < 2)
+        return;
+    // the hand geometry is drawn over a blank canvas instead of a painted image
+    monitor_view->updateMonitorOverlay(QSize(images[0].cols, images[0].rows), result);
+    if (images.size() == 2)
+        monitor_view->updateMonitorImage3(
+                    CvQtImgConvertor::cvMat2QPixmap(images[0], monitor_view->getMonitorImageSize(1)),
+                    CvQtImgConvertor::cvMat2QPixmap(images[1], monitor_view->getMonitorImageSize(2)),
+                    QPixmap()
+                    );
     else
-        _handleSamplingError(SAMPLING_ERROR_STORAGE_IMAGE);
+        monitor_view->updateMonitorImage4(
+                    CvQtImgConvertor::cvMat2QPixmap(images[0], monitor_view->getMonitorImageSize(1)),
+                    CvQtImgConvertor::cvMat2QPixmap(images[1], monitor_view->getMonitorImageSize(2)),
+                    QPixmap(),
+                    CvQtImgConvertor::cvMat2QPixmap(images[2], monitor_view->getMonitorImageSize(4))
+                    );
+}
+
+void GestureSampleCollector::_skinColorCalibrated()
+{
+    settings_view->setSkinColorCalibrated(true);
+    main_view->appendText(tr("[Info] Skin color calibrated."));
+}
+
+void GestureSampleCollector::_skinColorCalibrationCleared()
+{
+    settings_view->setSkinColorCalibrated(false);
+}
+
+void GestureSampleCollector::_refreshHud()
+{
+    const FramePipeline::Counters counters = _pipeline->counters();
+    const qint64 bytes = _sample_collector->bytesStored();
+    const qint64 elapsed = _hud_clock.restart();
+
+    const qint64 frames = counters.frames - _hud_counters.frames;
+    const qint64 detections = counters.detections - _hud_counters.detections;
+    const qint64 detection_time = counters.detection_time - _hud_counters.detection_time;
+    const qint64 gated = counters.gated - _hud_counters.gated;
+    const qint64 tracked = counters.tracked - _hud_counters.tracked;
+    main_view->updateHud(QString(tr("Capture   %1 fps\n"
+                                    "Detection %2 ms\n"
+                                    "Gated     %3 %\n"
+                                    "Tracked   %4 %\n"
+                                    "Dropped   %5 frames\n"
+                                    "Queue     %6 images\n"
+                                    "Disk      %7 MB/s")).arg(
+                             QString::number(elapsed > 0 ? frames*1000.0/elapsed : 0, 'f', 1),
+                             detections > 0 ? QString::number(detection_time/1e6/detections, 'f', 2) : QString("-"),
+                             detections + gated > 0 ? QString::number(gated*100.0/(detections + gated), 'f', 0) : QString("-"),
+                             detections > 0 ? QString::number(tracked*100.0/detections, 'f', 0) : QString("-"),
+                             QString::number(counters.dropped),
+                             QString::number(_sample_collector->pending()),
+                             QString::number(elapsed > 0 ? (bytes - _hud_bytes)*1000.0/elapsed/(1024*1024) : 0, 'f', 2)));
+    _hud_counters = counters;
+    _hud_bytes = bytes;
+}
+
+void GestureSampleCollector::_sampleCollected(const int &count)
+{
+    if (_work_status != STATUS_SAMPLING)
+        return;
+    _sampling_trails = count;
+    _samples_collected = count;
+    main_view->updateText(QString(tr("[Info] Collected: %1 / %2")).arg(
+                                  QString::number(_sampling_trails).rightJustified(3, ' '),
+                                  QString::number(_settings->sampling_amount_per_time))
+                              );
+}
+
+void GestureSampleCollector::_sampleMissed()
+{
+    if (_work_status == STATUS_SAMPLING)
+        main_view->appendText(tr("[Error] Sampling failed. Nothing detected."));
+}
+
+void GestureSampleCollector::_sampleSkipped()
+{
+    if (_work_status == STATUS_SAMPLING)
+        main_view->appendText(tr("[Info] Sample skipped. Nearly identical to a recent one."));
+}
+
+void GestureSampleCollector::_sampleFailed()
+{
+    _handleStorageError();
+}
+
+void GestureSampleCollector::_recordingFailed()
+{
+    if (_work_status == STATUS_SAMPLING)
+        main_view->appendText(tr("[Error] Failed to record the sampling session."));
+}
+
+void GestureSampleCollector::_samplingFinished()
+{
+    if (_work_status == STATUS_SAMPLING)
+        _samplingCompleted();
 }
 
 void GestureSampleCollector::_handleSamplingError(const SAMPLING_ERROR &e)
 {
+    _pipeline->stopSampling();
+    _sample_collector->endSession();
     QString msg;
     if (e == SAMPLING_ERROR_GESTURE_INDEX)
     {
@@ -313,6 +450,8 @@ void GestureSampleCollector::_handleSamplingError(const SAMPLING_ERROR &e)
 
 void GestureSampleCollector::_samplingCompleted()
 {
+    _pipeline->stopSampling();
+    auto stats = _sample_collector->endSession();
     emit samplingTaskStopped();
     main_view->appendText(QString(tr("[Info] Sampling Completed.\n"
                                          "[Info] %1 Samples were stored at\n%2\n"
@@ -321,6 +460,20 @@ void GestureSampleCollector::_samplingCompleted()
                                   _sample_collector->storage_path.toHtmlEscaped()
                                   )
                               );
+    if (stats.samples > 0)
+        main_view->appendText(QString(tr("[Info] Original images were stored as %1%2: %3 ms, %4 KB per sample.\n")).arg(
+                                  QString::fromLatin1(stats.codec),
+                                  stats.compression < 0 ? QString() : QString(tr(" (level %1)")).arg(stats.compression),
+                                  QString::number(stats.encode_time, 'f', 2),
+                                  QString::number(stats.file_size/1024, 'f', 1)
+                                  )
+                              );
+    if (stats.duplicates > 0)
+        main_view->appendText(QString(tr("[Info] %1 samples were nearly identical to recent ones and were %2.\n")).arg(
+                                  QString::number(stats.duplicates),
+                                  _settings->sample_dedup_mode == "SKIP" ? tr("skipped") : tr("flagged in the manifest")
+                                  )
+                              );
     QMessageBox::information(main_view, tr("Sampling Completed"),
                              QString(tr("<div style=\"font-weight:100\">%1 samples were collected. All samples were stored at<pre style=\"padding-left:10px\">%3</pre></div>")).arg(
                                  QString::number(_samples_collected),
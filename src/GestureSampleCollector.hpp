@@ -7,14 +7,17 @@
  */
 #include <QObject>
 #include <QTimer>
+#include <QElapsedTimer>
 #include <QString>
 
 #include "Settings.hpp"
+#include "CvQtImgConvertor.hpp"
 #include "MainView.hpp"
 #include "SettingsView.hpp"
 #include "MonitorView.hpp"
 #include "HandDetector.hpp"
 #include "SampleCollector.hpp"
+#include "FramePipeline.hpp"
 
 /**
  * @brief The GestureSampleCollector class is the main class of the sample collector.
@@ -130,8 +133,9 @@ public slots:
     void verifyRoiRange(const int &start_x, const int &end_x, const int &start_y, const int &end_y);
     /**
      * @brief updateBackgroundImage updates the background image shown in the setting window.
+     * @param img : the background image sent by #HandDetector::backgroundImageSet
      */
-    void updateBackgroundImage();
+    void updateBackgroundImage(const QImage &img);
         /**
      * @brief openCamera opens the camera and shows error message if the camera cannot be open.
      * @see #GestureControlSystem::_handleCameraError
@@ -145,12 +149,41 @@ public slots:
      */
     void releaseCamera();
     /**
-     * @brief captureFrame captures frame from the camera and analyzes the captured frame. It will show an error message if it failed to capture frame from the camera.
+     * @brief setRefreshRates sets the refresh rates of the windows and the detection rate.
      *
-     * @see #GestureControlSystem::_processCapturedFrame
-     * @see #GestureControlSystem::_handleCameraError
+     * Frames are captured at #GestureSampleCollector::camera_fps whatever the rates are.
+     *
+     * @param preview_fps : refresh rate of the video shown on the main window
+     * @param monitor_fps : refresh rate of the images shown on the monitor window
+     * @param detection_fps : rate of detecting hands while not sampling
+     *
+     * @see #FramePipeline
+     */
+    void setRefreshRates(const int &preview_fps, const int &monitor_fps, const int &detection_fps);
+    /**
+     * @brief setHudEnabled shows or hides the performance HUD over the video on the main window.
+     *
+     * The HUD shows the capture rate, the detection latency, the number of dropped frames, the depth of the queue of
+     * sample images waiting to be stored, and the disk throughput, refreshed every #HUD_REFRESH_INTERVAL milliseconds.
+     * The pipeline counts nothing while the HUD is hidden.
+     *
+     * @param enable : show the HUD or not
      */
-    void captureFrame();
+    void setHudEnabled(const bool &enable);
+    /**
+     * @brief setTrackingEnabled sets if a detected hand is tracked between full detections for the monitor window.
+     * @param enable : track hands or not
+     *
+     * @see #HandTracker
+     */
+    void setTrackingEnabled(const bool &enable);
+    /**
+     * @brief setFrameFrozen freezes the video on the current frame or not, for tuning the hand detector on it.
+     * @param freeze : freeze the video or not
+     *
+     * @see #FramePipeline::setFrozen
+     */
+    void setFrameFrozen(const bool &freeze);
     /**
      * @brief startSamplingTask starts a sampling task.
      *
@@ -179,10 +212,28 @@ private:
     WORK_STATUS _work_status;
     cv::Rect _roi;
     int unsigned _camera_fps;
-    cv::VideoCapture *_camera;
-    QTimer *_camera_capture_timer;
     HandDetector *_hand_detector;
     SampleCollector *_sample_collector;
+    /**
+     * _pipeline captures, detects and samples frames in a worker thread.
+     */
+    FramePipeline *_pipeline;
+    /**
+     * _preview_timer is the timer of refreshing the video shown on the main window.
+     */
+    QTimer *_preview_timer;
+    /**
+     * _monitor_timer is the timer of refreshing the images shown on the monitor window.
+     */
+    QTimer *_monitor_timer;
+    /**
+     * _hud_timer is the timer of refreshing the performance HUD. It runs only while the HUD is shown and the camera is open.
+     */
+    QTimer *_hud_timer;
+    bool _hud_enabled;
+    QElapsedTimer _hud_clock;
+    FramePipeline::Counters _hud_counters;
+    qint64 _hud_bytes;
     /**
      * _sampling_trails is an indicator of how many sampling trails have been conducted.
      *
@@ -201,25 +252,10 @@ private:
      * _handleCameraError is the callback function to handle the camera error.
      *
      * It do the following by default:
-     *  - stop #GestureControlSystem::_camera_capture_timer
+     *  - stop #GestureControlSystem::_preview_timer and #GestureControlSystem::_monitor_timer
      *  - emit #GestureControlSystem::cameraReleased() to inform the release of the camera.
      */
     void _handleCameraError();
-    /**
-     * _processCapturedFrame is the callback function to deal with the frame captured by the camera.
-     *
-     * It do the following by default:
-     *
-     *  - detect the hand/gesture via #HandDetector from the region of interesting on the captured frame,
-     *  - make command via #CommandMaker using the analyst result obtained by #GestureAnalyst, and
-     *  - draw the region of interesting on the captured frame and show the captured frame on the tracking window.
-     *
-     */
-    void _processCapturedFrame(cv::Mat &captured_frame);
-    /**
-     * _sample does sampling via #SampleCollector::sample
-     */
-    void _sample(const cv::Mat &orig_img, const cv::Mat &proc_img);
     /**
      * _sampling_completed is the callback function when sampling completed.
      *
@@ -237,7 +273,63 @@ private slots:
      * _changeWorkStatusToNothing sets the work status to STATUS_IDLE.
      */
     void _changeWorkStatusToNothing();
-    
+    /*
+     * _handleStorageError handles the failure of storing sample images asynchronously.
+     */
+    void _handleStorageError();
+    /*
+     * _cameraOpened starts refreshing the windows after the pipeline starts capturing.
+     */
+    void _cameraOpened();
+    /*
+     * _cameraFailed handles the failure of opening the camera or capturing frames.
+     */
+    void _cameraFailed();
+    /*
+     * _refreshPreview shows the latest frame captured on the main window.
+     */
+    void _refreshPreview();
+    /*
+     * _refreshMonitor shows the latest intermediate images of detection on the monitor window.
+     */
+    void _refreshMonitor();
+    /*
+     * _refreshHud shows the performance statistics since the last refresh on the main window.
+     */
+    void _refreshHud();
+    /*
+     * _skinColorCalibrated shows that the calibrated skin color filter is in use.
+     */
+    void _skinColorCalibrated();
+    /*
+     * _skinColorCalibrationCleared shows that the skin color bounds are in use again.
+     */
+    void _skinColorCalibrationCleared();
+    /*
+     * _sampleCollected shows the progress of sampling.
+     */
+    void _sampleCollected(const int &count);
+    /*
+     * _sampleMissed informs that nothing was detected when a sample was due.
+     */
+    void _sampleMissed();
+    /*
+     * _sampleSkipped informs that a sample was skipped as nearly identical to a recent one.
+     */
+    void _sampleSkipped();
+    /*
+     * _sampleFailed handles the failure of taking a sample.
+     */
+    void _sampleFailed();
+    /*
+     * _samplingFinished completes sampling after the pipeline collected all samples.
+     */
+    void _samplingFinished();
+    /*
+     * _recordingFailed informs that the sampling session failed to be recorded.
+     */
+    void _recordingFailed();
+
 };
 
 #endif
\ No newline at end of file
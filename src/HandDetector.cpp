@@ -1,5 +1,9 @@
 #include "HandDetector.hpp"
 
+#include <algorithm>
+
+#include "CvQtImgConvertor.hpp"
+
 const cv::Scalar HandDetector::COLOR_BLACK(cv::Scalar(0,0,0,255));
 const cv::Scalar HandDetector::COLOR_WHITE(cv::Scalar(255,255,255,255));
 const cv::Scalar HandDetector::COLOR_GRAY(cv::Scalar(127, 127, 127, 255));
@@ -7,56 +11,169 @@ const cv::Scalar HandDetector::COLOR_RED(cv::Scalar(0,0,255,255));
 const cv::Scalar HandDetector::COLOR_GREEN(cv::Scalar(0,255,0,255));
 const cv::Scalar HandDetector::COLOR_BLUE(cv::Scalar(255,0,0,255));
 
+// the stride-3 loads of BGR pixels are vectorized only with the byte shuffles of SSSE3,
+// which are not in the baseline of x86-64, so that the row filter is compiled for each and picked at runtime
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 6 && defined(__x86_64__) && defined(__ELF__)
+#  define YCRCB_TARGET_CLONES __attribute__((target_clones("avx2", "ssse3", "default")))
+#else
+#  define YCRCB_TARGET_CLONES
+#endif
+
+namespace
+{
+    // coefficients of cv::COLOR_BGR2YCrCb for 8-bit images scaled by 2^YCRCB_SHIFT, with which
+    // Y is rounded first, and Cr and Cb are then computed from R - Y and B - Y
+    enum
+    {
+        YCRCB_SHIFT = 14,
+        Y_R = 4899, Y_G = 9617, Y_B = 1868,
+        CR = 11682, CB = 9241
+    };
+
+    // a value v in [lo, lo + range) is tested as (unsigned)(v - lo) < range
+    template <bool MASKED>
+    YCRCB_TARGET_CLONES
+    void filterYCrCbRow(const uchar *src, const uchar *mask, uchar *dst, const int cols,
+                        const int lo[3], const unsigned int range[3])
+    {
+        // copied, since the bounds could be aliased by the result as far as the compiler knows
+        const int y_lo = lo[0], cr_lo = lo[1], cb_lo = lo[2];
+        const unsigned int y_range = range[0], cr_range = range[1], cb_range = range[2];
+        for (int x = 0; x < cols; ++x, src += 3)
+        {
+            const int b = src[0], g = src[1], r = src[2];
+            const int y = (Y_R*r + Y_G*g + Y_B*b + (1 << (YCRCB_SHIFT - 1))) >> YCRCB_SHIFT;
+            const unsigned int in = (static_cast<unsigned int>(y - y_lo) < y_range) &
+                                    (static_cast<unsigned int>(CR*(r - y) - cr_lo) < cr_range) &
+                                    (static_cast<unsigned int>(CB*(b - y) - cb_lo) < cb_range);
+            dst[x] = static_cast<uchar>(-static_cast<int>(MASKED ? in & (mask[x] != 0) : in));
+        }
+    }
+}
+
 HandDetector::HandDetector(QObject *parent) :
     QObject(parent),
     interesting_img(_interesting_img),
     filtered_img(_filtered_img),
-    convexity_img(_convexity_img),
     extracted_img(_extracted_img),
     background_img(_background_img),
-    skin_color_lower_bound(_skin_color_lower_bound),
-    skin_color_upper_bound(_skin_color_upper_bound),
-    morphology(_morphology),
-    detection_area(_detection_area),
+    result(_result),
+    background_subtraction(_has_set_bg),
+    skin_color_lower_bound(_params.skin_color_lower_bound),
+    skin_color_upper_bound(_params.skin_color_upper_bound),
+    skin_color_ycrcb(_params.skin_color_ycrcb),
+    skin_color_ycrcb_lower_bound(_params.skin_color_ycrcb_lower_bound),
+    skin_color_ycrcb_upper_bound(_params.skin_color_ycrcb_upper_bound),
+    morphology(_params.morphology),
+    detection_area(_params.detection_area),
     waitting_bg(_waitting_bg),
+    skin_color_calibration(_skin_color_calibration),
+    waitting_calibration(_waitting_calibration),
+    params(_params),
     _bg_subtractor(cv::createBackgroundSubtractorMOG2(1, 16, false)),
     _has_set_bg(false),
     _waitting_bg(false),
-    _skin_color_lower_bound(cv::Scalar(DEFAULT_SKIN_COLOR_MIN_H, DEFAULT_SKIN_COLOR_MIN_S, DEFAULT_SKIN_COLOR_MIN_V)),
-    _skin_color_upper_bound(cv::Scalar(DEFAULT_SKIN_COLOR_MAX_H, DEFAULT_SKIN_COLOR_MAX_S, DEFAULT_SKIN_COLOR_MAX_V)),
+    _skin_color_calibration(false),
+    _waitting_calibration(false),
     _gaussian_size(cv::Size(7,7)),
     _gaussian_variance(0.8),
-    _morphology(DEFAULT_SKIN_MORPHOLOGY),
     _morphology_kernel(cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(9, 9))),
-    _detection_area(DEFAULT_SKIN_DETECTION_AREA)
+    _cache_level(CACHE_NONE),
+    _cache_hand_index(-1)
 {}
 
 bool HandDetector::detect(const cv::Mat &input_img)
 {
+    if (_published.update())
+        _params = _published.front();
     input_img.copyTo(_interesting_img);
+    _cache_level = CACHE_NONE;
+    _processImage();
+    const bool detected = _extractHand();
+    if (!_waitting_calibration)
+        return detected;
+
+    _calibrateSkinColor();
     _processImage();
     return _extractHand();
 }
 
+bool HandDetector::redetect()
+{
+    if (_published.update())
+        _params = _published.front();
+    if (_interesting_img.empty())
+        return false;
+    _processImage();
+    const bool detected = _extractHand();
+    if (!_waitting_calibration)
+        return detected;
+
+    _calibrateSkinColor();
+    _processImage();
+    return _extractHand();
+}
+
+bool HandDetector::outdated() const
+{
+    return _cache_level != CACHE_HAND || _published.pending();
+}
+
+void HandDetector::setParams(const DetectorParams &params)
+{
+    const quint64 version = _staged.version;
+    _staged = params;
+    _staged.version = version;
+    _publishParams();
+}
 
 void HandDetector::setMorphology(const bool &perform_morphology)
 {
-    _morphology = perform_morphology;
+    _staged.morphology = perform_morphology;
+    _publishParams();
 }
 
 void HandDetector::setSkinColorFilterLowerBound(const int &H, const int &S, const int &V)
 {
-    _skin_color_lower_bound = cv::Scalar(H, S, V);
+    _staged.skin_color_lower_bound = cv::Scalar(H, S, V);
+    _publishParams();
 }
 
 void HandDetector::setSkinColorFilterUpperBound(const int &H, const int &S, const int &V)
 {
-    _skin_color_upper_bound = cv::Scalar(H, S, V);
+    _staged.skin_color_upper_bound = cv::Scalar(H, S, V);
+    _publishParams();
+}
+
+void HandDetector::setSkinColorFilterYCrCb(const bool &ycrcb)
+{
+    _staged.skin_color_ycrcb = ycrcb;
+    _publishParams();
+}
+
+void HandDetector::setSkinColorFilterYCrCbLowerBound(const int &Y, const int &Cr, const int &Cb)
+{
+    _staged.skin_color_ycrcb_lower_bound = cv::Scalar(Y, Cr, Cb);
+    _publishParams();
+}
+
+void HandDetector::setSkinColorFilterYCrCbUpperBound(const int &Y, const int &Cr, const int &Cb)
+{
+    _staged.skin_color_ycrcb_upper_bound = cv::Scalar(Y, Cr, Cb);
+    _publishParams();
 }
 
 void HandDetector::setDetectionArea(const int &area)
 {
-    _detection_area = area;
+    _staged.detection_area = area;
+    _publishParams();
+}
+
+void HandDetector::_publishParams()
+{
+    ++_staged.version;
+    _published.back() = _staged;
+    _published.publish();
 }
 
 void HandDetector::setBackgroundImage()
@@ -70,9 +187,142 @@ void HandDetector::clearBackgroundImage()
 {
     _has_set_bg = false;
     _waitting_bg = false;
+    _cache_level = CACHE_NONE;
     emit backgroundImageCleared();
 }
 
+void HandDetector::calibrateSkinColor()
+{
+    _waitting_calibration = true;
+}
+
+void HandDetector::clearSkinColorCalibration()
+{
+    _skin_color_calibration = false;
+    _waitting_calibration = false;
+    _skin_lut.clear();
+    _cache_level = CACHE_NONE;
+    emit skinColorCalibrationCleared();
+}
+
+void HandDetector::_calibrateSkinColor()
+{
+    _waitting_calibration = false;
+
+    // sample the hand, or the center where a hand is expected
+    cv::Mat mask = cv::Mat::zeros(_interesting_img.size(), CV_8UC1);
+    if (_result.detected && _cache_hand_index > -1)
+        cv::drawContours(mask, _contours, _cache_hand_index, cv::Scalar(255), -1);
+    else
+        mask(cv::Rect(mask.cols/4, mask.rows/4, mask.cols/2, mask.rows/2)).setTo(cv::Scalar(255));
+    if (_has_set_bg)
+        mask.setTo(cv::Scalar(0), _bg == 0);
+
+    cv::Mat hsv, hist;
+    cv::cvtColor(_interesting_img, hsv, cv::COLOR_RGB2HSV);
+    const int channels[] = {0, 1};
+    const int bins[] = {SKIN_CALIBRATION_H_BINS, SKIN_CALIBRATION_S_BINS};
+    const float h_range[] = {0, 180}, s_range[] = {0, 256};
+    const float *ranges[] = {h_range, s_range};
+    cv::calcHist(&hsv, 1, channels, mask, hist, 2, bins, ranges);
+    // fill the gaps between the sparse samples of similar colors
+    cv::GaussianBlur(hist, hist, cv::Size(3, 3), 0);
+    double max;
+    cv::minMaxLoc(hist, nullptr, &max);
+    if (max <= 0)
+        return;
+
+    // compile the histogram into a lookup table, by classifying the center color of each quantized BGR cell
+    const int levels = 1 << SKIN_LUT_BITS, shift = 8 - SKIN_LUT_BITS;
+    cv::Mat colors(1, levels*levels*levels, CV_8UC3);
+    auto c = colors.ptr<cv::Vec3b>();
+    for (auto b = 0; b < levels; ++b)
+        for (auto g = 0; g < levels; ++g)
+            for (auto r = 0; r < levels; ++r, ++c)
+                *c = cv::Vec3b((b << shift) | (1 << (shift-1)),
+                               (g << shift) | (1 << (shift-1)),
+                               (r << shift) | (1 << (shift-1)));
+    cv::cvtColor(colors, colors, cv::COLOR_RGB2HSV);
+    _skin_lut.resize(colors.cols);
+    const double thresh = SKIN_CALIBRATION_THRESHOLD*max;
+    c = colors.ptr<cv::Vec3b>();
+    for (auto i = 0; i < colors.cols; ++i, ++c)
+        _skin_lut[i] = hist.at<float>(std::min((*c)[0]*SKIN_CALIBRATION_H_BINS/180, SKIN_CALIBRATION_H_BINS - 1),
+                                      (*c)[1]*SKIN_CALIBRATION_S_BINS/256) >= thresh ? 255 : 0;
+
+    _skin_color_calibration = true;
+    _cache_level = CACHE_NONE;
+    emit skinColorCalibrated();
+}
+
+void HandDetector::_classifySkinColor()
+{
+    const int shift = 8 - SKIN_LUT_BITS;
+    const uchar *lut = _skin_lut.data();
+    _skin_img.create(_interesting_img.size(), CV_8UC1);
+    for (auto y = 0; y < _interesting_img.rows; ++y)
+    {
+        auto src = _interesting_img.ptr<cv::Vec3b>(y);
+        auto dst = _skin_img.ptr<uchar>(y);
+        for (auto x = 0; x < _interesting_img.cols; ++x)
+            dst[x] = lut[((src[x][0] >> shift) << (2*SKIN_LUT_BITS)) |
+                         ((src[x][1] >> shift) << SKIN_LUT_BITS) |
+                          (src[x][2] >> shift)];
+    }
+}
+
+void HandDetector::filterSkinColorYCrCb(const cv::Mat &img, const cv::Mat &mask,
+                                        const cv::Scalar &lower_bound, const cv::Scalar &upper_bound,
+                                        cv::Mat &dst)
+{
+    CV_Assert(img.type() == CV_8UC3 && (mask.empty() || (mask.type() == CV_8UC1 && mask.size() == img.size())));
+    // Y is tested as it is, while an 8-bit Cr or Cb value c is the rounded fixed-point one v,
+    // i.e. (v + 2^(YCRCB_SHIFT-1)) >> YCRCB_SHIFT, plus 128, saturated to [0, 255], and thus c in [lower, upper]
+    // iff v in [(lower - 128) << YCRCB_SHIFT, (upper - 128 + 1) << YCRCB_SHIFT) - 2^(YCRCB_SHIFT-1),
+    // where a bound of 0 or 255 is extended to cover the saturated values.
+    int lo[3];
+    unsigned int range[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        int lower = std::max(0, static_cast<int>(lower_bound[i]));
+        int upper = std::min(255, static_cast<int>(upper_bound[i]));
+        if (upper < lower)
+        {
+            lo[i] = 0;
+            range[i] = 0;
+        }
+        else if (i == 0)
+        {
+            lo[i] = lower;
+            range[i] = upper - lower + 1;
+        }
+        else
+        {
+            if (lower == 0)
+                lower = -255;
+            if (upper == 255)
+                upper = 511;
+            lo[i] = (lower - 128)*(1 << YCRCB_SHIFT) - (1 << (YCRCB_SHIFT - 1));
+            range[i] = static_cast<unsigned int>(upper - lower + 1) << YCRCB_SHIFT;
+        }
+    }
+
+    dst.create(img.size(), CV_8UC1);
+    int rows = img.rows, cols = img.cols;
+    if (img.isContinuous() && dst.isContinuous() && (mask.empty() || mask.isContinuous()))
+    {
+        cols *= rows;
+        rows = 1;
+    }
+    for (int y = 0; y < rows; ++y)
+    {
+        if (mask.empty())
+            filterYCrCbRow<false>(img.ptr<uchar>(y), nullptr, dst.ptr<uchar>(y), cols, lo, range);
+        else
+            filterYCrCbRow<true>(img.ptr<uchar>(y), mask.ptr<uchar>(y), dst.ptr<uchar>(y), cols, lo, range);
+    }
+}
+
 void HandDetector::_processImage()
 {
     // background subtractor
@@ -82,51 +332,107 @@ void HandDetector::_processImage()
         _has_set_bg = true;
         _waitting_bg = false;
         _interesting_img.copyTo(_background_img);
-        emit backgroundImageSet();
+        _cache_level = CACHE_NONE;
+        emit backgroundImageSet(CvQtImgConvertor::cvMat2QImage(_background_img.clone()));
     }
-    if (_has_set_bg == true)
+    if (_cache_level < CACHE_HSV || _cache_params.skin_color_ycrcb != _params.skin_color_ycrcb)
     {
-        _bg_subtractor->apply(_interesting_img, _bg, 0);
-        _interesting_img.copyTo(_filtered_img, _bg);
+        if (_cache_level < CACHE_HSV && _has_set_bg == true)
+            _bg_subtractor->apply(_interesting_img, _bg, 0);
+        // the calibrated skin color filter and the YCrCb one work on BGR colors directly
+        if (!_skin_color_calibration && !_params.skin_color_ycrcb)
+        {
+            cv::cvtColor(_interesting_img, _hsv_img, cv::COLOR_RGB2HSV);
+            // black is black in HSV color space as well
+            if (_has_set_bg == true)
+                _hsv_img.setTo(COLOR_BLACK, _bg == 0);
+        }
+        _cache_params.skin_color_ycrcb = _params.skin_color_ycrcb;
+        _cache_level = CACHE_HSV;
     }
-    else
-        _interesting_img.copyTo(_filtered_img);
-
-    // skin color filter
-    cv::cvtColor(_filtered_img, _filtered_img, cv::COLOR_RGB2HSV);
-    cv::inRange(_filtered_img, _skin_color_lower_bound, _skin_color_upper_bound, _filtered_img);
-    // smooth
-    cv::GaussianBlur(_filtered_img, _filtered_img, _gaussian_size, _gaussian_variance);
-    // thresholding
-    cv::threshold(_filtered_img, _filtered_img, 10, 255, cv::THRESH_BINARY);
-    // morphological transformation
-    if (_morphology)
+
+    if (_cache_level < CACHE_SKIN ||
+            (!_skin_color_calibration &&
+             (_params.skin_color_ycrcb ?
+                  _cache_params.skin_color_ycrcb_lower_bound != _params.skin_color_ycrcb_lower_bound ||
+                  _cache_params.skin_color_ycrcb_upper_bound != _params.skin_color_ycrcb_upper_bound :
+                  _cache_params.skin_color_lower_bound != _params.skin_color_lower_bound ||
+                  _cache_params.skin_color_upper_bound != _params.skin_color_upper_bound)))
     {
-        cv::morphologyEx(_filtered_img, _filtered_img, cv::MORPH_OPEN, _morphology_kernel);
-        cv::morphologyEx(_filtered_img, _filtered_img,cv::MORPH_CLOSE, _morphology_kernel);
+        // skin color filter
+        if (_skin_color_calibration)
+        {
+            _classifySkinColor();
+            if (_has_set_bg == true)
+                _skin_img.setTo(cv::Scalar(0), _bg == 0);
+        }
+        else if (_params.skin_color_ycrcb)
+            filterSkinColorYCrCb(_interesting_img, _has_set_bg ? _bg : cv::Mat(),
+                                 _params.skin_color_ycrcb_lower_bound, _params.skin_color_ycrcb_upper_bound, _skin_img);
+        else
+            cv::inRange(_hsv_img, _params.skin_color_lower_bound, _params.skin_color_upper_bound, _skin_img);
+        // smooth
+        cv::GaussianBlur(_skin_img, _skin_img, _gaussian_size, _gaussian_variance);
+        // thresholding
+        cv::threshold(_skin_img, _skin_img, 10, 255, cv::THRESH_BINARY);
+        _cache_params.skin_color_lower_bound = _params.skin_color_lower_bound;
+        _cache_params.skin_color_upper_bound = _params.skin_color_upper_bound;
+        _cache_params.skin_color_ycrcb_lower_bound = _params.skin_color_ycrcb_lower_bound;
+        _cache_params.skin_color_ycrcb_upper_bound = _params.skin_color_ycrcb_upper_bound;
+        _cache_level = CACHE_SKIN;
+    }
+
+    if (_cache_level < CACHE_FILTERED || _cache_params.morphology != _params.morphology)
+    {
+        // morphological transformation
+        if (_params.morphology)
+        {
+            cv::morphologyEx(_skin_img, _filtered_img, cv::MORPH_OPEN, _morphology_kernel);
+            cv::morphologyEx(_filtered_img, _filtered_img,cv::MORPH_CLOSE, _morphology_kernel);
+        }
+        else
+            _skin_img.copyTo(_filtered_img);
+        _cache_params.morphology = _params.morphology;
+        _cache_level = CACHE_FILTERED;
     }
 }
 
 bool HandDetector::_extractHand()
 {
-    std::vector<std::vector<cv::Point> > contours;
-    double area, largest_area = 0, thresh = 0.9*_filtered_img.rows*_filtered_img.cols;
-    _convexity_img = cv::Mat(_filtered_img.rows, _filtered_img.cols, CV_8UC3);
-    _convexity_img.setTo(HandDetector::COLOR_WHITE);
-    _extracted_img.release();
+    double largest_area = 0, thresh = 0.9*_filtered_img.rows*_filtered_img.cols;
 
     // contour extraction
-    cv::findContours(_filtered_img, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
+    if (_cache_level < CACHE_CONTOURS)
+    {
+        _contours.clear();
+#if CV_VERSION_MAJOR == 3 && CV_VERSION_MINOR < 2
+        // the source image is modified by findContours before OpenCV 3.2
+        cv::findContours(_filtered_img.clone(), _contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
+#else
+        cv::findContours(_filtered_img, _contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_NONE);
+#endif
+        _contour_areas.resize(_contours.size());
+        for (std::size_t i = 0; i < _contours.size(); ++i)
+            _contour_areas[i] = cv::contourArea(_contours[i]);
+        _cache_level = CACHE_CONTOURS;
+    }
     int indx = -1;
-    for (int i = static_cast<int>(contours.size()); --i > -1;)
+    for (int i = static_cast<int>(_contours.size()); --i > -1;)
     {
-        area = cv::contourArea(contours[i]);
-        if (area > _detection_area && area > largest_area)
+        if (_contour_areas[i] > _params.detection_area && _contour_areas[i] > largest_area)
         {
-            largest_area = area;
+            largest_area = _contour_areas[i];
             indx = i;
         }
     }
+    // the same contour is picked as last time, whose geometry is up to date
+    if (_cache_level == CACHE_HAND && indx == _cache_hand_index)
+        return _result.detected;
+    _cache_hand_index = indx;
+    _cache_level = CACHE_HAND;
+
+    _extracted_img.release();
+    _result.detected = false;
     // fail if no contour extraction
     if (indx == -1 || largest_area > thresh)
         return false;
@@ -140,11 +446,11 @@ bool HandDetector::_extractHand()
     std::vector<int> farthest_points;
     double dist1, dist2, angle;
     bool flag1, flag2;
-    cv::Rect hand_bound = cv::boundingRect(contours[indx]);
+    cv::Rect hand_bound = cv::boundingRect(_contours[indx]);
     // Filter convexity defects for the sake of estimating the hand region
 
     // approximate contour region using polygon
-    cv::approxPolyDP(contours[indx], contour, 10.0, true);
+    cv::approxPolyDP(_contours[indx], contour, 10.0, true);
     // extract convexity defects
     cv::convexHull(contour, hulls[0], false);
     cv::convexityDefects(contour, hulls[0], defects);
@@ -216,8 +522,8 @@ bool HandDetector::_extractHand()
     //        hand_center.y = mom.m01/mom.m00;
 
     // estimate hand center via distance transformation
-    cv::Mat _dist_img(_convexity_img.rows, _convexity_img.cols, CV_8UC1);
-    cv::drawContours(_dist_img, contours, indx, cv::Scalar(255), -1);
+    cv::Mat _dist_img = cv::Mat::zeros(_filtered_img.rows, _filtered_img.cols, CV_8UC1);
+    cv::drawContours(_dist_img, _contours, indx, cv::Scalar(255), -1);
     cv::distanceTransform(_dist_img, _dist_img, CV_DIST_L2, 3);
     cv::Point _;
     double min,max;
@@ -342,16 +648,16 @@ bool HandDetector::_extractHand()
     // }
 
     // generate output images
+    // the hand geometry is drawn by the views as overlays, see VideoWidget
     _filtered_img(hand_bound).copyTo(_extracted_img);
-    cv::drawContours(_convexity_img, contours, indx, HandDetector::COLOR_GRAY, -1);
-    for (const auto & p : fingers)
-    {
-        cv::circle(_convexity_img, p, 10, HandDetector::COLOR_RED, 3);
-        cv::line(_convexity_img, p, hand_center, HandDetector::COLOR_BLUE, 3);
-    }
-    cv::rectangle(_convexity_img, hand_bound, HandDetector::COLOR_GREEN, 2);
-    cv::circle(_convexity_img, hand_center, 10, HandDetector::COLOR_RED, -1);
-    cv::circle(_convexity_img, hand_center, palm_radius, HandDetector::COLOR_RED, 10);
+
+    _result.detected = true;
+    _result.hand_bound = hand_bound;
+    _result.hand_center = hand_center;
+    _result.palm_radius = palm_radius;
+    _result.contour_area = largest_area;
+    _result.fingers = std::move(fingers);
+    _result.contour = std::move(contour);
 
     return true;
 }
@@ -6,17 +6,108 @@
  * @brief The HandDetector.h file contains the class of detecting hand region and generate a binary image of the hand.
  */
 #include <QObject>
+#include <QImage>
 #include <QDebug>
 #include <opencv2/opencv.hpp>
 #include <vector>
 
 #include "config.h"
+#include "TripleBuffer.hpp"
+
+/**
+ * @brief The DetectionResult struct holds the hand geometry estimated by #HandDetector::detect .
+ *
+ * All coordinates are relative to the input image of #HandDetector::detect .
+ *
+ * @see #HandDetector::result
+ */
+struct DetectionResult
+{
+    /**
+     * @brief detected is the flag if a hand was detected or not.
+     */
+    bool detected = false;
+    /**
+     * @brief hand_bound is the bounding rectangle of the hand contour.
+     */
+    cv::Rect hand_bound;
+    /**
+     * @brief hand_center is the estimated center of the palm.
+     */
+    cv::Point hand_center;
+    /**
+     * @brief palm_radius is the estimated radius of the palm.
+     */
+    double palm_radius = 0;
+    /**
+     * @brief contour_area is the area of the hand contour.
+     */
+    double contour_area = 0;
+    /**
+     * @brief fingers are the estimated finger tops.
+     */
+    std::vector<cv::Point> fingers;
+    /**
+     * @brief contour is the polygon approximating the hand contour.
+     */
+    std::vector<cv::Point> contour;
+    /**
+     * @brief confidence is 1 for a hand detected by #HandDetector , or the share of the points tracked reliably
+     *        for a hand tracked by #HandTracker .
+     */
+    double confidence = 1;
+};
+
+/**
+ * @brief The DetectorParams struct holds the parameters of #HandDetector , which are changed together.
+ *
+ * @see #HandDetector::params
+ * @see #HandDetector::setParams
+ */
+struct DetectorParams
+{
+    /**
+     * @brief skin_color_lower_bound is the lower bound for the skin color filter in HSV color space.
+     */
+    cv::Scalar skin_color_lower_bound = cv::Scalar(DEFAULT_SKIN_COLOR_MIN_H, DEFAULT_SKIN_COLOR_MIN_S, DEFAULT_SKIN_COLOR_MIN_V);
+    /**
+     * @brief skin_color_upper_bound is the upper bound for the skin color filter in HSV color space.
+     */
+    cv::Scalar skin_color_upper_bound = cv::Scalar(DEFAULT_SKIN_COLOR_MAX_H, DEFAULT_SKIN_COLOR_MAX_S, DEFAULT_SKIN_COLOR_MAX_V);
+    /**
+     * @brief skin_color_ycrcb is the flag of filtering skin colors in YCrCb color space instead of HSV color space.
+     */
+    bool skin_color_ycrcb = DEFAULT_SKIN_COLOR_YCRCB;
+    /**
+     * @brief skin_color_ycrcb_lower_bound is the lower bound for the skin color filter in YCrCb color space.
+     */
+    cv::Scalar skin_color_ycrcb_lower_bound = cv::Scalar(DEFAULT_SKIN_COLOR_MIN_Y, DEFAULT_SKIN_COLOR_MIN_CR, DEFAULT_SKIN_COLOR_MIN_CB);
+    /**
+     * @brief skin_color_ycrcb_upper_bound is the upper bound for the skin color filter in YCrCb color space.
+     */
+    cv::Scalar skin_color_ycrcb_upper_bound = cv::Scalar(DEFAULT_SKIN_COLOR_MAX_Y, DEFAULT_SKIN_COLOR_MAX_CR, DEFAULT_SKIN_COLOR_MAX_CB);
+    /**
+     * @brief detection_area is the minimum area of a contour region who will be considered as a hand region.
+     */
+    int detection_area = DEFAULT_SKIN_DETECTION_AREA;
+    /**
+     * @brief morphology is the flag of performing morphology or not during image preprocessing.
+     */
+    bool morphology = DEFAULT_SKIN_MORPHOLOGY;
+    /**
+     * @brief version is increased by one every time the parameters are changed through #HandDetector .
+     */
+    quint64 version = 0;
+};
 
 /**
  * @brief The HandDetector class detects hand region andgenerate a binary image of the hand.
  *
  * **ATTENTION**:
- *  This function is not thread-safe.
+ *  This function is not thread-safe, except that the parameters in #DetectorParams can be set by another thread.
+ *  They are published as a whole without locking, and the detector picks the latest ones up at the beginning of
+ *  #HandDetector::detect , so that a frame is always processed with one consistent set of parameters.
+ *  The parameters should be set by one thread only.
  *
  * This class extracts gesture information by the function #HandDetector::detect
  *
@@ -90,15 +181,6 @@ public:
      * @see #HandDetector::detect
      */
     const cv::Mat &filtered_img;
-    /**
-     * @brief convexity_img is the image showing extracted contour region and convexity defects. This is a reference to #HandDetector::_convexity_img .
-     *
-     * A hand region and estimated hand center and finger tops would be drawn on the image.
-     *
-     * @see #HandDetector::_convexity_img
-     * @see #HandDetector::detect
-     */
-    const cv::Mat &convexity_img;
     /**
      * @brief extracted_img is the image of the extracted hand region. This is a reference to #HandDetector::_extracted_img .
      *
@@ -112,10 +194,26 @@ public:
     /**
      * @brief background_img is the background image used by the background subtractor.
      *
+     * It is written by the thread running the detection. Other threads should use the copy sent
+     * with #HandDetector::backgroundImageSet instead.
+     *
      * @see #HandDetector::_bg_subtractor
      * @see #HandDetector::filtered_img
      */
     const cv::Mat &background_img;
+    /**
+     * @brief result is the hand geometry estimated by the last call of #HandDetector::detect . This is a reference to #HandDetector::_result .
+     *
+     * @see #DetectionResult
+     */
+    const DetectionResult &result;
+    /**
+     * @brief background_subtraction is the flag if the background subtractor is in use or not.
+     *
+     * @see #HandDetector::setBackgroundImage
+     * @see #HandDetector::clearBackgroundImage
+     */
+    const bool &background_subtraction;
 
     /**
      * @brief skin_color_lower_bound is the lower bound for the skin color filter in HSV color space.
@@ -137,6 +235,33 @@ public:
      * @see #HandDetector::skin_color_lower_bound
      */
     const cv::Scalar &skin_color_upper_bound;
+    /**
+     * @brief skin_color_ycrcb is the flag if the skin color filter works in YCrCb color space
+     *        using #HandDetector::skin_color_ycrcb_lower_bound and #HandDetector::skin_color_ycrcb_upper_bound ,
+     *        instead of in HSV color space.
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCb
+     * @see #HandDetector::filterSkinColorYCrCb
+     */
+    const bool &skin_color_ycrcb;
+    /**
+     * @brief skin_color_ycrcb_lower_bound is the lower bound for the skin color filter in YCrCb color space.
+     *
+     * It is a `cv::Scalar` with three elements representing Y, Cr and Cb respectively in YCrCb color space.
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCbLowerBound
+     * @see #HandDetector::skin_color_ycrcb_upper_bound
+     */
+    const cv::Scalar &skin_color_ycrcb_lower_bound;
+    /**
+     * @brief skin_color_ycrcb_upper_bound is the upper bound for the skin color filter in YCrCb color space.
+     *
+     * It is a `cv::Scalar` with three elements representing Y, Cr and Cb respectively in YCrCb color space.
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCbUpperBound
+     * @see #HandDetector::skin_color_ycrcb_lower_bound
+     */
+    const cv::Scalar &skin_color_ycrcb_upper_bound;
 
     /**
      * @brief morphology is the flag of performing morphology or not during image preprocessing.
@@ -157,6 +282,26 @@ public:
      * @see #HandDetector::_bg_subtractor
      */
     const bool &waitting_bg;
+    /**
+     * @brief skin_color_calibration is the flag if the calibrated skin color filter is in use instead of
+     *        #HandDetector::skin_color_lower_bound and #HandDetector::skin_color_upper_bound .
+     *
+     * @see #HandDetector::calibrateSkinColor
+     * @see #HandDetector::clearSkinColorCalibration
+     */
+    const bool &skin_color_calibration;
+    /**
+     * @brief waitting_calibration is a indicator if the system is waitting for calibrating the skin color filter.
+     *
+     * @see #HandDetector::calibrateSkinColor
+     */
+    const bool &waitting_calibration;
+    /**
+     * @brief params is the parameters in effect, picked up at the beginning of the last call of #HandDetector::detect .
+     *
+     * @see #HandDetector::setParams
+     */
+    const DetectorParams &params;
 
     explicit HandDetector(QObject *parent = 0);
     /**
@@ -179,21 +324,60 @@ public:
      * @retval false : if nothing detected
      *
      * @see #HandDetector::filtered_img
-     * @see #HandDetector::convexity_img
      * @see #HandDetector::extracted_img
+     * @see #HandDetector::result
      */
     bool detect(const cv::Mat &input_img);
+    /**
+     * @brief redetect detects hand and fingers again from the last input image with the current parameters.
+     *
+     * The intermediate result of each step of #HandDetector::detect is kept with the parameters it depends on,
+     * and only the steps after the first one whose parameters changed are performed again, e.g.
+     * only the contour selection if #HandDetector::detection_area changed, or nothing if no parameter changed.
+     * It makes tuning the parameters on a frozen frame responsive.
+     *
+     * @retval true : if detect something
+     * @retval false : if nothing detected, or no image was given to #HandDetector::detect before
+     *
+     * @see #HandDetector::detect
+     */
+    bool redetect();
+    /**
+     * @brief outdated returns if #HandDetector::result may differ from the one given by detecting the same image again,
+     *        because new parameters were set, or the background image or the skin color calibration was cleared,
+     *        since the last detection.
+     *
+     * @see #MotionGate
+     */
+    bool outdated() const;
+
+    /**
+     * @brief filterSkinColorYCrCb marks the pixels whose colors are in the given range in YCrCb color space.
+     *
+     * The colors are converted as `cv::COLOR_BGR2YCrCb` does, but in fixed point without any division,
+     * and compared with the bounds scaled once instead of being converted back to 8 bits. The background mask is
+     * applied in the same pass. The loop is branchless, so that it can be vectorized by the compiler.
+     *
+     * @param img : an image of type `CV_8UC3` in BGR color space
+     * @param mask : a mask of type `CV_8UC1` having the same size as the image, or an empty one to mark all pixels in range
+     * @param lower_bound : the inclusive lower bound of Y, Cr and Cb
+     * @param upper_bound : the inclusive upper bound of Y, Cr and Cb
+     * @param dst : the result of type `CV_8UC1`, in which the marked pixels are 255 and the others 0
+     */
+    static void filterSkinColorYCrCb(const cv::Mat &img, const cv::Mat &mask,
+                                     const cv::Scalar &lower_bound, const cv::Scalar &upper_bound,
+                                     cv::Mat &dst);
 
 signals:
     /**
      * @brief backgroundImageSet is the signal to indicate a new background image for the background subtractor being set.
-     *        Use #HandDetector::background_img to retrieve the new background image.
+     * @param img : a deep copy of the new background image, which is safe to be used in any thread
      *
      * @see #HandDetector::setBackgroundImage
      * @see #HandDetector::backgroundImageCleared
      * @see #HandDetector::waiting_bg
      */
-    void backgroundImageSet();
+    void backgroundImageSet(const QImage &img);
     /**
      * @brief backgroundImageCleared is the signal to indicate the background image set for the background subtractor has been cleared.
      *
@@ -201,8 +385,29 @@ signals:
      * @see #HandDetector::backgroundImageSet
      */
     void backgroundImageCleared();
+    /**
+     * @brief skinColorCalibrated is the signal to indicate the skin color filter has been calibrated.
+     *
+     * @see #HandDetector::calibrateSkinColor
+     */
+    void skinColorCalibrated();
+    /**
+     * @brief skinColorCalibrationCleared is the signal to indicate the skin color calibration has been cleared.
+     *
+     * @see #HandDetector::clearSkinColorCalibration
+     */
+    void skinColorCalibrationCleared();
 
 public slots:
+    /**
+     * @brief setParams sets all parameters in #DetectorParams except the version at once.
+     *
+     * Like the other setters of parameters, it can be called from another thread than the one owning the detector,
+     * and takes effect on the next call of #HandDetector::detect .
+     *
+     * @param params : the parameters
+     */
+    void setParams(const DetectorParams &params);
     /**
      * @brief setMorphology sets the flag of performing the morphological transformation.
      * @param perform_morphology : the flag of performing the morphological transformation or not.
@@ -233,6 +438,38 @@ public slots:
      * @see #HandDetector::setSkinColorFilterLowerBound
      */
     void setSkinColorFilterUpperBound(const int & H, const int & S, const int & V);
+    /**
+     * @brief setSkinColorFilterYCrCb sets the flag of filtering skin colors in YCrCb color space instead of HSV color space.
+     *
+     * The YCrCb filter is cheaper, since the color conversion needs no division and is fused with the thresholding
+     * and the background mask.
+     *
+     * @param ycrcb : filter in YCrCb color space or not
+     *
+     * @see #HandDetector::skin_color_ycrcb
+     * @see #HandDetector::filterSkinColorYCrCb
+     */
+    void setSkinColorFilterYCrCb(const bool & ycrcb);
+    /**
+     * @brief setSkinColorFilterYCrCbLowerBound sets the lower bound for the skin color filter in YCrCb color space.
+     * @param Y : luma, in range 0 to 255
+     * @param Cr : red difference, in range 0 to 255
+     * @param Cb : blue difference, in range 0 to 255
+     *
+     * @see #HandDetector::skin_color_ycrcb_lower_bound
+     * @see #HandDetector::setSkinColorFilterYCrCbUpperBound
+     */
+    void setSkinColorFilterYCrCbLowerBound(const int & Y, const int & Cr, const int & Cb);
+    /**
+     * @brief setSkinColorFilterYCrCbUpperBound sets the upper bound for the skin color filter in YCrCb color space.
+     * @param Y : luma, in range 0 to 255
+     * @param Cr : red difference, in range 0 to 255
+     * @param Cb : blue difference, in range 0 to 255
+     *
+     * @see #HandDetector::skin_color_ycrcb_upper_bound
+     * @see #HandDetector::setSkinColorFilterYCrCbLowerBound
+     */
+    void setSkinColorFilterYCrCbUpperBound(const int & Y, const int & Cr, const int & Cb);
     /**
      * @brief setDetectionArea sets the minimum area of a contour region who will be considered as a hand region.
      * @param area : the minimum area
@@ -260,6 +497,29 @@ public slots:
      * @see #HandDetector::setBackgroundImage
      */
     void clearBackgroundImage();
+    /**
+     * @brief calibrateSkinColor indicates the class to calibrate the skin color filter on the next input image,
+     *        which should have a hand in it.
+     *
+     * The hue and saturation of the pixels in the hand contour detected by the current filter,
+     * or of the central part of the image if nothing is detected, are counted in a 2D histogram of
+     * #SKIN_CALIBRATION_H_BINS x #SKIN_CALIBRATION_S_BINS bins. The colors of the bins having at least
+     * #SKIN_CALIBRATION_THRESHOLD of the highest count are considered as skin colors.
+     * The histogram is compiled into a lookup table indexed by the quantized BGR color, so that the filter
+     * classifies a pixel by one table read without the color conversion, instead of testing the skin color bounds.
+     *
+     * @see #HandDetector::skin_color_calibration
+     * @see #HandDetector::skinColorCalibrated
+     * @see #HandDetector::clearSkinColorCalibration
+     */
+    void calibrateSkinColor();
+    /**
+     * @brief clearSkinColorCalibration makes the skin color filter use the skin color bounds again.
+     *
+     * @see #HandDetector::skinColorCalibrationCleared
+     * @see #HandDetector::calibrateSkinColor
+     */
+    void clearSkinColorCalibration();
 
 protected:
     /**
@@ -274,18 +534,18 @@ protected:
      * @see #HandDetector::filtered_img
      */
     cv::Mat _filtered_img;
-    /**
-     * @brief _convexity_img is the image showing extracted contour region and convexity defects.
-     *
-     * @see #HandDetector::convexity_img
-     */
-    cv::Mat _convexity_img;
     /**
      * @brief _extracted_img is the image of the extracted hand region.
      *
      * @see #HandDetector::extracted_img
      */
     cv::Mat _extracted_img;
+    /**
+     * @brief _result is the hand geometry estimated by the last detection.
+     *
+     * @see #HandDetector::result
+     */
+    DetectionResult _result;
     /**
      * @brief _bg_subtractor is the background subtractor used.
      *
@@ -301,16 +561,42 @@ private:
     bool _has_set_bg;
     bool _waitting_bg;
 
-    cv::Scalar _skin_color_lower_bound;
-    cv::Scalar _skin_color_upper_bound;
+    // indexed by the BGR color quantized to SKIN_LUT_BITS bits per channel
+    enum { SKIN_LUT_BITS = 5 };
+    std::vector<uchar> _skin_lut;
+    bool _skin_color_calibration;
+    bool _waitting_calibration;
+    inline void _calibrateSkinColor();
+    inline void _classifySkinColor();
 
     cv::Size _gaussian_size;
     double _gaussian_variance;
 
-    bool _morphology;
     cv::Mat _morphology_kernel;
 
-    int  _detection_area;
+    DetectorParams _params; // in effect, owned by the thread calling detect
+    DetectorParams _staged; // owned by the thread setting the parameters
+    TripleBuffer<DetectorParams> _published;
+
+    inline void _publishParams();
+
+    // steps of detection whose results are cached, in order
+    enum CACHE_LEVEL
+    {
+        CACHE_NONE,
+        CACHE_HSV,      // background subtraction and color conversion of the input image, keyed by the color space
+        CACHE_SKIN,     // skin color filter, blur and thresholding, keyed by the skin color bounds
+        CACHE_FILTERED, // morphological transformation, keyed by the morphology flag
+        CACHE_CONTOURS, // contours and their areas
+        CACHE_HAND      // hand geometry, keyed by the contour selected by the detection area
+    };
+    CACHE_LEVEL _cache_level;
+    DetectorParams _cache_params;
+    cv::Mat _hsv_img;
+    cv::Mat _skin_img;
+    std::vector<std::vector<cv::Point> > _contours;
+    std::vector<double> _contour_areas;
+    int _cache_hand_index;
 
     inline void _processImage();
     inline bool _extractHand();
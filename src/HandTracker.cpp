@@ -0,0 +1,111 @@
+#include "HandTracker.hpp"
+
+#include <algorithm>
+
+HandTracker::HandTracker(const int &interval, const double &min_confidence) :
+    result(_result),
+    filtered_img(_filtered_img),
+    extracted_img(_extracted_img),
+    _interval(std::max(1, interval)),
+    _min_confidence(min_confidence),
+    _locked(false),
+    _frames(0)
+{}
+
+void HandTracker::lock(const cv::Mat &img, const DetectionResult &result)
+{
+    _locked = result.detected && !result.contour.empty();
+    if (!_locked)
+        return;
+    _result = result;
+    _frames = 0;
+    _points.clear();
+    _points.reserve(result.contour.size() + result.fingers.size() + 1);
+    for (const auto &p : result.contour)
+        _points.push_back(cv::Point2f(p.x, p.y));
+    for (const auto &p : result.fingers)
+        _points.push_back(cv::Point2f(p.x, p.y));
+    _points.push_back(cv::Point2f(result.hand_center.x, result.hand_center.y));
+    cv::cvtColor(img, _gray, cv::COLOR_BGR2GRAY);
+}
+
+bool HandTracker::track(const cv::Mat &img)
+{
+    if (!_locked || ++_frames >= _interval || img.size() != _gray.size())
+    {
+        _locked = false;
+        return false;
+    }
+
+    cv::cvtColor(img, _next_gray, cv::COLOR_BGR2GRAY);
+    const cv::Size window(21, 21);
+    const int levels = 3;
+    cv::calcOpticalFlowPyrLK(_gray, _next_gray, _points, _next_points, _status, _error, window, levels);
+    cv::calcOpticalFlowPyrLK(_next_gray, _gray, _next_points, _back_points, _back_status, _error, window, levels);
+
+    // forward-backward check
+    std::vector<float> dx, dy;
+    dx.reserve(_points.size());
+    dy.reserve(_points.size());
+    for (std::size_t i = 0; i < _points.size(); ++i)
+    {
+        const cv::Point2f d = _back_points[i] - _points[i];
+        if (_status[i] && _back_status[i] && d.dot(d) <= TRACKING_MAX_ERROR*TRACKING_MAX_ERROR)
+        {
+            dx.push_back(_next_points[i].x - _points[i].x);
+            dy.push_back(_next_points[i].y - _points[i].y);
+        }
+        else
+            _status[i] = 0;
+    }
+    const double confidence = static_cast<double>(dx.size())/_points.size();
+    if (confidence < _min_confidence)
+    {
+        _locked = false;
+        return false;
+    }
+
+    // unreliable points follow the median motion
+    std::nth_element(dx.begin(), dx.begin() + dx.size()/2, dx.end());
+    std::nth_element(dy.begin(), dy.begin() + dy.size()/2, dy.end());
+    const cv::Point2f motion(dx[dx.size()/2], dy[dy.size()/2]);
+    for (std::size_t i = 0; i < _points.size(); ++i)
+        if (!_status[i])
+            _next_points[i] = _points[i] + motion;
+
+    const std::size_t fingers = _result.fingers.size();
+    const std::size_t contour = _points.size() - fingers - 1;
+    for (std::size_t i = 0; i < contour; ++i)
+        _result.contour[i] = _next_points[i];
+    for (std::size_t i = 0; i < fingers; ++i)
+        _result.fingers[i] = _next_points[contour + i];
+    _result.hand_center = _next_points.back();
+    _result.hand_bound = cv::boundingRect(_result.contour) & cv::Rect(0, 0, img.cols, img.rows);
+    if (_result.hand_bound.area() == 0)
+    {
+        _locked = false;
+        return false;
+    }
+    _result.contour_area = cv::contourArea(_result.contour);
+    _result.confidence = confidence;
+    _rasterize();
+
+    cv::swap(_gray, _next_gray);
+    _points.swap(_next_points);
+    return true;
+}
+
+void HandTracker::reset()
+{
+    _locked = false;
+}
+
+void HandTracker::_rasterize()
+{
+    _filtered_img.create(_gray.size(), CV_8UC1);
+    _filtered_img.setTo(cv::Scalar(0));
+    const cv::Point *polygon = _result.contour.data();
+    const int count = static_cast<int>(_result.contour.size());
+    cv::fillPoly(_filtered_img, &polygon, &count, 1, cv::Scalar(255));
+    _filtered_img(_result.hand_bound).copyTo(_extracted_img);
+}
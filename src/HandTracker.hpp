@@ -0,0 +1,94 @@
+#ifndef HANDTRACKER_H
+#define HANDTRACKER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The HandTracker.hpp file contains the class tracking a detected hand by optical flow.
+ */
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "config.h"
+#include "HandDetector.hpp"
+
+/**
+ * @brief The HandTracker class follows a hand detected by #HandDetector over the next frames by sparse optical flow,
+ *        which costs much less than detecting it again.
+ *
+ * The vertices of the hand contour, the finger tops and the palm center are tracked by pyramidal Lucas-Kanade flow.
+ * Each point is tracked back to the previous frame as well, and is reliable only if it lands within
+ * #TRACKING_MAX_ERROR pixels of where it started. An unreliable point follows the median motion of the reliable ones.
+ * The share of the reliable points is the confidence of the tracked result. The hand mask is rasterized from the
+ * tracked contour, in place of #HandDetector::filtered_img .
+ *
+ * #HandTracker::track fails, so that the caller should detect the hand again and lock the tracker on the new result,
+ * if the confidence is below #TRACKING_MIN_CONFIDENCE , or the hand has been tracked for #TRACKING_INTERVAL frames,
+ * or the frame size changed.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ */
+class HandTracker
+{
+public:
+    /**
+     * @brief result is the hand geometry tracked on the last frame, relative to the frame.
+     */
+    const DetectionResult &result;
+    /**
+     * @brief filtered_img is the black-white mask of the tracked hand contour.
+     */
+    const cv::Mat &filtered_img;
+    /**
+     * @brief extracted_img is the mask in the bounding rectangle of the tracked hand.
+     */
+    const cv::Mat &extracted_img;
+
+    /**
+     * @brief HandTracker is the constructor.
+     * @param interval : the number of frames after which the hand should be detected again
+     * @param min_confidence : the confidence below which the hand is considered lost
+     */
+    explicit HandTracker(const int &interval = TRACKING_INTERVAL, const double &min_confidence = TRACKING_MIN_CONFIDENCE);
+
+    /**
+     * @brief lock starts tracking a detected hand.
+     * @param img : the image of type `CV_8UC3` on which the hand was detected
+     * @param result : the detection result, nothing is tracked if no hand was detected
+     */
+    void lock(const cv::Mat &img, const DetectionResult &result);
+    /**
+     * @brief track follows the hand from the previous frame to the given one.
+     * @param img : the next image of type `CV_8UC3`
+     * @retval true : the hand is tracked, see #HandTracker::result
+     * @retval false : nothing is locked, or the hand is lost or should be detected again. Nothing is tracked then.
+     */
+    bool track(const cv::Mat &img);
+    /**
+     * @brief reset stops tracking.
+     */
+    void reset();
+
+private:
+    int _interval;
+    double _min_confidence;
+    bool _locked;
+    int _frames;
+    DetectionResult _result;
+    cv::Mat _filtered_img;
+    cv::Mat _extracted_img;
+    cv::Mat _gray;
+    cv::Mat _next_gray;
+    // the contour vertices, then the finger tops, then the palm center
+    std::vector<cv::Point2f> _points;
+    std::vector<cv::Point2f> _next_points;
+    std::vector<cv::Point2f> _back_points;
+    std::vector<uchar> _status;
+    std::vector<uchar> _back_status;
+    std::vector<float> _error;
+
+    inline void _rasterize();
+};
+
+#endif // HANDTRACKER_H
@@ -0,0 +1,182 @@
+#include "LandmarkStream.hpp"
+
+#include <QtEndian>
+#include <QByteArray>
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    const char MAGIC[4] = {'G', 'S', 'L', 'M'};
+    const quint16 FORMAT_VERSION = 1;
+    const int HEADER_SIZE = 8;
+}
+
+const int LandmarkStream::record_size = 30 + 4*LANDMARK_MAX_FINGERS + 2;
+
+LandmarkStream::LandmarkStream(QObject *parent) :
+    QThread(parent),
+    _queue(LANDMARK_STREAM_QUEUE_SIZE),
+    _stopping(0),
+    _open(false),
+    _dropped(0)
+{}
+
+LandmarkStream::~LandmarkStream()
+{
+    close();
+}
+
+bool LandmarkStream::open(const QString &file_path)
+{
+    close();
+
+    _file.setFileName(file_path);
+    if (!_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    uchar header[HEADER_SIZE];
+    std::memcpy(header, MAGIC, 4);
+    qToLittleEndian<quint16>(FORMAT_VERSION, header + 4);
+    qToLittleEndian<quint16>(record_size, header + 6);
+    if (_file.write(reinterpret_cast<const char *>(header), HEADER_SIZE) != HEADER_SIZE)
+    {
+        _file.close();
+        return false;
+    }
+    _stopping.store(0);
+    _dropped = 0;
+    _open = true;
+    start(QThread::LowPriority);
+    return true;
+}
+
+bool LandmarkStream::isOpen() const
+{
+    return _open;
+}
+
+bool LandmarkStream::append(const quint32 &frame_id, const qint64 &timestamp, const DetectionResult &result, const cv::Point &offset)
+{
+    if (!_open)
+        return false;
+    Landmarks landmarks;
+    landmarks.frame_id = frame_id;
+    landmarks.timestamp = timestamp;
+    landmarks.detected = result.detected;
+    if (result.detected)
+    {
+        landmarks.finger_count = std::min(static_cast<int>(result.fingers.size()), LANDMARK_MAX_FINGERS);
+        landmarks.hand_center = result.hand_center + offset;
+        landmarks.palm_radius = static_cast<float>(result.palm_radius);
+        landmarks.hand_bound = result.hand_bound + offset;
+        for (int i = 0; i < landmarks.finger_count; ++i)
+            landmarks.fingers[i] = result.fingers[i] + offset;
+    }
+    if (_queue.push(landmarks))
+        return true;
+    ++_dropped;
+    return false;
+}
+
+void LandmarkStream::close()
+{
+    if (!_open)
+        return;
+    _stopping.storeRelease(1);
+    wait();
+    _file.close();
+    _open = false;
+}
+
+qint64 LandmarkStream::dropped() const
+{
+    return _dropped;
+}
+
+bool LandmarkStream::read(const QString &file_path, std::vector<Landmarks> &landmarks)
+{
+    landmarks.clear();
+    QFile file(file_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray data = file.readAll();
+    const uchar *p = reinterpret_cast<const uchar *>(data.constData());
+    if (data.size() < HEADER_SIZE || std::memcmp(p, MAGIC, 4) != 0 ||
+            qFromLittleEndian<quint16>(p + 4) != FORMAT_VERSION || qFromLittleEndian<quint16>(p + 6) != record_size)
+        return false;
+    // a record cut by a crash is ignored
+    const int n = (data.size() - HEADER_SIZE)/record_size;
+    landmarks.resize(n);
+    for (int i = 0; i < n; ++i)
+        _decode(p + HEADER_SIZE + i*record_size, landmarks[i]);
+    return true;
+}
+
+void LandmarkStream::run()
+{
+    QByteArray buffer;
+    buffer.reserve(LANDMARK_STREAM_QUEUE_SIZE*record_size);
+    Landmarks landmarks;
+    bool failed = false;
+    while (true)
+    {
+        // the queue is drained once more after stopping is asked
+        const bool stopping = _stopping.loadAcquire() != 0;
+        buffer.resize(0);
+        while (_queue.pop(landmarks))
+        {
+            buffer.resize(buffer.size() + record_size);
+            _encode(landmarks, reinterpret_cast<uchar *>(buffer.data()) + buffer.size() - record_size);
+        }
+        if (!buffer.isEmpty() && _file.write(buffer) != buffer.size() && !failed)
+        {
+            failed = true;
+            emit writeFailed(_file.fileName());
+        }
+        if (stopping)
+            break;
+        msleep(LANDMARK_STREAM_FLUSH_INTERVAL);
+    }
+    _file.flush();
+}
+
+void LandmarkStream::_encode(const Landmarks &landmarks, uchar *record)
+{
+    std::memset(record, 0, record_size);
+    qToLittleEndian<quint32>(landmarks.frame_id, record);
+    qToLittleEndian<qint64>(landmarks.timestamp, record + 4);
+    record[12] = landmarks.detected ? 1 : 0;
+    record[13] = static_cast<uchar>(landmarks.finger_count);
+    qToLittleEndian<qint16>(landmarks.hand_center.x, record + 14);
+    qToLittleEndian<qint16>(landmarks.hand_center.y, record + 16);
+    quint32 radius;
+    std::memcpy(&radius, &landmarks.palm_radius, 4);
+    qToLittleEndian<quint32>(radius, record + 18);
+    qToLittleEndian<qint16>(landmarks.hand_bound.x, record + 22);
+    qToLittleEndian<qint16>(landmarks.hand_bound.y, record + 24);
+    qToLittleEndian<qint16>(landmarks.hand_bound.width, record + 26);
+    qToLittleEndian<qint16>(landmarks.hand_bound.height, record + 28);
+    for (int i = 0; i < landmarks.finger_count; ++i)
+    {
+        qToLittleEndian<qint16>(landmarks.fingers[i].x, record + 30 + 4*i);
+        qToLittleEndian<qint16>(landmarks.fingers[i].y, record + 32 + 4*i);
+    }
+}
+
+void LandmarkStream::_decode(const uchar *record, Landmarks &landmarks)
+{
+    landmarks.frame_id = qFromLittleEndian<quint32>(record);
+    landmarks.timestamp = qFromLittleEndian<qint64>(record + 4);
+    landmarks.detected = record[12] != 0;
+    landmarks.finger_count = std::min(static_cast<int>(record[13]), LANDMARK_MAX_FINGERS);
+    landmarks.hand_center = cv::Point(qFromLittleEndian<qint16>(record + 14), qFromLittleEndian<qint16>(record + 16));
+    const quint32 radius = qFromLittleEndian<quint32>(record + 18);
+    std::memcpy(&landmarks.palm_radius, &radius, 4);
+    landmarks.hand_bound = cv::Rect(qFromLittleEndian<qint16>(record + 22), qFromLittleEndian<qint16>(record + 24),
+                                    qFromLittleEndian<qint16>(record + 26), qFromLittleEndian<qint16>(record + 28));
+    for (int i = 0; i < LANDMARK_MAX_FINGERS; ++i)
+        landmarks.fingers[i] = i < landmarks.finger_count
+                ? cv::Point(qFromLittleEndian<qint16>(record + 30 + 4*i), qFromLittleEndian<qint16>(record + 32 + 4*i))
+                : cv::Point();
+}
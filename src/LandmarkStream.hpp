@@ -0,0 +1,161 @@
+#ifndef LANDMARKSTREAM_H
+#define LANDMARKSTREAM_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The LandmarkStream.hpp file contains the class appending the hand landmarks of each frame to a binary file.
+ */
+#include <QThread>
+#include <QAtomicInt>
+#include <QFile>
+#include <QString>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "config.h"
+#include "HandDetector.hpp"
+#include "SpscQueue.hpp"
+
+/**
+ * @brief The LandmarkStream class appends the hand geometry of each frame, with its frame id and timestamp,
+ *        to a compact binary file in its own thread, so that dynamic gestures can be analyzed later without images.
+ *
+ * #LandmarkStream::append is called by one thread, e.g. the one detecting hands, and never blocks: the landmarks
+ * are passed through a #SpscQueue of #LANDMARK_STREAM_QUEUE_SIZE frames, and dropped if the queue is full.
+ * The appender thread wakes every #LANDMARK_STREAM_FLUSH_INTERVAL milliseconds and writes the queued frames at once.
+ *
+ * The file starts with a header of 8 bytes, `GSLM`, the format version and the size of a record, both in 16-bit
+ * integers, followed by a record of #LandmarkStream::record_size bytes per frame. All numbers are little-endian.
+ *
+ * | offset | type          | field                                                  |
+ * |--------|---------------|--------------------------------------------------------|
+ * | 0      | uint32        | frame id                                               |
+ * | 4      | int64         | timestamp in milliseconds since epoch                  |
+ * | 12     | uint8         | 1 if a hand was detected, otherwise 0                  |
+ * | 13     | uint8         | number of finger tops stored                           |
+ * | 14     | int16 x 2     | palm center                                            |
+ * | 18     | float32       | palm radius                                            |
+ * | 22     | int16 x 4     | bounding rectangle of the hand, x, y, width and height |
+ * | 30     | int16 x 2 x 8 | finger tops, of which the unused ones are 0            |
+ * | 62     | uint16        | reserved, 0                                            |
+ *
+ * Coordinates are relative to the frame rather than the region of interesting.
+ *
+ * **ATTENTION**:
+ *  A stream should be opened, appended and closed by the same thread.
+ */
+class LandmarkStream : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The Landmarks struct is the hand geometry of a frame.
+     */
+    struct Landmarks
+    {
+        /**
+         * @brief frame_id is the index of the frame since the camera was opened.
+         */
+        quint32 frame_id = 0;
+        /**
+         * @brief timestamp is the time, in milliseconds since epoch, when the frame was captured.
+         */
+        qint64 timestamp = 0;
+        /**
+         * @brief detected is the flag if a hand was detected or not.
+         */
+        bool detected = false;
+        /**
+         * @brief finger_count is the number of finger tops stored, at most #LANDMARK_MAX_FINGERS .
+         */
+        int finger_count = 0;
+        /**
+         * @brief hand_center is the palm center.
+         */
+        cv::Point hand_center;
+        /**
+         * @brief palm_radius is the palm radius.
+         */
+        float palm_radius = 0;
+        /**
+         * @brief hand_bound is the bounding rectangle of the hand.
+         */
+        cv::Rect hand_bound;
+        /**
+         * @brief fingers are the finger tops.
+         */
+        cv::Point fingers[LANDMARK_MAX_FINGERS];
+    };
+    /**
+     * @brief record_size is the size of a record in bytes.
+     */
+    static const int record_size;
+
+    explicit LandmarkStream(QObject *parent = 0);
+    /**
+     * @brief ~LandmarkStream closes the stream.
+     */
+    ~LandmarkStream();
+
+    /**
+     * @brief open starts a stream. The stream opened previously is closed.
+     * @param file_path : path of the file, which is overwritten
+     * @retval true : successfully opened
+     * @retval false : failed to open the file
+     */
+    bool open(const QString &file_path);
+    /**
+     * @brief isOpen returns if a stream is opened.
+     */
+    bool isOpen() const;
+    /**
+     * @brief append queues the landmarks of a frame without blocking.
+     * @param frame_id : the index of the frame
+     * @param timestamp : the time, in milliseconds since epoch, when the frame was captured
+     * @param result : the detection result
+     * @param offset : the top left corner of the region of interesting, to which the result is relative
+     * @retval true : queued
+     * @retval false : no stream is opened, or the queue is full and the landmarks are dropped
+     */
+    bool append(const quint32 &frame_id, const qint64 &timestamp, const DetectionResult &result, const cv::Point &offset);
+    /**
+     * @brief close writes all queued landmarks and closes the stream.
+     */
+    void close();
+    /**
+     * @brief dropped returns the number of frames dropped since the stream was opened.
+     */
+    qint64 dropped() const;
+
+    /**
+     * @brief read reads a landmark stream.
+     * @param file_path : path of the file
+     * @param landmarks : the landmarks of all frames in the stream
+     * @retval true : successfully read
+     * @retval false : failed to read the file, or it is not a landmark stream of this version
+     */
+    static bool read(const QString &file_path, std::vector<Landmarks> &landmarks);
+
+signals:
+    /**
+     * @brief writeFailed is the signal emitted when the landmarks failed to be written.
+     * @param file_path : path of the file
+     */
+    void writeFailed(const QString &file_path);
+
+protected:
+    void run() override;
+
+private:
+    SpscQueue<Landmarks> _queue;
+    QAtomicInt _stopping;
+    QFile _file;
+    bool _open;
+    qint64 _dropped;
+
+    static void _encode(const Landmarks &landmarks, uchar *record);
+    static void _decode(const uchar *record, Landmarks &landmarks);
+};
+
+#endif // LANDMARKSTREAM_H
@@ -0,0 +1,80 @@
+#include "LogModel.hpp"
+
+#include <algorithm>
+
+LogModel::LogModel(const int &capacity) :
+    _entries(std::max(1, capacity)),
+    _head(0),
+    _size(0),
+    _dirty(false)
+{}
+
+void LogModel::append(const QString &text)
+{
+    _dirty = true;
+    if (_size > 0 && _last().text == text)
+    {
+        ++_last().count;
+        return;
+    }
+    if (_size < _entries.size())
+        ++_size;
+    else
+        _head = (_head + 1) % _entries.size();
+    Entry &e = _last();
+    e.text = text;
+    e.count = 1;
+}
+
+void LogModel::replaceLast(const QString &text)
+{
+    if (_size == 0)
+    {
+        append(text);
+        return;
+    }
+    _dirty = true;
+    Entry &e = _last();
+    e.text = text;
+    e.count = 1;
+}
+
+void LogModel::clear()
+{
+    for (auto &e : _entries)
+        e.text.clear();
+    _head = 0;
+    _size = 0;
+    _dirty = true;
+}
+
+int LogModel::size() const
+{
+    return _size;
+}
+
+bool LogModel::dirty() const
+{
+    return _dirty;
+}
+
+QString LogModel::text()
+{
+    _dirty = false;
+    QString text;
+    for (auto i = 0; i < _size; ++i)
+    {
+        const Entry &e = _entries.at((_head + i) % _entries.size());
+        if (i > 0)
+            text += '\n';
+        text += e.text;
+        if (e.count > 1)
+            text += QString(" %1%2").arg(QChar(0x00D7)).arg(e.count);
+    }
+    return text;
+}
+
+LogModel::Entry &LogModel::_last()
+{
+    return _entries[(_head + _size - 1) % _entries.size()];
+}
@@ -0,0 +1,80 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The LogModel.hpp file contains the bounded buffer of the messages shown on the text panel of the main window.
+ */
+#include <QString>
+#include <QVector>
+
+#include "config.h"
+
+/**
+ * @brief The LogModel class keeps the latest messages logged in a ring buffer of fixed capacity.
+ *
+ * A message identical to the last one is not stored again but counted, and rendered as "message ×42",
+ * so that a message repeated on every frame takes one entry. Once the buffer is full, the oldest message is dropped.
+ * Thereby, the memory and the cost of rendering the log are bounded by the capacity however long it runs.
+ *
+ * The model only tracks if it was changed since #LogModel::text was called last time. Showing it is up to the caller,
+ * e.g. #MainView repaints its text panel at most every #LOG_FLUSH_INTERVAL milliseconds.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ */
+class LogModel
+{
+public:
+    /**
+     * @brief LogModel is the constructor.
+     * @param capacity : the maximum number of messages kept, at least 1
+     */
+    explicit LogModel(const int &capacity = LOG_MAX_ENTRIES);
+
+    /**
+     * @brief append logs a message, or counts it if identical to the last one.
+     * @param text : the message, which may contain multiple lines
+     */
+    void append(const QString &text);
+    /**
+     * @brief replaceLast replaces the last message, or logs the given one if nothing was logged.
+     *
+     * It is used for progress messages updated in place.
+     *
+     * @param text : the new message
+     */
+    void replaceLast(const QString &text);
+    /**
+     * @brief clear removes all messages.
+     */
+    void clear();
+    /**
+     * @brief size returns the number of messages kept.
+     */
+    int size() const;
+    /**
+     * @brief dirty returns if the messages were changed since #LogModel::text was called last time.
+     */
+    bool dirty() const;
+    /**
+     * @brief text renders the messages kept, from the oldest to the latest, one per line, and clears the dirty flag.
+     */
+    QString text();
+
+private:
+    struct Entry
+    {
+        QString text;
+        int count;
+    };
+
+    Entry &_last();
+
+    QVector<Entry> _entries;
+    int _head;
+    int _size;
+    bool _dirty;
+};
+
+#endif // LOGMODEL_H
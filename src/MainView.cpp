@@ -26,48 +26,73 @@ MainView::MainView(QWidget *parent) :
 
 void MainView::updateVideoFrame(const QPixmap &img)
 {
-    _ui_lbl_video->setPixmap(
-                img.scaled(_ui_lbl_video->width(),
-                           _ui_lbl_video->height(),
-                           Qt::KeepAspectRatio)
-                );
+    _ui_video->setFrame(img);
+}
+
+void MainView::updateVideoOverlay(const QSize &frame_size, const QRect &roi, const DetectionResult &result)
+{
+    _ui_video->setOverlay(frame_size, roi, result, roi.topLeft());
+}
+
+void MainView::updateHud(const QString &text)
+{
+    _ui_video->setHud(text);
 }
 
 int MainView::getVideoFrameWidth()
 {
-    return _ui_lbl_video->width();
+    return _ui_video->width();
 }
 
 int MainView::getVideoFrameHeight()
 {
-    return _ui_lbl_video->height();
+    return _ui_video->height();
+}
+
+QSize MainView::getVideoFrameSize()
+{
+    return _ui_video->size();
 }
 
 void MainView::appendText(const QString &text)
 {
-    _ui_txt_panel->appendPlainText(text);
+    _log.append(text);
+    _scheduleTextFlush();
 }
 
 void MainView::updateText(const QString &new_text)
 {
-    QTextCursor cursor = _ui_txt_panel->textCursor();
-    _ui_txt_panel->moveCursor(QTextCursor::End, QTextCursor::MoveAnchor);
-    _ui_txt_panel->moveCursor(QTextCursor::StartOfLine, QTextCursor::MoveAnchor);
-    _ui_txt_panel->moveCursor(QTextCursor::End, QTextCursor::KeepAnchor);
-    _ui_txt_panel->textCursor().removeSelectedText();
-    _ui_txt_panel->textCursor().deletePreviousChar();
-    _ui_txt_panel->setTextCursor(cursor);
-    _ui_txt_panel->appendPlainText(new_text);
+    _log.replaceLast(new_text);
+    _scheduleTextFlush();
 }
 
 void MainView::clearText()
 {
-    _ui_txt_panel->clear();
+    _log.clear();
+    _scheduleTextFlush();
 }
 
 void MainView::setText(const QString &text)
 {
-    _ui_txt_panel->setPlainText(text);
+    _log.clear();
+    _log.append(text);
+    _scheduleTextFlush();
+}
+
+void MainView::_scheduleTextFlush()
+{
+    // messages logged until the timer times out are shown by one repaint
+    if (!_log_timer->isActive())
+        _log_timer->start();
+}
+
+void MainView::_flushText()
+{
+    if (!_log.dirty())
+        return;
+    _ui_txt_panel->setPlainText(_log.text());
+    _ui_txt_panel->moveCursor(QTextCursor::End);
+    _ui_txt_panel->ensureCursorVisible();
 }
 
 void MainView::reloadLabelList()
@@ -160,14 +185,17 @@ void MainView::closeEvent(QCloseEvent *e)
 
 void MainView::_setupUI()
 {
-    _ui_lbl_video = new QLabel;
-    _ui_lbl_video->setFixedSize(640, 480);
-    _ui_lbl_video->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+    _ui_video = new VideoWidget;
+    _ui_video->setFixedSize(640, 480);
+    _ui_video->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
 
     _ui_txt_panel = new QPlainTextEdit;
     _ui_txt_panel->setFixedSize(250, 300);
     _ui_txt_panel->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
     _ui_txt_panel->setReadOnly(true);
+    _log_timer = new QTimer(this);
+    _log_timer->setSingleShot(true);
+    _log_timer->setInterval(LOG_FLUSH_INTERVAL);
 
     _ui_btn_start = new QPushButton(tr("Launch Camera"));
     _ui_btn_monitor = new QPushButton(tr("Monitor"));
@@ -215,7 +243,7 @@ void MainView::_setupUI()
     QGridLayout *main_layout = new QGridLayout;
     main_layout->setContentsMargins(20, 20, 20, 20);
     main_layout->setSpacing(20);
-    main_layout->addWidget(_ui_lbl_video,   0, 0, 4, 1, Qt::AlignCenter);
+    main_layout->addWidget(_ui_video,       0, 0, 4, 1, Qt::AlignCenter);
     main_layout->addWidget(_ui_txt_panel,   0, 1, 1, 2);
     main_layout->addWidget(_ui_btn_start,   1, 1, 1, 1);
     main_layout->addLayout(ui_sample_form,  2, 1, 1, 2);
@@ -236,4 +264,5 @@ void MainView::_makeConnections()
     connect(_ui_btn_start, SIGNAL(released()), this, SLOT(_uiBtnStartReleased()));
     connect(_ui_btn_choose_sample_folder, SIGNAL(released()), this, SLOT(_uiBtnChooseSampleDirReleased()));                              
     connect(_ui_txt_sample_dir, SIGNAL(textChanged(QString)), this, SLOT(_uiTxtSampleDirChanged(QString)));
+    connect(_log_timer, SIGNAL(timeout()), this, SLOT(_flushText()));
 }
@@ -18,9 +18,13 @@
 #include <QFileInfo>
 #include <QString>
 #include <QCloseEvent>
+#include <QTimer>
 
 #include "Singleton.hpp"
 #include "Settings.hpp"
+#include "CvQtImgConvertor.hpp"
+#include "VideoWidget.hpp"
+#include "LogModel.hpp"
 /**
  * @brief The MainView class provides the GUI of the main window.
  * 
@@ -54,27 +58,56 @@ public:
     static MainView *getInstance();
 
     /**
-     * @brief updateVideoFrame displays the given image on the video label widget.
+     * @brief updateVideoFrame displays the given image on the video widget.
      *
-     * The given image will be sacled according to the size of the widget to display the video.
+     * The given image will be sacled according to the size of the widget to display the video,
+     * unless it fits the size returned by #MainView::getVideoFrameSize already.
      *
      * @param img : image of the current video frame
+     *
+     * @see #MainView::updateVideoOverlay
      */
     void updateVideoFrame(const QPixmap &img);
     /**
-     * @brief getVideoFrameWidth returns the width of the label showing the video frame.
-     * @return the width, in pixel, of the label showing the video frame
+     * @brief updateVideoOverlay draws the region of interesting and the detected hand over the video.
+     * @param frame_size : size of the frame in which the coordinates are given
+     * @param roi : the region of interesting
+     * @param result : the hand geometry detected in the region of interesting
+     *
+     * @see #VideoWidget
+     */
+    void updateVideoOverlay(const QSize &frame_size, const QRect &roi, const DetectionResult &result);
+    /**
+     * @brief updateHud updates the performance HUD drawn over the video.
+     * @param text : the text of the HUD, which hides the HUD if empty
+     */
+    void updateHud(const QString &text);
+    /**
+     * @brief getVideoFrameWidth returns the width of the widget showing the video frame.
+     * @return the width, in pixel, of the widget showing the video frame
      * @see #MainView::getVideoFrameHeight
      */
     int getVideoFrameWidth();
     /**
-     * @brief getVideoFrameHeight returns the height of the label showing the video frame.
-     * @return the height, in pixel, of the label showing the video frame
+     * @brief getVideoFrameHeight returns the height of the widget showing the video frame.
+     * @return the height, in pixel, of the widget showing the video frame
      * @see #MainView::getVideoFrameWidth
      */
     int getVideoFrameHeight();
+    /**
+     * @brief getVideoFrameSize returns the size of the widget showing the video frame.
+     *
+     * Frames resized to this size before converted, e.g. by #CvQtImgConvertor::cvMat2QPixmap , are shown without scaling.
+     *
+     * @return the size, in pixel, of the widget showing the video frame
+     */
+    QSize getVideoFrameSize();
     /**
      * @brief appendText adds text on the text panel in a new line.
+     *
+     * The text panel keeps the latest #LOG_MAX_ENTRIES messages only, shows a message repeated in a row once
+     * with the number of repetitions, and is repainted at most every #LOG_FLUSH_INTERVAL milliseconds.
+     *
      * @param text : text that will be added onto the text panel
      *
      * @see #MainView::updateText
@@ -193,6 +226,7 @@ private slots:
     void _uiBtnStartReleased();
     void _uiBtnChooseSampleDirReleased();
     void _uiTxtSampleDirChanged(const QString &dir);
+    void _flushText();
 
 private:
     explicit MainView(QWidget *parent=0);
@@ -206,11 +240,14 @@ private:
 
     inline void _setupUI();
     inline void _makeConnections();
+    void _scheduleTextFlush();
     QPushButton *_ui_btn_start;
     QPushButton *_ui_btn_monitor;
     QPushButton *_ui_btn_settings;
-    QLabel      *_ui_lbl_video;
+    VideoWidget *_ui_video;
     QPlainTextEdit *_ui_txt_panel;
+    LogModel _log;
+    QTimer *_log_timer;
     QPushButton *_ui_btn_edit_gesture_list;
     QPushButton *_ui_btn_choose_sample_folder;
     QComboBox   *_ui_box_gesture_list;
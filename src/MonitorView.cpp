@@ -14,11 +14,10 @@ MonitorView::MonitorView(QWidget *parent) : QDialog(parent)
 {
     _ui_lbl_image1 = new QLabel;
     _ui_lbl_image2 = new QLabel;
-    _ui_lbl_image3 = new QLabel;
+    _ui_video_image3 = new VideoWidget;
     _ui_lbl_text   = new QLabel;
     _ui_lbl_image1->setAlignment(Qt::AlignCenter);
     _ui_lbl_image2->setAlignment(Qt::AlignCenter);
-    _ui_lbl_image3->setAlignment(Qt::AlignCenter);
     _ui_lbl_text->setAlignment(Qt::AlignLeft | Qt::AlignTop);
 
     QGridLayout * main_layout = new QGridLayout;
@@ -26,7 +25,7 @@ MonitorView::MonitorView(QWidget *parent) : QDialog(parent)
     main_layout->setSpacing(10);
     main_layout->addWidget(_ui_lbl_image1, 0, 0, 1, 1);
     main_layout->addWidget(_ui_lbl_image2, 0, 1, 1, 1);
-    main_layout->addWidget(_ui_lbl_image3, 1, 0, 1, 1);
+    main_layout->addWidget(_ui_video_image3, 1, 0, 1, 1);
     main_layout->addWidget(_ui_lbl_text, 1, 1, 1, 1);
 
     setLayout(main_layout);
@@ -35,67 +34,51 @@ MonitorView::MonitorView(QWidget *parent) : QDialog(parent)
     setMinimumSize(200, 200);
 }
 
+QSize MonitorView::getMonitorImageSize(const int &position)
+{
+    switch (position)
+    {
+    case 1:
+        return _ui_lbl_image1->size();
+    case 2:
+        return _ui_lbl_image2->size();
+    case 3:
+        return _ui_video_image3->size();
+    default:
+        return _ui_lbl_text->size();
+    }
+}
+
 void MonitorView::updateMonitorImage4(const QPixmap &image1,
                                      const QPixmap &image2,
                                      const QPixmap &image3,
                                      const QPixmap &image4)
 {
-    _ui_lbl_image1->setPixmap(image1.scaled(
-                                  _ui_lbl_image1->width(),
-                                  _ui_lbl_image1->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image2->setPixmap(image2.scaled(
-                                  _ui_lbl_image2->width(),
-                                  _ui_lbl_image2->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image3->setPixmap(image3.scaled(
-                                  _ui_lbl_image3->width(),
-                                  _ui_lbl_image3->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_text->setPixmap(image4.scaled(
-                                  _ui_lbl_text->width(),
-                                  _ui_lbl_text->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
+    _ui_lbl_image1->setPixmap(CvQtImgConvertor::fitPixmap(image1, _ui_lbl_image1->size()));
+    _ui_lbl_image2->setPixmap(CvQtImgConvertor::fitPixmap(image2, _ui_lbl_image2->size()));
+    _ui_video_image3->setFrame(image3);
+    _ui_lbl_text->setPixmap(CvQtImgConvertor::fitPixmap(image4, _ui_lbl_text->size()));
 }
 
 void MonitorView::updateMonitorImage3(const QPixmap &image1,
                                      const QPixmap &image2,
                                      const QPixmap &image3)
 {
-    _ui_lbl_image1->setPixmap(image1.scaled(
-                                  _ui_lbl_image1->width(),
-                                  _ui_lbl_image1->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image2->setPixmap(image2.scaled(
-                                  _ui_lbl_image2->width(),
-                                  _ui_lbl_image2->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image3->setPixmap(image3.scaled(
-                                  _ui_lbl_image3->width(),
-                                  _ui_lbl_image3->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
+    _ui_lbl_image1->setPixmap(CvQtImgConvertor::fitPixmap(image1, _ui_lbl_image1->size()));
+    _ui_lbl_image2->setPixmap(CvQtImgConvertor::fitPixmap(image2, _ui_lbl_image2->size()));
+    _ui_video_image3->setFrame(image3);
 }
 
 void MonitorView::updateMonitorImage2(const QPixmap &image1, const QPixmap &image2)
 {
-    _ui_lbl_image1->setPixmap(image1.scaled(
-                                  _ui_lbl_image1->width(),
-                                  _ui_lbl_image1->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image2->setPixmap(image2.scaled(
-                                  _ui_lbl_image2->width(),
-                                  _ui_lbl_image2->height(),
-                                  Qt::KeepAspectRatio
-                                  ));
-    _ui_lbl_image3->clear();
+    _ui_lbl_image1->setPixmap(CvQtImgConvertor::fitPixmap(image1, _ui_lbl_image1->size()));
+    _ui_lbl_image2->setPixmap(CvQtImgConvertor::fitPixmap(image2, _ui_lbl_image2->size()));
+    _ui_video_image3->clear();
+}
+
+void MonitorView::updateMonitorOverlay(const QSize &frame_size, const DetectionResult &result)
+{
+    _ui_video_image3->setOverlay(frame_size, QRect(), result);
 }
 
 void MonitorView::setMsg(const QString &text)
@@ -107,7 +90,7 @@ void MonitorView::closeEvent(QCloseEvent * e)
 {
     _ui_lbl_image1->clear();
     _ui_lbl_image2->clear();
-    _ui_lbl_image3->clear();
+    _ui_video_image3->clear();
     _ui_lbl_text->clear();
     e->accept();
 }
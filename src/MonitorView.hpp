@@ -13,12 +13,15 @@
 #include <QCloseEvent>
 #include <iostream>
 #include "Singleton.hpp"
+#include "CvQtImgConvertor.hpp"
+#include "VideoWidget.hpp"
 
 /**
  * @brief The MonitorView class provides the GUI of the monitor window
  *
  * The monitor window will displays three images as the monitor. \n
  * The three images will be displayed on the left-top, right-top and left-bottom region of the window.\n
+ * The hand geometry is drawn over the left-bottom image, or over a white canvas if the image is null.\n
  * The right-bottom region is used to display text information.
  *
  * This is a singleton class. Use #Monitor::getInstance() to get the instance of this class.
@@ -35,6 +38,16 @@ public:
      * @see #Singleton
      */
     static MonitorView *getInstance();
+    /**
+     * @brief getMonitorImageSize returns the size of the region displaying an image.
+     *
+     * Images resized to this size before converted, e.g. by #CvQtImgConvertor::cvMat2QPixmap , are shown without scaling.
+     * Otherwise, images are scaled to fit the region.
+     *
+     * @param position : 1 for the left-top, 2 for the right-top, 3 for the left-bottom and 4 for the right-bottom region
+     * @return the size, in pixel, of the region
+     */
+    QSize getMonitorImageSize(const int &position);
     /**
      * @brief updateMonitorImage3 displays three images on the monitor window.
      * @param image1 : left-top corner image
@@ -59,6 +72,14 @@ public:
      * @param image2 : right-top corner image
      */
     void updateMonitorImage2(const QPixmap &image1, const QPixmap &image2);
+    /**
+     * @brief updateMonitorOverlay draws the detected hand over the left-bottom image.
+     * @param frame_size : size of the image in which the coordinates are given
+     * @param result : the hand geometry
+     *
+     * @see #VideoWidget
+     */
+    void updateMonitorOverlay(const QSize &frame_size, const DetectionResult &result);
     /**
      * @brief setmsg shows the given text on the message region.
      * @param text : text that will be shown
@@ -75,7 +96,7 @@ private:
 
     QLabel * _ui_lbl_image1;
     QLabel * _ui_lbl_image2;
-    QLabel * _ui_lbl_image3;
+    VideoWidget * _ui_video_image3;
     QLabel * _ui_lbl_text;
 
 };
@@ -0,0 +1,50 @@
+#include "MotionGate.hpp"
+
+#include <algorithm>
+
+MotionGate::MotionGate(const double &threshold, const int &refresh) :
+    _threshold(threshold),
+    _refresh(std::max(0, refresh)),
+    _unchanged(0)
+{}
+
+bool MotionGate::changed(const cv::Mat &img)
+{
+    if (_threshold <= 0 || img.empty())
+        return true;
+
+    // downsample before the color conversion, which is then performed on a few thousands of pixels only
+    const int width = std::min(img.cols, MOTION_GATE_WIDTH);
+    cv::resize(img, _thumb, cv::Size(width, std::max(1, img.rows*width/img.cols)), 0, 0, cv::INTER_AREA);
+    cv::cvtColor(_thumb, _thumb, cv::COLOR_BGR2GRAY);
+
+    if (_reference.empty() || img.size() != _size || _unchanged >= _refresh)
+    {
+        _size = img.size();
+        _thumb.copyTo(_reference);
+        _unchanged = 0;
+        return true;
+    }
+
+    // the area interpolation averages each block into one pixel
+    cv::absdiff(_thumb, _reference, _diff);
+    cv::resize(_diff, _diff,
+               cv::Size(std::max(1, _diff.cols/MOTION_GATE_BLOCK_SIZE), std::max(1, _diff.rows/MOTION_GATE_BLOCK_SIZE)),
+               0, 0, cv::INTER_AREA);
+    double max;
+    cv::minMaxLoc(_diff, nullptr, &max);
+    if (max > _threshold)
+    {
+        _thumb.copyTo(_reference);
+        _unchanged = 0;
+        return true;
+    }
+    ++_unchanged;
+    return false;
+}
+
+void MotionGate::reset()
+{
+    _reference.release();
+    _unchanged = 0;
+}
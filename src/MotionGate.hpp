@@ -0,0 +1,61 @@
+#ifndef MOTIONGATE_H
+#define MOTIONGATE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The MotionGate.hpp file contains the class telling if a scene changed enough to be worth detecting again.
+ */
+#include <opencv2/opencv.hpp>
+
+#include "config.h"
+
+/**
+ * @brief The MotionGate class tells if an image differs from the one on which hands were detected last time.
+ *
+ * The image is downsampled to #MOTION_GATE_WIDTH pixels wide in gray scale and compared block by block, of
+ * #MOTION_GATE_BLOCK_SIZE x #MOTION_GATE_BLOCK_SIZE pixels, with the reference image. The image is considered
+ * changed if the mean absolute difference of any block is above the threshold, so that a moving finger is not
+ * averaged out by a still background. Comparing costs a fraction of a detection.
+ *
+ * The reference is the last image considered changed rather than the previous image, so that a slow motion below
+ * the threshold between two frames still adds up. At most a given number of images in a row are considered unchanged.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ */
+class MotionGate
+{
+public:
+    /**
+     * @brief MotionGate is the constructor.
+     * @param threshold : the mean absolute difference of a block in gray levels, or a nonpositive value to disable the gate
+     * @param refresh : the maximum number of images in a row considered unchanged
+     */
+    explicit MotionGate(const double &threshold = MOTION_GATE_THRESHOLD, const int &refresh = MOTION_GATE_REFRESH_FRAMES);
+
+    /**
+     * @brief changed compares the given image with the reference, and takes it as the reference if changed.
+     * @param img : an image of type `CV_8UC3` in BGR color space
+     * @retval true : the image differs from the reference, or has a different size, or no reference is taken,
+     *                or too many images were unchanged in a row, or the gate is disabled
+     * @retval false : the image is about the same as the reference
+     */
+    bool changed(const cv::Mat &img);
+    /**
+     * @brief reset drops the reference, so that the next image is considered changed.
+     *
+     * It is called when hands are detected on an image without asking the gate.
+     */
+    void reset();
+
+private:
+    double _threshold;
+    int _refresh;
+    int _unchanged;
+    cv::Size _size;
+    cv::Mat _thumb;
+    cv::Mat _reference;
+    cv::Mat _diff;
+};
+
+#endif // MOTIONGATE_H
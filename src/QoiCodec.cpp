@@ -0,0 +1,228 @@
+#include "QoiCodec.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+namespace
+{
+    const uchar QOI_MAGIC[4] = {'q', 'o', 'i', 'f'};
+    const uchar QOI_END_MARKER[8] = {0, 0, 0, 0, 0, 0, 0, 1};
+    const size_t QOI_HEADER_SIZE = 14;
+    // refuse to decode absurd dimensions from a corrupted header
+    const size_t QOI_MAX_PIXELS = 400000000;
+
+    enum QOI_OP
+    {
+        QOI_OP_INDEX = 0x00,
+        QOI_OP_DIFF = 0x40,
+        QOI_OP_LUMA = 0x80,
+        QOI_OP_RUN = 0xC0,
+        QOI_OP_RGB = 0xFE,
+        QOI_OP_RGBA = 0xFF,
+        QOI_MASK = 0xC0
+    };
+
+    struct Pixel
+    {
+        uchar r, g, b, a;
+        bool operator==(const Pixel &p) const
+        {
+            return r == p.r && g == p.g && b == p.b && a == p.a;
+        }
+        bool operator!=(const Pixel &p) const
+        {
+            return !(*this == p);
+        }
+    };
+
+    inline int hash(const Pixel &p)
+    {
+        return (p.r*3 + p.g*5 + p.b*7 + p.a*11) % 64;
+    }
+
+    inline void putBE32(std::vector<uchar> &buffer, const uint32_t &v)
+    {
+        buffer.push_back(static_cast<uchar>(v >> 24));
+        buffer.push_back(static_cast<uchar>(v >> 16));
+        buffer.push_back(static_cast<uchar>(v >> 8));
+        buffer.push_back(static_cast<uchar>(v));
+    }
+
+    inline uint32_t getBE32(const uchar *p)
+    {
+        return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | uint32_t(p[3]);
+    }
+}
+
+bool QoiCodec::isQoi(const uchar *data, const size_t &size)
+{
+    return size >= QOI_HEADER_SIZE && std::memcmp(data, QOI_MAGIC, sizeof(QOI_MAGIC)) == 0;
+}
+
+bool QoiCodec::encode(const cv::Mat &img, std::vector<uchar> &buffer)
+{
+    const int channels = img.channels();
+    if (img.empty() || img.depth() != CV_8U || (channels != 3 && channels != 4))
+        return false;
+
+    buffer.clear();
+    // the worst case is one RGB(A) op per pixel
+    buffer.reserve(QOI_HEADER_SIZE + img.total()*(channels + 1) + sizeof(QOI_END_MARKER));
+    buffer.insert(buffer.end(), QOI_MAGIC, QOI_MAGIC + sizeof(QOI_MAGIC));
+    putBE32(buffer, img.cols);
+    putBE32(buffer, img.rows);
+    buffer.push_back(static_cast<uchar>(channels));
+    buffer.push_back(0); // sRGB with linear alpha
+
+    Pixel index[64];
+    std::memset(index, 0, sizeof(index));
+    Pixel prev = {0, 0, 0, 255};
+    int run = 0;
+    for (int y = 0; y < img.rows; ++y)
+    {
+        const uchar *p = img.ptr<uchar>(y);
+        for (int x = 0; x < img.cols; ++x, p += channels)
+        {
+            // OpenCV stores BGR while QOI stores RGB
+            Pixel px = {p[2], p[1], p[0], channels == 4 ? p[3] : static_cast<uchar>(255)};
+            if (px == prev)
+            {
+                if (++run == 62)
+                {
+                    buffer.push_back(QOI_OP_RUN | (run - 1));
+                    run = 0;
+                }
+                continue;
+            }
+            if (run > 0)
+            {
+                buffer.push_back(QOI_OP_RUN | (run - 1));
+                run = 0;
+            }
+
+            const int h = hash(px);
+            if (index[h] == px)
+                buffer.push_back(QOI_OP_INDEX | h);
+            else
+            {
+                index[h] = px;
+                if (px.a == prev.a)
+                {
+                    const signed char vr = static_cast<signed char>(px.r - prev.r);
+                    const signed char vg = static_cast<signed char>(px.g - prev.g);
+                    const signed char vb = static_cast<signed char>(px.b - prev.b);
+                    const signed char vg_r = static_cast<signed char>(vr - vg);
+                    const signed char vg_b = static_cast<signed char>(vb - vg);
+                    if (vr > -3 && vr < 2 && vg > -3 && vg < 2 && vb > -3 && vb < 2)
+                        buffer.push_back(QOI_OP_DIFF | ((vr + 2) << 4) | ((vg + 2) << 2) | (vb + 2));
+                    else if (vg_r > -9 && vg_r < 8 && vg > -33 && vg < 32 && vg_b > -9 && vg_b < 8)
+                    {
+                        buffer.push_back(QOI_OP_LUMA | (vg + 32));
+                        buffer.push_back(((vg_r + 8) << 4) | (vg_b + 8));
+                    }
+                    else
+                    {
+                        buffer.push_back(QOI_OP_RGB);
+                        buffer.push_back(px.r);
+                        buffer.push_back(px.g);
+                        buffer.push_back(px.b);
+                    }
+                }
+                else
+                {
+                    buffer.push_back(QOI_OP_RGBA);
+                    buffer.push_back(px.r);
+                    buffer.push_back(px.g);
+                    buffer.push_back(px.b);
+                    buffer.push_back(px.a);
+                }
+            }
+            prev = px;
+        }
+    }
+    if (run > 0)
+        buffer.push_back(QOI_OP_RUN | (run - 1));
+    buffer.insert(buffer.end(), QOI_END_MARKER, QOI_END_MARKER + sizeof(QOI_END_MARKER));
+    return true;
+}
+
+bool QoiCodec::decode(const uchar *data, const size_t &size, cv::Mat &img)
+{
+    if (!isQoi(data, size) || size < QOI_HEADER_SIZE + sizeof(QOI_END_MARKER))
+        return false;
+    const uint32_t width = getBE32(data + 4);
+    const uint32_t height = getBE32(data + 8);
+    const int channels = data[12];
+    if (width == 0 || height == 0 || (channels != 3 && channels != 4) ||
+        static_cast<size_t>(width)*height > QOI_MAX_PIXELS)
+        return false;
+
+    img.create(height, width, CV_MAKETYPE(CV_8U, channels));
+    Pixel index[64];
+    std::memset(index, 0, sizeof(index));
+    Pixel px = {0, 0, 0, 255};
+    int run = 0;
+    size_t pos = QOI_HEADER_SIZE;
+    const size_t chunks_end = size - sizeof(QOI_END_MARKER);
+    for (int y = 0; y < img.rows; ++y)
+    {
+        uchar *p = img.ptr<uchar>(y);
+        for (int x = 0; x < img.cols; ++x, p += channels)
+        {
+            if (run > 0)
+                --run;
+            else
+            {
+                if (pos >= chunks_end)
+                    return false;
+                const uchar b1 = data[pos++];
+                if (b1 == QOI_OP_RGB)
+                {
+                    if (pos + 3 > chunks_end)
+                        return false;
+                    px.r = data[pos];
+                    px.g = data[pos + 1];
+                    px.b = data[pos + 2];
+                    pos += 3;
+                }
+                else if (b1 == QOI_OP_RGBA)
+                {
+                    if (pos + 4 > chunks_end)
+                        return false;
+                    px.r = data[pos];
+                    px.g = data[pos + 1];
+                    px.b = data[pos + 2];
+                    px.a = data[pos + 3];
+                    pos += 4;
+                }
+                else if ((b1 & QOI_MASK) == QOI_OP_INDEX)
+                    px = index[b1];
+                else if ((b1 & QOI_MASK) == QOI_OP_DIFF)
+                {
+                    px.r += ((b1 >> 4) & 0x03) - 2;
+                    px.g += ((b1 >> 2) & 0x03) - 2;
+                    px.b += (b1 & 0x03) - 2;
+                }
+                else if ((b1 & QOI_MASK) == QOI_OP_LUMA)
+                {
+                    if (pos >= chunks_end)
+                        return false;
+                    const uchar b2 = data[pos++];
+                    const int vg = (b1 & 0x3F) - 32;
+                    px.r += vg - 8 + ((b2 >> 4) & 0x0F);
+                    px.g += vg;
+                    px.b += vg - 8 + (b2 & 0x0F);
+                }
+                else
+                    run = b1 & 0x3F;
+                index[hash(px)] = px;
+            }
+            p[0] = px.b;
+            p[1] = px.g;
+            p[2] = px.r;
+            if (channels == 4)
+                p[3] = px.a;
+        }
+    }
+    return std::memcmp(data + chunks_end, QOI_END_MARKER, sizeof(QOI_END_MARKER)) == 0;
+}
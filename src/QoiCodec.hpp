@@ -0,0 +1,49 @@
+#ifndef QOICODEC_H
+#define QOICODEC_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The QoiCodec.hpp file contains the encoder and decoder of the QOI image format.
+ */
+#include <cstddef>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+/**
+ * @brief The QoiCodec class encodes and decodes images in the QOI ("Quite OK Image") format.
+ *
+ * QOI is a lossless format whose encoding is a single pass over the pixels with a 64-entry color cache,
+ * several times faster than PNG at a slightly lower compression ratio.
+ * It is not supported by OpenCV, so that this in-tree codec is used to store original sample images.
+ *
+ * The file consists of a 14-byte header, "qoif", width and height (big-endian uint32), channels and colorspace,
+ * followed by the encoded pixels and an 8-byte end marker.
+ */
+class QoiCodec
+{
+public:
+    /**
+     * @brief encode encodes an image.
+     * @param img : a BGR or BGRA image with 8 bits per channel
+     * @param buffer : the encoded file content
+     * @retval true : successfully encoded
+     * @retval false : the image is empty or in an unsupported type
+     */
+    static bool encode(const cv::Mat &img, std::vector<uchar> &buffer);
+    /**
+     * @brief decode decodes a QOI file.
+     * @param data : the file content
+     * @param size : size of the file content in bytes
+     * @param img : the decoded BGR or BGRA image
+     * @retval true : successfully decoded
+     * @retval false : the content is not a valid QOI file
+     */
+    static bool decode(const uchar *data, const size_t &size, cv::Mat &img);
+    /**
+     * @brief isQoi tells if the given content starts with the QOI magic.
+     */
+    static bool isQoi(const uchar *data, const size_t &size);
+};
+
+#endif // QOICODEC_H
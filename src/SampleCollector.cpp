@@ -1,5 +1,12 @@
 #include "SampleCollector.hpp"
 
+#include <QFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include "DatasetReader.hpp"
+
 // const cv::Size SampleCollector::sample_image_size(SAMPLE_SIZE_WIDTH,SAMPLE_SIZE_HEIGHT);
 const char *SampleCollector::orig_image_format = SAMPLE_ORIG_FORMAT;
 const char *SampleCollector::proc_image_format = SAMPLE_PROC_FORMAT;
@@ -7,13 +14,18 @@ const char *SampleCollector::proc_image_format = SAMPLE_PROC_FORMAT;
 SampleCollector::SampleCollector(QObject *parent) :
     QObject(parent),
     storage_path(_storage_path),
-    _sampling_timer(new QTimer),
     _settings(Settings::getInstance()),
+    _manifest(new SampleManifest),
+    _writer(new SampleWriter),
     _storage_dir(nullptr),
     _storage_dir_orig(nullptr),
-    _storage_dir_proc(nullptr)
+    _storage_dir_proc(nullptr),
+    _dedup_distance(0),
+    _hash_index(nullptr),
+    _skipped(0),
+    _duplicates(0)
 {
-    _sampling_timer->setSingleShot(true);
+    connect(_writer, SIGNAL(writeFailed(QString)), this, SIGNAL(storageFailed(QString)));
 }
 
 SampleCollector::~SampleCollector()
@@ -24,44 +36,21 @@ SampleCollector::~SampleCollector()
         delete _storage_dir_orig;
     if (_storage_dir_proc != nullptr)
         delete _storage_dir_proc;
-    delete _sampling_timer;
-}
-
-// cv::Mat SampleCollector::resizeSample(const cv::Mat &sample)
-// {
-//     if (sample.empty() || (sample.rows == sample_image_size.height && sample.cols == sample_image_size.width))
-//         return cv::Mat(sample);
-
-//     cv::Mat result(sample_image_size, CV_8UC1);
-//     float scale_x = (float)sample_image_size.width/sample.cols;
-//     float scale_y = (float)sample_image_size.height/sample.rows;
-//     if (scale_x == scale_y)
-//     {
-//         cv::resize(sample, result, sample_image_size, 0, 0, cv::INTER_LINEAR);
-//         return result;
-//     }
-
-//     result.setTo(cv::Scalar(0));
-//     int x = 0, y = 0;
-//     cv::Size size;
-//     if (scale_x < scale_y)
-//     {
-//         size.width = sample_image_size.width;
-//         size.height = std::ceil(sample.rows*scale_x);
-//         y = (sample_image_size.height-size.height)/2;
-//     }
-//     else
-//     {
-//         size.height = sample_image_size.height;
-//         size.width  = std::ceil(sample.cols*scale_y);
-//         x = (sample_image_size.width-size.width)/2;
-//     }
-//     cv::Mat tmp;
-//     cv::resize(sample, tmp, size, 0, 0, cv::INTER_LINEAR);
-//     tmp.copyTo(result(cv::Rect(x,y,size.width,size.height)));
-
-//     return result;
-// }
+    delete _writer;
+    delete _manifest;
+}
+
+cv::Mat SampleCollector::resizeSample(const cv::Mat &sample, const int &size)
+{
+    std::vector<cv::Mat> results;
+    resizeSample(sample, std::vector<int>(1, size), results);
+    return results.front();
+}
+
+void SampleCollector::resizeSample(const cv::Mat &sample, const std::vector<int> &sizes, std::vector<cv::Mat> &results)
+{
+    DatasetReader::letterbox(sample, sizes, results);
+}
 
 bool SampleCollector::setStoragePath(const QString &sample_folder, const QString &label_name)
 {
@@ -86,47 +75,259 @@ bool SampleCollector::setStoragePath(const QString &sample_folder, const QString
         _storage_dir_proc->setPath(_storage_dir->filePath(SAMPLE_PROC_FORMAT));
 
     _storage_path = _storage_dir->absolutePath();
+    _resize_sizes = _settings->sample_resize_sizes.toVector().toStdVector();
+    _orig_codec = _settings->sample_orig_codec.toLatin1();
+    _orig_params.clear();
+    if (_orig_codec == "PNG")
+        _orig_params = {cv::IMWRITE_PNG_COMPRESSION, _settings->sample_orig_compression};
+    else if (_orig_codec == "WEBP")
+        // quality above 100 selects the lossless mode
+        _orig_params = {cv::IMWRITE_WEBP_QUALITY, 101};
+    _dedup_mode = _settings->sample_dedup_mode.toLatin1();
+    _dedup_distance = _settings->sample_dedup_distance;
 
     if (dir.exists() &&
         (_storage_dir->exists() || dir.mkdir(label_name)) &&
         (_storage_dir_orig->exists() || _storage_dir->mkdir(SAMPLE_ORIG_FORMAT)) &&
-        (_storage_dir_proc->exists() || _storage_dir->mkdir(SAMPLE_PROC_FORMAT))
+        (_storage_dir_proc->exists() || _storage_dir->mkdir(SAMPLE_PROC_FORMAT)) &&
+        _manifest->open(_storage_dir->filePath(SampleManifest::file_name))
        )
+    {
+        for (const auto &size : _resize_sizes)
+        {
+            QString size_dir = QString::number(size);
+            if (!_storage_dir->exists(size_dir) && !_storage_dir->mkdir(size_dir))
+                return false;
+        }
+        // the index of a label is kept in memory once loaded
+        auto index = _hash_indexes.find(_storage_path);
+        if (index == _hash_indexes.end())
+        {
+            index = _hash_indexes.insert(std::make_pair(_storage_path, SampleHashIndex())).first;
+            _loadHashes(_storage_dir->filePath(SampleManifest::file_name), index->second);
+        }
+        _hash_index = &index->second;
         return true;
+    }
 
     return false;
 }
 
 bool SampleCollector::sample(const cv::Mat &orig_img, const cv::Mat &proc_img)
 {
-    if (orig_img.empty() || proc_img.empty())
+    return sample(orig_img, proc_img, SampleManifest::Record());
+}
+
+bool SampleCollector::sample(const cv::Mat &orig_img, const cv::Mat &proc_img, const SampleManifest::Record &record)
+{
+    std::vector<Sample> samples(1);
+    samples.front().orig_img = orig_img;
+    samples.front().proc_img = proc_img;
+    samples.front().record = record;
+    return sample(samples);
+}
+
+bool SampleCollector::sample(const std::vector<Sample> &samples)
+{
+    if (_storage_dir == nullptr)
         return false;
+    for (const auto &s : samples)
+        if (s.orig_img.empty() || s.proc_img.empty())
+            return false;
+
+    // the names reserved so far are all on disk once nothing is pending
+    if (_writer->pending() == 0)
+        _reserved_ids.clear();
+    std::vector<SampleWriter::Job> jobs;
+    jobs.reserve(samples.size()*(2 + _resize_sizes.size()));
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    _skipped = 0;
+    for (const auto &s : samples)
+    {
+        // compared with the samples stored so far, including the previous ones in the batch
+        const quint64 dhash = SampleHashIndex::dHash(s.proc_img);
+        const bool duplicate = _dedup_mode != "OFF" && _hash_index != nullptr &&
+                               _hash_index->nearest(dhash) <= _dedup_distance;
+        if (duplicate)
+            ++_duplicates;
+        if (duplicate && _dedup_mode == "SKIP")
+        {
+            ++_skipped;
+            continue;
+        }
+        if (_hash_index != nullptr)
+            _hash_index->insert(dhash);
 
-    QPixmap orig_image = CvQtImgConvertor::cvMat2QPixmap(orig_img);
-    // QPixmap proc_image = CvQtImgConvertor::cvMat2QPixmap(resizeSample(proc_img));
-    QPixmap proc_image = CvQtImgConvertor::cvMat2QPixmap(proc_img);
+        const quint32 sample_id = _reserveId(*_storage_dir_orig, _storage_dir_proc);
+        const QString file_name = QString::number(sample_id);
 
-    QString file_name = QString::number(qrand());
+        // the writer keeps its own copies since the detector reuses the buffers of both images
+        _queue(jobs, _storage_dir_orig->filePath(file_name), s.orig_img.clone(), _orig_codec, _orig_params);
+        _queue(jobs, _storage_dir_proc->filePath(file_name), s.proc_img.clone(), proc_image_format);
+        if (!_resize_sizes.empty())
+        {
+            std::vector<cv::Mat> resized;
+            resizeSample(s.proc_img, _resize_sizes, resized);
+            for (size_t i = 0; i < resized.size(); ++i)
+                _queue(jobs, QDir(_storage_dir->filePath(QString::number(_resize_sizes[i]))).filePath(file_name),
+                       resized[i], proc_image_format);
+        }
+
+        SampleManifest::Record r(s.record);
+        r.sample_id = sample_id;
+        if (r.timestamp == 0)
+            r.timestamp = now;
+        r.dhash = dhash;
+        r.hashed = true;
+        r.duplicate = duplicate;
+        _manifest->append(r);
+    }
+    _writer->enqueue(jobs);
+    _sampling_timer.start();
+    return true;
+}
+
+int SampleCollector::skipped() const
+{
+    return _skipped;
+}
+
+bool SampleCollector::sampleClip(const std::vector<cv::Mat> &masks, const std::vector<qint64> &timestamps,
+                                 const cv::Point &offset)
+{
+    if (_storage_dir == nullptr || masks.empty() || masks.size() != timestamps.size())
+        return false;
+    for (const auto &m : masks)
+        if (m.empty() || m.type() != CV_8UC1 || m.size() != masks.front().size())
+            return false;
+    if (!_storage_dir->exists(SAMPLE_CLIP_FORMAT) && !_storage_dir->mkdir(SAMPLE_CLIP_FORMAT))
+        return false;
+
+    QDir clip_dir(_storage_dir->filePath(SAMPLE_CLIP_FORMAT));
+    if (_writer->pending() == 0)
+        _reserved_ids.clear();
+    const QString file_name = QString::number(_reserveId(clip_dir));
+
+    std::vector<SampleWriter::Job> jobs(1);
+    SampleWriter::Job &job = jobs.front();
+    job.file_path = clip_dir.filePath(file_name);
+    job.format = SAMPLE_CLIP_FORMAT;
+    // the writer keeps its own copies since the caller reuses the buffers of the masks
+    job.clip.masks.reserve(masks.size());
+    for (const auto &m : masks)
+        job.clip.masks.push_back(m.clone());
+    job.clip.timestamps.assign(timestamps.begin(), timestamps.end());
+    job.clip.offset = offset;
+    _writer->enqueue(jobs);
+    _skipped = 0;
+    _sampling_timer.start();
+    return true;
+}
+
+quint32 SampleCollector::_reserveId(const QDir &dir, const QDir *other_dir)
+{
+    // The files are written asynchronously, so that a name queued but not yet written is not on disk.
+    // Such names are kept in memory until the writer has stored them all.
     while (true)
     {
-        if (_storage_dir_orig->exists(file_name) || _storage_dir_proc->exists(file_name))
-            file_name = QString::number(qrand());
-        else
+        const quint32 id = qrand();
+        const QString file_name = QString::number(id);
+        if (!_reserved_ids.contains(id) && !dir.exists(file_name) &&
+            (other_dir == nullptr || !other_dir->exists(file_name)))
         {
-            if (orig_image.save(_storage_dir_orig->filePath(file_name), SAMPLE_ORIG_FORMAT) &&
-                proc_image.save(_storage_dir_proc->filePath(file_name), SAMPLE_PROC_FORMAT)
-               )
-            {
-                _sampling_timer->start(_settings->sampling_interval);
-                return true;
-            }
-            return false;
+            _reserved_ids.insert(id);
+            return id;
         }
     }
-    return true;
+}
+
+void SampleCollector::_queue(std::vector<SampleWriter::Job> &jobs, const QString &file_path, const cv::Mat &image,
+                             const QByteArray &format, const std::vector<int> &params)
+{
+    jobs.emplace_back();
+    jobs.back().file_path = file_path;
+    jobs.back().image = image;
+    jobs.back().format = format;
+    jobs.back().params = params;
+}
+
+bool SampleCollector::flush()
+{
+    _writer->waitForDone();
+    _reserved_ids.clear();
+    return _manifest->flush();
+}
+
+int SampleCollector::pending()
+{
+    return _writer->pending();
+}
+
+qint64 SampleCollector::bytesStored()
+{
+    return _writer->bytesWritten();
+}
+
+void SampleCollector::beginSession()
+{
+    _writer->waitForDone();
+    _writer->resetStats();
+    _duplicates = 0;
+    _session_start = QDateTime::currentDateTime();
+}
+
+SampleCollector::SessionStats SampleCollector::endSession()
+{
+    flush();
+
+    SessionStats stats;
+    SampleWriter::Stats s = _writer->stats(_orig_codec);
+    stats.codec = _orig_codec;
+    stats.compression = _orig_codec == "PNG" ? _orig_params.back() : -1;
+    stats.samples = s.images;
+    stats.duplicates = _duplicates;
+    stats.failures = _writer->failures();
+    if (s.images > 0)
+    {
+        stats.encode_time = s.encode_time/1e6/s.images;
+        stats.file_size = double(s.bytes)/s.images;
+    }
+    if (_storage_dir == nullptr || stats.samples == 0)
+        return stats;
+
+    QFile file(_storage_dir->filePath(SAMPLE_SESSION_LOG_FILE_NAME));
+    bool new_file = !file.exists();
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+    {
+        QTextStream out(&file);
+        if (new_file)
+            out << "start\tsamples\tcodec\tcompression\tencode_ms_per_sample\tbytes_per_sample\n";
+        out << _session_start.toString(Qt::ISODate) << '\t'
+            << stats.samples << '\t'
+            << stats.codec << '\t'
+            << stats.compression << '\t'
+            << QString::number(stats.encode_time, 'f', 3) << '\t'
+            << QString::number(stats.file_size, 'f', 0) << '\n';
+    }
+    return stats;
 }
 
 bool SampleCollector::deny()
 {
-    return _sampling_timer->isActive();
+    return _sampling_timer.isValid() && _sampling_timer.elapsed() < _settings->sampling_interval;
+}
+
+void SampleCollector::_loadHashes(const QString &manifest_path, SampleHashIndex &index)
+{
+    SampleManifest::Table table;
+    if (!SampleManifest::load(manifest_path, table,
+                              (quint64(1) << SampleManifest::COLUMN_DHASH) | (quint64(1) << SampleManifest::COLUMN_FLAGS)) ||
+        table.rows == 0)
+        return;
+    const quint64 *hashes = table.column<quint64>(SampleManifest::COLUMN_DHASH);
+    const quint8 *flags = table.column<quint8>(SampleManifest::COLUMN_FLAGS);
+    // samples stored before hashing was introduced have no hash, while 0 is a valid hash, e.g. of a solid mask
+    for (int i = std::max(0, table.rows - SAMPLE_DEDUP_WINDOW); i < table.rows; ++i)
+        if (flags[i] & SampleManifest::FLAG_HASHED)
+            index.insert(hashes[i]);
 }
@@ -8,13 +8,20 @@
 #include <QObject>
 #include <QDir>
 #include <QString>
-#include <QTimer>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QSet>
 
 #include <opencv2/opencv.hpp>
 
 #include "config.h"
-#include "CvQtImgConvertor.hpp"
+#include <vector>
+#include <map>
+
 #include "Settings.hpp"
+#include "SampleManifest.hpp"
+#include "SampleWriter.hpp"
+#include "SampleHashIndex.hpp"
 
 /**
  * @brief The SampleCollector class is the controller of sampling who also provides some static methods to process sample image.
@@ -42,6 +49,64 @@ public:
      * @brief proc_image_format is the format using which to store the processed image.
      */
     const static char *proc_image_format;
+    /**
+     * @brief The SessionStats struct is the statistics of storing the original images during a sampling session.
+     *
+     * @see #SampleCollector::endSession
+     */
+    struct SessionStats
+    {
+        /**
+         * @brief codec is the codec of the original images.
+         */
+        QByteArray codec;
+        /**
+         * @brief compression is the compression level of the `PNG` codec, or -1 for the other codecs.
+         */
+        int compression = -1;
+        /**
+         * @brief samples is the number of original images stored.
+         */
+        qint64 samples = 0;
+        /**
+         * @brief encode_time is the average encoding time per sample in milliseconds.
+         */
+        double encode_time = 0;
+        /**
+         * @brief file_size is the average file size per sample in bytes.
+         */
+        double file_size = 0;
+        /**
+         * @brief duplicates is the number of samples nearly identical to a recent one, flagged or skipped
+         *        according to #Settings::sample_dedup_mode .
+         */
+        qint64 duplicates = 0;
+        /**
+         * @brief failures is the number of images failed to be encoded or stored.
+         */
+        qint64 failures = 0;
+    };
+
+    /**
+     * @brief The Sample struct is a sample waiting to be stored.
+     *
+     * @see #SampleCollector::sample
+     */
+    struct Sample
+    {
+        /**
+         * @brief orig_img is the original sample image.
+         */
+        cv::Mat orig_img;
+        /**
+         * @brief proc_img is the processed sample image.
+         */
+        cv::Mat proc_img;
+        /**
+         * @brief record is the metadata of the sample.
+         */
+        SampleManifest::Record record;
+    };
 
     // /**
     //  * @brief sample_size is the size of a sample image
@@ -53,15 +118,30 @@ public:
     explicit SampleCollector(QObject *parent = 0);
     ~SampleCollector();
 
-    // /**
-    //  * @brief resizeSample resizes the given sample image with certain size.
-    //  *
-    //  * @param sample : the sample image
-    //  * @return the name image after resizing.
-    //  *
-    //  * @see #SampleCollector::sample
-    //  */
-    // virtual cv::Mat resizeSample(const cv::Mat &sample);
+    /**
+     * @brief resizeSample resizes the given sample image to a square with certain size.
+     *
+     * The image is scaled, keeping aspect ratio, to fit in the square and the rest is padded with black,
+     * like what `scripts/resize_samples.rb` does.
+     *
+     * @param sample : the sample image, a binary mask
+     * @param size : width and height of the result
+     * @return the image after resizing.
+     *
+     * @see #SampleCollector::sample
+     */
+    virtual cv::Mat resizeSample(const cv::Mat &sample, const int &size);
+    /**
+     * @brief resizeSample resizes the given sample image to several sizes at once.
+     *
+     * The sample is resized by #DatasetReader::letterbox , the same routine with which the checker regenerates
+     * resized samples, and its integral image is computed only once and shared by all sizes.
+     *
+     * @param sample : the sample image, a binary mask
+     * @param sizes : width and height of each result
+     * @param results : the images after resizing, in the order of `sizes`
+     */
+    virtual void resizeSample(const cv::Mat &sample, const std::vector<int> &sizes, std::vector<cv::Mat> &results);
 
     /**
      * @brief setStoragePath sets the path to store the next sample images.
@@ -69,6 +149,9 @@ public:
      * The sample images will be stored at `sample_folder/label_name/`.
      *
      * If no directory named `label_name` exists in `sample_folder`, a new directory will be made.
+     * The metadata of the following samples will be appended into the manifest file, #SampleManifest::file_name , in that directory.
+     * A directory named by each size in #Settings::sample_resize_sizes is made as well to store the resized samples.
+     * The original images of the following samples are stored using #Settings::sample_orig_codec .
      *
      * **ATTENTION**:
      *  This function is not thread-safe. And, usually, we do not hope to reset the storage path during sampling.
@@ -90,19 +173,105 @@ public:
     /**
      * @brief sample does a sampling at #SampleCollector::storage_path using the given image.
      *
+     * The images are stored asynchronously by #SampleWriter . #SampleCollector::storageFailed is emitted if an image failed to be stored.
+     *
+     * The processed image is hashed by #SampleHashIndex::dHash and compared with the latest #SAMPLE_DEDUP_WINDOW samples
+     * of the label, including those stored before. A sample within #Settings::sample_dedup_distance of one of them is
+     * flagged as #SampleManifest::FLAG_DUPLICATE or skipped according to #Settings::sample_dedup_mode ;
+     * see #SampleCollector::skipped .
+     *
      * **Attention**:
      *
      *  - use #SampleCollector::setStoragePath firstly before a batch of sampling
-     *  - this function would call #SampleCollector::resizeSample automatically so that there is no need to do resizing explicitly.
+     *  - this function would call #SampleCollector::resizeSample automatically for each size in #Settings::sample_resize_sizes so that there is no need to do resizing explicitly.
      *
      * @param image : the sample image
-     * @retval true : successfully stored an sample image
-     * @retval false : something fatal happened. This usually is caused by empty image, invalid storage path or the lack of permission to write file at the storage path.
+     * @retval true : successfully queued the sample images
+     * @retval false : something fatal happened. This usually is caused by empty image or invalid storage path.
      *
      * @see #SampleCollector::setStoragePath
      * @see #SampleCollector::resizeSample
      */
     virtual bool sample(const cv::Mat &orig_img, const cv::Mat &proc_img);
+    /**
+     * @brief sample does a sampling and appends the metadata of the sample into the manifest file.
+     *
+     * The field `sample_id` of the given record is filled by this function, and so is `timestamp` if it is 0.
+     *
+     * @param orig_img : the original sample image
+     * @param proc_img : the processed sample image
+     * @param record : metadata of the sample
+     * @retval true : successfully stored an sample image
+     * @retval false : something fatal happened.
+     *
+     * @see #SampleManifest
+     */
+    virtual bool sample(const cv::Mat &orig_img, const cv::Mat &proc_img, const SampleManifest::Record &record);
+    /**
+     * @brief sample does a batch of samplings at once, whose images are queued to #SampleWriter in one go.
+     *
+     * The records are filled as by the overload taking a single sample.
+     *
+     * @param samples : the samples
+     * @retval true : successfully queued the images of all samples
+     * @retval false : nothing is queued, since an image is empty or the storage path is invalid
+     */
+    virtual bool sample(const std::vector<Sample> &samples);
+    /**
+     * @brief skipped returns the number of samples skipped as nearly identical to a recent one by the last sampling.
+     *
+     * A skipped sample is not stored, though the sampling is successful and the sampling interval restarts.
+     */
+    int skipped() const;
+    /**
+     * @brief sampleClip does a sampling of consecutive frames for dynamic gestures, stored as one clip.
+     *
+     * The clip is encoded by #ClipCodec and stored asynchronously by #SampleWriter into a single file in the directory
+     * named by #SAMPLE_CLIP_FORMAT at #SampleCollector::storage_path , instead of one image file per frame.
+     * Neither original nor resized images are stored, and no metadata is appended into the manifest file.
+     *
+     * @param masks : the processed images of the frames, of the same size
+     * @param timestamps : the time, in milliseconds since epoch, when each frame was captured
+     * @param offset : the position of the images on the frames, i.e. the top-left corner of the region of interesting
+     * @retval true : successfully queued the clip
+     * @retval false : something fatal happened. This usually is caused by mismatched images or invalid storage path.
+     */
+    virtual bool sampleClip(const std::vector<cv::Mat> &masks, const std::vector<qint64> &timestamps,
+                            const cv::Point &offset);
+    /**
+     * @brief flush waits for all queued sample images being stored and writes the buffered metadata into the manifest file.
+     *
+     * It should be called after a batch of sampling.
+     *
+     * @retval true : successfully written
+     * @retval false : failed to write the manifest file
+     */
+    virtual bool flush();
+    /**
+     * @brief pending returns the number of sample images waiting to be stored.
+     */
+    int pending();
+    /**
+     * @brief bytesStored returns the total size of the sample images stored by this collector.
+     *
+     * @see #SampleWriter::bytesWritten
+     */
+    qint64 bytesStored();
+    /**
+     * @brief beginSession starts counting the statistics of a sampling session.
+     *
+     * It should be called after #SampleCollector::setStoragePath before a batch of sampling.
+     */
+    virtual void beginSession();
+    /**
+     * @brief endSession flushes the collector and returns the statistics of the session.
+     *
+     * The statistics are appended as a line into the file #SAMPLE_SESSION_LOG_FILE_NAME at #SampleCollector::storage_path
+     * if any sample was stored, so that codecs can be compared across sessions and machines.
+     *
+     * @return the statistics of the session
+     */
+    virtual SessionStats endSession();
 
     /**
      * @brief deny indicates that if the collector temporarily accepts sample or not.
@@ -111,22 +280,54 @@ public:
      */
     virtual bool deny();
 
+signals:
+    /**
+     * @brief storageFailed is the signal emitted when a sample image failed to be stored.
+     * @param file_path : path of the file who failed to be written
+     */
+    void storageFailed(const QString &file_path);
+
 protected:
     /**
-     * @brief _sampling_timer is the timer of sampling interval
+     * @brief _sampling_timer is the timer of sampling interval, started when a sample is taken.
+     *
+     * It is not a `QTimer` so that samples can be taken from a thread other than the one owning this object.
      */
-    QTimer *_sampling_timer;
+    QElapsedTimer _sampling_timer;
     /**
      * @brief _settings is an instance of #Settings .
      */
     Settings *_settings;
+    /**
+     * @brief _manifest is the manifest storing the metadata of samples at #SampleCollector::storage_path .
+     */
+    SampleManifest *_manifest;
+    /**
+     * @brief _writer stores the sample images in a background thread.
+     */
+    SampleWriter *_writer;
 
 private:
     QString _storage_path;
     QDir *_storage_dir;
     QDir *_storage_dir_orig;
     QDir *_storage_dir_proc;
+    std::vector<int> _resize_sizes;
+    QByteArray _orig_codec;
+    std::vector<int> _orig_params;
+    QDateTime _session_start;
+    QByteArray _dedup_mode;
+    int _dedup_distance;
+    std::map<QString, SampleHashIndex> _hash_indexes;
+    SampleHashIndex *_hash_index;
+    int _skipped;
+    qint64 _duplicates;
+    QSet<quint32> _reserved_ids;
 
+    static void _queue(std::vector<SampleWriter::Job> &jobs, const QString &file_path, const cv::Mat &image,
+                       const QByteArray &format, const std::vector<int> &params = std::vector<int>());
+    static void _loadHashes(const QString &manifest_path, SampleHashIndex &index);
+    quint32 _reserveId(const QDir &dir, const QDir *other_dir = nullptr);
 };
 
 #endif // SAMPLECOLLECTOR_H
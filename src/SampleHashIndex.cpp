@@ -0,0 +1,68 @@
+#include "SampleHashIndex.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+SampleHashIndex::SampleHashIndex(const int &capacity) :
+    _capacity(std::max(1, capacity)),
+    _head(0)
+{
+    _hashes.reserve(_capacity);
+}
+
+quint64 SampleHashIndex::dHash(const cv::Mat &img)
+{
+    if (img.empty())
+        return 0;
+
+    cv::Mat small;
+    cv::resize(img, small, cv::Size(9, 8), 0, 0, cv::INTER_AREA);
+    quint64 hash = 0;
+    for (int y = 0; y < 8; ++y)
+    {
+        const uchar *p = small.ptr<uchar>(y);
+        for (int x = 0; x < 8; ++x)
+            if (p[x] > p[x + 1])
+                hash |= quint64(1) << (y*8 + x);
+    }
+    return hash;
+}
+
+int SampleHashIndex::distance(const quint64 &a, const quint64 &b)
+{
+    return static_cast<int>(std::bitset<64>(a ^ b).count());
+}
+
+int SampleHashIndex::nearest(const quint64 &hash) const
+{
+    int best = 65;
+    for (const auto &h : _hashes)
+    {
+        best = std::min(best, distance(hash, h));
+        if (best == 0)
+            break;
+    }
+    return best;
+}
+
+void SampleHashIndex::insert(const quint64 &hash)
+{
+    if (static_cast<int>(_hashes.size()) < _capacity)
+        _hashes.push_back(hash);
+    else
+    {
+        _hashes[_head] = hash;
+        _head = (_head + 1) % _capacity;
+    }
+}
+
+int SampleHashIndex::size() const
+{
+    return static_cast<int>(_hashes.size());
+}
+
+void SampleHashIndex::clear()
+{
+    _hashes.clear();
+    _head = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef SAMPLEHASHINDEX_H
+#define SAMPLEHASHINDEX_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SampleHashIndex.hpp file contains the index of the perceptual hashes of the latest samples of a label.
+ */
+#include <QtGlobal>
+
+#include <opencv2/opencv.hpp>
+
+#include <vector>
+
+#include "config.h"
+
+/**
+ * @brief The SampleHashIndex class keeps the perceptual hashes of the latest samples of a label, so that a new sample
+ *        nearly identical to a recent one can be found, e.g. while the hand holds a static pose.
+ *
+ * A sample is hashed by #SampleHashIndex::dHash , and compared with every hash kept by the Hamming distance,
+ * i.e. the popcount of their XOR, which takes a few nanoseconds per hash. The hashes are kept in a ring of
+ * a fixed capacity, in which a new hash replaces the oldest one.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ *
+ * @see #SampleCollector::sample
+ */
+class SampleHashIndex
+{
+public:
+    /**
+     * @brief SampleHashIndex is the constructor.
+     * @param capacity : the number of hashes kept
+     */
+    explicit SampleHashIndex(const int &capacity = SAMPLE_DEDUP_WINDOW);
+
+    /**
+     * @brief dHash computes the 64-bit difference hash of an image.
+     *
+     * The image is shrunk to 9 x 8 pixels by area averaging, and each bit tells if a pixel is brighter than
+     * its right neighbor, so that the hash is robust to noise, blur and small changes on the edge of a mask.
+     *
+     * @param img : a single-channel 8-bit image, e.g. the processed sample image
+     * @return the hash, or 0 if the image is empty
+     */
+    static quint64 dHash(const cv::Mat &img);
+    /**
+     * @brief distance returns the Hamming distance between two hashes.
+     */
+    static int distance(const quint64 &a, const quint64 &b);
+    /**
+     * @brief nearest returns the smallest Hamming distance between the given hash and the hashes kept.
+     * @return the distance, or 65 if no hash is kept
+     */
+    int nearest(const quint64 &hash) const;
+    /**
+     * @brief insert keeps a hash, replacing the oldest one if the index is full.
+     */
+    void insert(const quint64 &hash);
+    /**
+     * @brief size returns the number of hashes kept.
+     */
+    int size() const;
+    /**
+     * @brief clear drops all hashes.
+     */
+    void clear();
+
+private:
+    std::vector<quint64> _hashes;
+    int _capacity;
+    int _head;
+};
+
+#endif // SAMPLEHASHINDEX_H
@@ -0,0 +1,335 @@
+#include "SampleManifest.hpp"
+
+#include <cstring>
+
+const char *SampleManifest::file_name = SAMPLE_MANIFEST_FILE_NAME;
+
+namespace
+{
+    const char MANIFEST_MAGIC[4] = {'G', 'S', 'C', 'M'};
+    const quint16 MANIFEST_VERSION = 1;
+
+    struct ChunkHeader
+    {
+        quint32 rows;
+        quint16 column_count;
+        quint16 reserved;
+    };
+
+    struct ColumnEntry
+    {
+        quint16 id;
+        quint16 width;
+    };
+
+    template<typename T>
+    inline void put(QByteArray &column, const T &value)
+    {
+        column.append(reinterpret_cast<const char *>(&value), sizeof(T));
+    }
+}
+
+int SampleManifest::width(const COLUMN &c)
+{
+    switch (c)
+    {
+    case COLUMN_SAMPLE_ID:
+    case COLUMN_PALM_RADIUS:
+    case COLUMN_CONTOUR_AREA:
+        return 4;
+    case COLUMN_TIMESTAMP:
+    case COLUMN_DHASH:
+        return 8;
+    case COLUMN_ROI_X:
+    case COLUMN_ROI_Y:
+    case COLUMN_ROI_WIDTH:
+    case COLUMN_ROI_HEIGHT:
+    case COLUMN_HAND_X:
+    case COLUMN_HAND_Y:
+    case COLUMN_HAND_WIDTH:
+    case COLUMN_HAND_HEIGHT:
+    case COLUMN_HAND_CENTER_X:
+    case COLUMN_HAND_CENTER_Y:
+        return 2;
+    default:
+        return 1;
+    }
+}
+
+SampleManifest::SampleManifest()
+{}
+
+SampleManifest::~SampleManifest()
+{
+    flush();
+}
+
+bool SampleManifest::open(const QString &file_path)
+{
+    flush();
+    _file_path = file_path;
+
+    QFile file(_file_path);
+    if (file.exists())
+    {
+        if (!file.open(QIODevice::ReadWrite))
+            return false;
+        // cut off a chunk left partially written, e.g. due to crash, so that new chunks are not appended behind it
+        const qint64 end = _completeSize(file);
+        if (end < 0)
+            return false;
+        if (end > 0)
+            return end == file.size() || file.resize(end);
+        // not even the header was written
+        file.resize(0);
+    }
+    else if (!file.open(QIODevice::WriteOnly))
+        return false;
+    quint16 header[2] = {MANIFEST_VERSION, 0};
+    return file.write(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) == sizeof(MANIFEST_MAGIC) &&
+           file.write(reinterpret_cast<const char *>(header), sizeof(header)) == sizeof(header);
+}
+
+bool SampleManifest::append(const Record &record)
+{
+    if (_file_path.isEmpty())
+        return false;
+
+    _buffer.append(record);
+    if (_buffer.rows >= SAMPLE_MANIFEST_CHUNK_SIZE)
+        return flush();
+    return true;
+}
+
+bool SampleManifest::flush()
+{
+    if (_buffer.rows == 0 || _file_path.isEmpty())
+        return true;
+
+    QFile file(_file_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+    const qint64 size = file.size();
+    if (!_writeChunk(file, _buffer.rows, _buffer.columns))
+    {
+        // drop what was partially written and keep the records for the next try
+        file.resize(size);
+        return false;
+    }
+    _buffer.rows = 0;
+    for (auto &c : _buffer.columns)
+        c.resize(0);
+    return true;
+}
+
+bool SampleManifest::load(const QString &file_path, Table &table, const quint64 &column_mask)
+{
+    table.rows = 0;
+    table.columns = QVector<QByteArray>(COLUMN_COUNT);
+
+    QFile file(file_path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    char magic[4];
+    quint16 header[2];
+    if (file.read(magic, sizeof(magic)) != sizeof(magic) ||
+        std::memcmp(magic, MANIFEST_MAGIC, sizeof(magic)) != 0 ||
+        file.read(reinterpret_cast<char *>(header), sizeof(header)) != sizeof(header) ||
+        header[0] > MANIFEST_VERSION)
+        return false;
+
+    ChunkHeader chunk;
+    QVector<ColumnEntry> directory;
+    while (file.read(reinterpret_cast<char *>(&chunk), sizeof(chunk)) == sizeof(chunk))
+    {
+        directory.resize(chunk.column_count);
+        qint64 chunk_size = 0;
+        if (file.read(reinterpret_cast<char *>(directory.data()), sizeof(ColumnEntry)*chunk.column_count)
+                != static_cast<qint64>(sizeof(ColumnEntry)*chunk.column_count))
+            break;
+        for (const auto &e : directory)
+            chunk_size += static_cast<qint64>(e.width)*chunk.rows;
+        // ignore the truncated chunk
+        if (file.pos() + chunk_size > file.size())
+            break;
+
+        for (const auto &e : directory)
+        {
+            qint64 size = static_cast<qint64>(e.width)*chunk.rows;
+            if (e.id < COLUMN_COUNT && e.width == width(static_cast<COLUMN>(e.id)) &&
+                (column_mask & (quint64(1) << e.id)))
+            {
+                QByteArray &col = table.columns[e.id];
+                int offset = col.size();
+                col.resize(offset + static_cast<int>(size));
+                file.read(col.data() + offset, size);
+            }
+            else
+                file.seek(file.pos() + size);
+        }
+        table.rows += chunk.rows;
+        // keep columns missing from this chunk aligned with the others
+        for (int c = 0; c < COLUMN_COUNT; ++c)
+        {
+            if (!(column_mask & (quint64(1) << c)))
+                continue;
+            int expected = table.rows*width(static_cast<COLUMN>(c));
+            if (table.columns[c].size() < expected)
+                table.columns[c].append(QByteArray(expected - table.columns[c].size(), 0));
+        }
+    }
+    return true;
+}
+
+bool SampleManifest::save(const QString &file_path, const Table &table)
+{
+    QString tmp_path = file_path + ".tmp";
+    QFile file(tmp_path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+    quint16 header[2] = {MANIFEST_VERSION, 0};
+    if (file.write(MANIFEST_MAGIC, sizeof(MANIFEST_MAGIC)) != sizeof(MANIFEST_MAGIC) ||
+        file.write(reinterpret_cast<const char *>(header), sizeof(header)) != sizeof(header) ||
+        (table.rows > 0 && !_writeChunk(file, table.rows, table.columns)))
+    {
+        file.remove();
+        return false;
+    }
+    file.close();
+    QFile::remove(file_path);
+    return QFile::rename(tmp_path, file_path);
+}
+
+SampleManifest::Record SampleManifest::Table::record(const int &row) const
+{
+    Record r;
+    auto get = [&](const COLUMN &c, double default_val) -> double
+    {
+        if (columns[c].isEmpty())
+            return default_val;
+        if (c == COLUMN_PALM_RADIUS || c == COLUMN_CONTOUR_AREA)
+            return column<float>(c)[row];
+        if (width(c) == 2)
+            return column<qint16>(c)[row];
+        return column<quint8>(c)[row];
+    };
+    if (!columns[COLUMN_SAMPLE_ID].isEmpty())
+        r.sample_id = column<quint32>(COLUMN_SAMPLE_ID)[row];
+    if (!columns[COLUMN_TIMESTAMP].isEmpty())
+        r.timestamp = column<qint64>(COLUMN_TIMESTAMP)[row];
+    r.roi = cv::Rect(get(COLUMN_ROI_X, 0), get(COLUMN_ROI_Y, 0),
+                     get(COLUMN_ROI_WIDTH, 0), get(COLUMN_ROI_HEIGHT, 0));
+    r.skin_color_lower_bound = cv::Scalar(get(COLUMN_SKIN_COLOR_MIN_H, 0),
+                                          get(COLUMN_SKIN_COLOR_MIN_S, 0),
+                                          get(COLUMN_SKIN_COLOR_MIN_V, 0));
+    r.skin_color_upper_bound = cv::Scalar(get(COLUMN_SKIN_COLOR_MAX_H, 0),
+                                          get(COLUMN_SKIN_COLOR_MAX_S, 0),
+                                          get(COLUMN_SKIN_COLOR_MAX_V, 0));
+    int flags = get(COLUMN_FLAGS, 0);
+    r.background_subtraction = flags & FLAG_BACKGROUND_SUBTRACTION;
+    r.morphology = flags & FLAG_MORPHOLOGY;
+    r.skin_color_calibration = flags & FLAG_SKIN_COLOR_CALIBRATION;
+    r.skin_color_ycrcb = flags & FLAG_SKIN_COLOR_YCRCB;
+    r.duplicate = flags & FLAG_DUPLICATE;
+    r.hashed = flags & FLAG_HASHED;
+    r.hand_bound = cv::Rect(get(COLUMN_HAND_X, 0), get(COLUMN_HAND_Y, 0),
+                            get(COLUMN_HAND_WIDTH, 0), get(COLUMN_HAND_HEIGHT, 0));
+    r.hand_center = cv::Point(get(COLUMN_HAND_CENTER_X, 0), get(COLUMN_HAND_CENTER_Y, 0));
+    r.palm_radius = get(COLUMN_PALM_RADIUS, 0);
+    r.finger_count = get(COLUMN_FINGER_COUNT, 0);
+    r.contour_area = get(COLUMN_CONTOUR_AREA, 0);
+    if (!columns[COLUMN_DHASH].isEmpty())
+        r.dhash = column<quint64>(COLUMN_DHASH)[row];
+    return r;
+}
+
+void SampleManifest::Table::append(const Record &record)
+{
+    if (columns.size() != COLUMN_COUNT)
+        columns.resize(COLUMN_COUNT);
+
+    put<quint32>(columns[COLUMN_SAMPLE_ID], record.sample_id);
+    put<qint64>(columns[COLUMN_TIMESTAMP], record.timestamp);
+    put<qint16>(columns[COLUMN_ROI_X], record.roi.x);
+    put<qint16>(columns[COLUMN_ROI_Y], record.roi.y);
+    put<qint16>(columns[COLUMN_ROI_WIDTH], record.roi.width);
+    put<qint16>(columns[COLUMN_ROI_HEIGHT], record.roi.height);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MIN_H], record.skin_color_lower_bound[0]);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MIN_S], record.skin_color_lower_bound[1]);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MIN_V], record.skin_color_lower_bound[2]);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MAX_H], record.skin_color_upper_bound[0]);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MAX_S], record.skin_color_upper_bound[1]);
+    put<quint8>(columns[COLUMN_SKIN_COLOR_MAX_V], record.skin_color_upper_bound[2]);
+    put<quint8>(columns[COLUMN_FLAGS], (record.background_subtraction ? FLAG_BACKGROUND_SUBTRACTION : 0) |
+                                       (record.morphology ? FLAG_MORPHOLOGY : 0) |
+                                       (record.skin_color_calibration ? FLAG_SKIN_COLOR_CALIBRATION : 0) |
+                                       (record.skin_color_ycrcb ? FLAG_SKIN_COLOR_YCRCB : 0) |
+                                       (record.duplicate ? FLAG_DUPLICATE : 0) |
+                                       (record.hashed ? FLAG_HASHED : 0));
+    put<qint16>(columns[COLUMN_HAND_X], record.hand_bound.x);
+    put<qint16>(columns[COLUMN_HAND_Y], record.hand_bound.y);
+    put<qint16>(columns[COLUMN_HAND_WIDTH], record.hand_bound.width);
+    put<qint16>(columns[COLUMN_HAND_HEIGHT], record.hand_bound.height);
+    put<qint16>(columns[COLUMN_HAND_CENTER_X], record.hand_center.x);
+    put<qint16>(columns[COLUMN_HAND_CENTER_Y], record.hand_center.y);
+    put<float>(columns[COLUMN_PALM_RADIUS], record.palm_radius);
+    put<quint8>(columns[COLUMN_FINGER_COUNT], record.finger_count);
+    put<float>(columns[COLUMN_CONTOUR_AREA], record.contour_area);
+    put<quint64>(columns[COLUMN_DHASH], record.dhash);
+    ++rows;
+}
+
+qint64 SampleManifest::_completeSize(QFile &file)
+{
+    const qint64 header_size = sizeof(MANIFEST_MAGIC) + 2*sizeof(quint16);
+    if (file.size() < header_size)
+        return 0;
+    char magic[4];
+    if (!file.seek(0) || file.read(magic, sizeof(magic)) != sizeof(magic) ||
+        std::memcmp(magic, MANIFEST_MAGIC, sizeof(magic)) != 0)
+        return -1;
+
+    // walk the chunk headers without reading the column data
+    qint64 end = header_size;
+    ChunkHeader chunk;
+    QVector<ColumnEntry> directory;
+    while (file.seek(end) && file.read(reinterpret_cast<char *>(&chunk), sizeof(chunk)) == sizeof(chunk))
+    {
+        directory.resize(chunk.column_count);
+        if (file.read(reinterpret_cast<char *>(directory.data()), sizeof(ColumnEntry)*chunk.column_count)
+                != static_cast<qint64>(sizeof(ColumnEntry)*chunk.column_count))
+            break;
+        qint64 chunk_end = file.pos();
+        for (const auto &e : directory)
+            chunk_end += static_cast<qint64>(e.width)*chunk.rows;
+        if (chunk_end > file.size())
+            break;
+        end = chunk_end;
+    }
+    return end;
+}
+
+bool SampleManifest::_writeChunk(QFile &file, const int &rows, const QVector<QByteArray> &columns)
+{
+    ChunkHeader chunk;
+    chunk.rows = rows;
+    chunk.column_count = COLUMN_COUNT;
+    chunk.reserved = 0;
+    QVector<ColumnEntry> directory(COLUMN_COUNT);
+    for (int c = 0; c < COLUMN_COUNT; ++c)
+    {
+        directory[c].id = c;
+        directory[c].width = width(static_cast<COLUMN>(c));
+        if (columns[c].size() != rows*directory[c].width)
+            return false;
+    }
+
+    // assemble the chunk so that it is appended by a single write
+    QByteArray buffer;
+    buffer.reserve(sizeof(chunk) + sizeof(ColumnEntry)*COLUMN_COUNT + columns.size()*rows*8);
+    buffer.append(reinterpret_cast<const char *>(&chunk), sizeof(chunk));
+    buffer.append(reinterpret_cast<const char *>(directory.constData()), sizeof(ColumnEntry)*COLUMN_COUNT);
+    for (const auto &c : columns)
+        buffer.append(c);
+    return file.write(buffer) == buffer.size() && file.flush();
+}
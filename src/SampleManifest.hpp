@@ -0,0 +1,219 @@
+#ifndef SAMPLEMANIFEST_H
+#define SAMPLEMANIFEST_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SampleManifest.hpp file contains the class of storing per-sample metadata in a columnar binary file.
+ */
+#include <QString>
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+
+#include <opencv2/opencv.hpp>
+
+#include "config.h"
+
+/**
+ * @brief The SampleManifest class appends one metadata record per sample into a columnar binary file.
+ *
+ * **ATTENTION**:
+ *  This function is not thread-safe.
+ *
+ * Records are buffered in memory column by column and written as a chunk
+ * once #SAMPLE_MANIFEST_CHUNK_SIZE records are buffered or #SampleManifest::flush is called.
+ * The file consists of a header followed by a sequence of chunks:
+ *
+ *      header: "GSCM" (4 bytes), version (uint16), reserved (uint16)
+ *      chunk:  rows (uint32), column count (uint16), reserved (uint16),
+ *              column directory, column count x {column id (uint16), element width (uint16)},
+ *              column data, rows x element width bytes per column, in directory order
+ *
+ * All values are stored in the native (little-endian) byte order.
+ * A reader can skip the columns it does not need by seeking over them,
+ * so that filtering the samples is a scan of few contiguous arrays.
+ *
+ * @see #SampleManifest::load
+ */
+class SampleManifest
+{
+public:
+    /**
+     * @brief COLUMN is the id of the columns stored in the manifest.
+     */
+    enum COLUMN
+    {
+        COLUMN_SAMPLE_ID = 0,    //!< uint32, name of the sample image files
+        COLUMN_TIMESTAMP,        //!< int64, sampling time in milliseconds since epoch
+        COLUMN_ROI_X,            //!< int16, region of interesting on the captured frame
+        COLUMN_ROI_Y,            //!< int16
+        COLUMN_ROI_WIDTH,        //!< int16
+        COLUMN_ROI_HEIGHT,       //!< int16
+        COLUMN_SKIN_COLOR_MIN_H, //!< uint8, skin color filter in effect, Y, Cr and Cb if #SampleManifest::FLAG_SKIN_COLOR_YCRCB
+        COLUMN_SKIN_COLOR_MIN_S, //!< uint8
+        COLUMN_SKIN_COLOR_MIN_V, //!< uint8
+        COLUMN_SKIN_COLOR_MAX_H, //!< uint8
+        COLUMN_SKIN_COLOR_MAX_S, //!< uint8
+        COLUMN_SKIN_COLOR_MAX_V, //!< uint8
+        COLUMN_FLAGS,            //!< uint8, combination of #SampleManifest::FLAG
+        COLUMN_HAND_X,           //!< int16, bounding rectangle of the hand on the region of interesting
+        COLUMN_HAND_Y,           //!< int16
+        COLUMN_HAND_WIDTH,       //!< int16
+        COLUMN_HAND_HEIGHT,      //!< int16
+        COLUMN_HAND_CENTER_X,    //!< int16, estimated palm center on the region of interesting
+        COLUMN_HAND_CENTER_Y,    //!< int16
+        COLUMN_PALM_RADIUS,      //!< float32
+        COLUMN_FINGER_COUNT,     //!< uint8
+        COLUMN_CONTOUR_AREA,     //!< float32
+        COLUMN_DHASH,            //!< uint64, perceptual hash of the processed sample image, see #SampleHashIndex::dHash
+        COLUMN_COUNT
+    };
+    /**
+     * @brief FLAG is the bit flags stored in #SampleManifest::COLUMN_FLAGS .
+     */
+    enum FLAG
+    {
+        FLAG_BACKGROUND_SUBTRACTION = 0x01, //!< the background subtractor was in use
+        FLAG_MORPHOLOGY = 0x02,             //!< the morphological transformation was performed
+        FLAG_SKIN_COLOR_CALIBRATION = 0x04, //!< the calibrated skin color filter was used instead of the skin color bounds
+        FLAG_SKIN_COLOR_YCRCB = 0x08,       //!< the skin color bounds were in YCrCb color space instead of HSV color space
+        FLAG_DUPLICATE = 0x10,              //!< the sample is nearly identical to a recent one of the same label
+        FLAG_HASHED = 0x20                  //!< #SampleManifest::COLUMN_DHASH holds the hash of the sample, which may be 0
+    };
+    /**
+     * @brief The Record struct is the metadata of one sample.
+     */
+    struct Record
+    {
+        quint32 sample_id = 0;
+        qint64 timestamp = 0;
+        cv::Rect roi;
+        cv::Scalar skin_color_lower_bound;
+        cv::Scalar skin_color_upper_bound;
+        bool background_subtraction = false;
+        bool morphology = false;
+        bool skin_color_calibration = false;
+        bool skin_color_ycrcb = false;
+        cv::Rect hand_bound;
+        cv::Point hand_center;
+        double palm_radius = 0;
+        int finger_count = 0;
+        double contour_area = 0;
+        quint64 dhash = 0;
+        bool hashed = false;
+        bool duplicate = false;
+    };
+    /**
+     * @brief The Table struct holds the columns loaded from a manifest file.
+     *
+     * Columns not requested when loading are left empty.
+     *
+     * @see #SampleManifest::load
+     */
+    struct Table
+    {
+        /**
+         * @brief rows is the number of records.
+         */
+        int rows = 0;
+        /**
+         * @brief columns holds the raw data of each column indexed by #SampleManifest::COLUMN .
+         */
+        QVector<QByteArray> columns = QVector<QByteArray>(COLUMN_COUNT);
+        /**
+         * @brief column returns the data of the given column as an array.
+         * @param c : the column id
+         * @return pointer to the first element, or nullptr if the column is not loaded
+         */
+        template<typename T>
+        const T *column(const COLUMN &c) const
+        {
+            return columns[c].isEmpty() ? nullptr : reinterpret_cast<const T *>(columns[c].constData());
+        }
+        /**
+         * @brief record assembles the record at the given row from the loaded columns.
+         * @param row : index of the record
+         * @return the record, whose fields from unloaded columns are left as default.
+         */
+        Record record(const int &row) const;
+        /**
+         * @brief append adds a record at the end of the table.
+         * @param record : the record of a sample
+         */
+        void append(const Record &record);
+    };
+    /**
+     * @brief file_name is the name of the manifest file stored in the storage directory of each label.
+     */
+    const static char *file_name;
+    /**
+     * @brief width returns the element width, in bytes, of the given column.
+     */
+    static int width(const COLUMN &c);
+
+    SampleManifest();
+    ~SampleManifest();
+
+    /**
+     * @brief open sets the file into which the following records will be appended.
+     *
+     * The buffered records are flushed into the previous file firstly.
+     * A new file with only the header will be created if the file does not exist.
+     * A truncated chunk at the end of an existing file, e.g. due to crash, is cut off before appending.
+     *
+     * @param file_path : path of the manifest file
+     * @retval true : successfully opened the file
+     * @retval false : failed to create or write the file
+     */
+    bool open(const QString &file_path);
+    /**
+     * @brief append buffers a record and writes a chunk if enough records are buffered.
+     * @param record : the record of a sample
+     * @retval true : successfully buffered the record
+     * @retval false : failed to write the chunk or no file opened
+     */
+    bool append(const Record &record);
+    /**
+     * @brief flush writes all buffered records into the manifest file as a chunk.
+     *
+     * If the chunk failed to be written, the file is restored to its previous size and the records are kept
+     * buffered, so that they are written by the next flush.
+     *
+     * @retval true : successfully written or nothing buffered
+     * @retval false : failed to write the file
+     */
+    bool flush();
+    /**
+     * @brief load reads the given columns of a manifest file.
+     *
+     * A truncated chunk at the end of the file, e.g. due to crash, is ignored.
+     *
+     * @param file_path : path of the manifest file
+     * @param table : the table into which the columns will be loaded
+     * @param column_mask : bit mask, `1 << COLUMN`, of the columns that will be loaded
+     * @retval true : successfully loaded
+     * @retval false : failed to open the file or the file is not a manifest file
+     */
+    static bool load(const QString &file_path, Table &table, const quint64 &column_mask = ~quint64(0));
+    /**
+     * @brief save writes the given table into a new manifest file as one chunk.
+     *
+     * An existing file at the given path will be replaced.
+     *
+     * @param file_path : path of the manifest file
+     * @param table : the table whose columns are all loaded
+     * @retval true : successfully saved
+     * @retval false : failed to write the file
+     */
+    static bool save(const QString &file_path, const Table &table);
+
+private:
+    QString _file_path;
+    Table _buffer;
+
+    static bool _writeChunk(QFile &file, const int &rows, const QVector<QByteArray> &columns);
+    // size of the header and the complete chunks of an opened file, 0 if shorter than the header, or -1 if not a manifest
+    static qint64 _completeSize(QFile &file);
+};
+
+#endif // SAMPLEMANIFEST_H
@@ -0,0 +1,170 @@
+#include "SampleWriter.hpp"
+
+#include <QMutexLocker>
+#include <QElapsedTimer>
+#include <QSaveFile>
+
+#include "QoiCodec.hpp"
+
+SampleWriter::SampleWriter(QObject *parent) :
+    QThread(parent),
+    _busy(0),
+    _stopping(false),
+    _failures(0),
+    _bytes_written(0)
+{
+    start(QThread::LowPriority);
+}
+
+SampleWriter::~SampleWriter()
+{
+    {
+        QMutexLocker lock(&_mutex);
+        _stopping = true;
+        _not_empty.wakeAll();
+    }
+    wait();
+}
+
+void SampleWriter::enqueue(const QString &file_path, const cv::Mat &image, const QByteArray &format,
+                           const std::vector<int> &params)
+{
+    QMutexLocker lock(&_mutex);
+    while (static_cast<int>(_queue.size()) >= SAMPLE_WRITER_QUEUE_SIZE)
+        _not_full.wait(&_mutex);
+    Job job;
+    job.file_path = file_path;
+    job.image = image;
+    job.format = format;
+    job.params = params;
+    _queue.push_back(std::move(job));
+    _not_empty.wakeOne();
+}
+
+void SampleWriter::enqueue(std::vector<Job> &jobs)
+{
+    QMutexLocker lock(&_mutex);
+    for (auto &job : jobs)
+    {
+        while (static_cast<int>(_queue.size()) >= SAMPLE_WRITER_QUEUE_SIZE)
+        {
+            _not_empty.wakeOne();
+            _not_full.wait(&_mutex);
+        }
+        _queue.push_back(std::move(job));
+    }
+    jobs.clear();
+    _not_empty.wakeOne();
+}
+
+int SampleWriter::pending()
+{
+    QMutexLocker lock(&_mutex);
+    return static_cast<int>(_queue.size()) + _busy;
+}
+
+void SampleWriter::waitForDone()
+{
+    QMutexLocker lock(&_mutex);
+    while (!_queue.empty() || _busy > 0)
+        _done.wait(&_mutex);
+}
+
+SampleWriter::Stats SampleWriter::stats(const QByteArray &format)
+{
+    QMutexLocker lock(&_mutex);
+    return _stats.value(format);
+}
+
+void SampleWriter::resetStats()
+{
+    QMutexLocker lock(&_mutex);
+    _stats.clear();
+    _failures = 0;
+}
+
+qint64 SampleWriter::failures()
+{
+    QMutexLocker lock(&_mutex);
+    return _failures;
+}
+
+qint64 SampleWriter::bytesWritten()
+{
+    QMutexLocker lock(&_mutex);
+    return _bytes_written;
+}
+
+void SampleWriter::run()
+{
+    QMutexLocker lock(&_mutex);
+    while (true)
+    {
+        while (_queue.empty() && !_stopping)
+            _not_empty.wait(&_mutex);
+        if (_queue.empty())
+            break;
+
+        Job job = std::move(_queue.front());
+        _queue.pop_front();
+        ++_busy;
+        _not_full.wakeAll();
+
+        lock.unlock();
+        bool success = _write(job);
+        lock.relock();
+
+        --_busy;
+        if (!success)
+        {
+            ++_failures;
+            emit writeFailed(job.file_path);
+        }
+        if (_queue.empty())
+            _done.wakeAll();
+    }
+}
+
+bool SampleWriter::_write(const Job &job)
+{
+    std::vector<uchar> buffer;
+    QElapsedTimer timer;
+    timer.start();
+    try
+    {
+        if (job.format == "QOI")
+        {
+            if (!QoiCodec::encode(job.image, buffer))
+                return false;
+        }
+        else if (job.format == SAMPLE_CLIP_FORMAT)
+        {
+            if (!ClipCodec::encode(job.clip, buffer))
+                return false;
+        }
+        else if (!cv::imencode("." + job.format.toLower().toStdString(), job.image, buffer, job.params))
+            return false;
+    }
+    catch (const cv::Exception &)
+    {
+        return false;
+    }
+    const qint64 encode_time = timer.nsecsElapsed();
+
+    // written into a temporary file and renamed by commit, so that an error when the data reaches the disk,
+    // e.g. on a full disk, is reported and leaves no truncated image behind
+    QSaveFile file(job.file_path);
+    if (!file.open(QIODevice::WriteOnly) ||
+        file.write(reinterpret_cast<const char *>(buffer.data()), buffer.size())
+            != static_cast<qint64>(buffer.size()) ||
+        !file.commit())
+        return false;
+
+    QMutexLocker lock(&_mutex);
+    Stats &s = _stats[job.format];
+    ++s.images;
+    s.bytes += buffer.size();
+    _bytes_written += buffer.size();
+    s.encode_time += encode_time;
+    return true;
+}
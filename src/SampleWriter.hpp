@@ -0,0 +1,163 @@
+#ifndef SAMPLEWRITER_H
+#define SAMPLEWRITER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SampleWriter.hpp file contains the class of encoding and storing sample images in a background thread.
+ */
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QMap>
+#include <deque>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "config.h"
+#include "ClipCodec.hpp"
+
+/**
+ * @brief The SampleWriter class encodes and stores sample images in its own thread.
+ *
+ * Images are queued by #SampleWriter::enqueue and written in order.
+ * The queue holds at most #SAMPLE_WRITER_QUEUE_SIZE images; #SampleWriter::enqueue blocks while the queue is full.
+ *
+ * Besides the formats supported by `cv::imencode`, `QOI` is encoded by #QoiCodec , and clips, in #SAMPLE_CLIP_FORMAT ,
+ * by #ClipCodec .
+ * The number, size and encoding time of the stored images are counted per format.
+ * Each file is written by `QSaveFile` , so that an image is counted as stored only once it is completely on disk,
+ * and a failed write leaves no truncated file.
+ *
+ * The functions of this class are thread-safe.
+ */
+class SampleWriter : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The Job struct is an image waiting to be stored.
+     */
+    struct Job
+    {
+        /**
+         * @brief file_path is the path of the file who will be written.
+         */
+        QString file_path;
+        /**
+         * @brief image is the image. It should not be modified after being queued.
+         */
+        cv::Mat image;
+        /**
+         * @brief format is the format of the image file, e.g. `BMP`.
+         */
+        QByteArray format;
+        /**
+         * @brief params is the encoding parameters passed to `cv::imencode`.
+         */
+        std::vector<int> params;
+        /**
+         * @brief clip is the clip stored instead of the image if the format is #SAMPLE_CLIP_FORMAT .
+         *        It should not be modified after being queued.
+         */
+        ClipCodec::Clip clip;
+    };
+    /**
+     * @brief The Stats struct is the statistics of the images stored in one format.
+     */
+    struct Stats
+    {
+        /**
+         * @brief images is the number of images stored.
+         */
+        qint64 images = 0;
+        /**
+         * @brief bytes is the total size of the encoded images.
+         */
+        qint64 bytes = 0;
+        /**
+         * @brief encode_time is the total time spent on encoding in nanoseconds.
+         */
+        qint64 encode_time = 0;
+    };
+
+    explicit SampleWriter(QObject *parent = 0);
+    /**
+     * @brief ~SampleWriter stores all queued images before stopping the thread.
+     */
+    ~SampleWriter();
+    /**
+     * @brief enqueue queues an image to be stored.
+     *
+     * The image data is shared with the caller; clone the image first if the caller would modify it later.
+     *
+     * @param file_path : path of the file who will be written
+     * @param image : the image
+     * @param format : the format of the image file, e.g. `BMP` or `PGM`
+     * @param params : the encoding parameters passed to `cv::imencode`
+     */
+    void enqueue(const QString &file_path, const cv::Mat &image, const QByteArray &format,
+                 const std::vector<int> &params = std::vector<int>());
+    /**
+     * @brief enqueue queues a batch of images at once.
+     * @param jobs : the images to be stored. It is empty after calling.
+     */
+    void enqueue(std::vector<Job> &jobs);
+    /**
+     * @brief pending returns the number of images waiting to be stored.
+     */
+    int pending();
+    /**
+     * @brief waitForDone blocks until all queued images are stored.
+     */
+    void waitForDone();
+    /**
+     * @brief stats returns the statistics of the images stored in the given format since the last reset.
+     */
+    Stats stats(const QByteArray &format);
+    /**
+     * @brief failures returns the number of images failed to be encoded or stored since the last reset.
+     *
+     * Unlike #SampleWriter::writeFailed , it can be read without an event loop, e.g. after #SampleWriter::waitForDone .
+     */
+    qint64 failures();
+    /**
+     * @brief resetStats clears the statistics of all formats and the number of failures.
+     */
+    void resetStats();
+    /**
+     * @brief bytesWritten returns the total size of the files written since the writer was constructed.
+     *
+     * It is not cleared by #SampleWriter::resetStats , so that the writing rate can be sampled at any time.
+     */
+    qint64 bytesWritten();
+
+signals:
+    /**
+     * @brief writeFailed is the signal emitted when an image failed to be encoded or stored.
+     * @param file_path : path of the file who failed to be written
+     */
+    void writeFailed(const QString &file_path);
+
+protected:
+    void run() override;
+
+private:
+    QMutex _mutex;
+    QWaitCondition _not_empty;
+    QWaitCondition _not_full;
+    QWaitCondition _done;
+    std::deque<Job> _queue;
+    int _busy;
+    bool _stopping;
+    QMap<QByteArray, Stats> _stats;
+    qint64 _failures;
+    qint64 _bytes_written;
+
+    inline bool _write(const Job &job);
+};
+
+#endif // SAMPLEWRITER_H
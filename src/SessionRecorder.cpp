@@ -0,0 +1,180 @@
+#include "SessionRecorder.hpp"
+
+#include <QMutexLocker>
+#include <QStringList>
+#include <QRegExp>
+
+SessionRecorder::SessionRecorder(QObject *parent) :
+    QThread(parent),
+    _busy(0),
+    _stopping(false),
+    _open(false)
+{
+    start(QThread::LowPriority);
+}
+
+SessionRecorder::~SessionRecorder()
+{
+    close();
+    {
+        QMutexLocker lock(&_mutex);
+        _stopping = true;
+        _not_empty.wakeAll();
+    }
+    wait();
+}
+
+bool SessionRecorder::open(const QString &file_path, const cv::Size &frame_size, const double &fps, const QString &label)
+{
+    close();
+
+    QMutexLocker lock(&_mutex);
+    const char *codec = RECORDING_CODEC;
+    try
+    {
+        if (!_video.open(file_path.toStdString(), cv::VideoWriter::fourcc(codec[0], codec[1], codec[2], codec[3]),
+                         fps, frame_size, true))
+            return false;
+    }
+    catch (const cv::Exception &)
+    {
+        return false;
+    }
+    _sidecar.setFileName(sidecarPath(file_path));
+    if (!_sidecar.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        _video.release();
+        return false;
+    }
+    _sidecar_stream.setDevice(&_sidecar);
+    _sidecar_stream << "timestamp\troi_x\troi_y\troi_width\troi_height\tlabel\tsampled\n";
+    _file_path = file_path;
+    // the label is a field of a tab-separated line
+    _label = QString(label).replace(QRegExp("[\t\r\n]"), " ");
+    _frame_size = frame_size;
+    _open = true;
+    return true;
+}
+
+bool SessionRecorder::isOpen()
+{
+    QMutexLocker lock(&_mutex);
+    return _open;
+}
+
+void SessionRecorder::record(const cv::Mat &frame, const qint64 &timestamp, const cv::Rect &roi, const bool &sampled)
+{
+    QMutexLocker lock(&_mutex);
+    if (!_open || frame.size() != _frame_size)
+        return;
+    while (static_cast<int>(_queue.size()) >= RECORDING_QUEUE_SIZE)
+        _not_full.wait(&_mutex);
+    Job job;
+    job.image = frame;
+    job.frame.timestamp = timestamp;
+    job.frame.roi = roi;
+    job.frame.label = _label;
+    job.frame.sampled = sampled;
+    _queue.push_back(std::move(job));
+    _not_empty.wakeOne();
+}
+
+void SessionRecorder::close()
+{
+    _waitForDone();
+    QMutexLocker lock(&_mutex);
+    if (!_open)
+        return;
+    _video.release();
+    _sidecar_stream.flush();
+    _sidecar_stream.setDevice(nullptr);
+    _sidecar.close();
+    _open = false;
+}
+
+QString SessionRecorder::sidecarPath(const QString &file_path)
+{
+    return file_path + RECORDING_SIDECAR_SUFFIX;
+}
+
+bool SessionRecorder::readSidecar(const QString &file_path, std::vector<Frame> &frames)
+{
+    frames.clear();
+    QFile file(sidecarPath(file_path));
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QTextStream in(&file);
+    // header
+    if (in.readLine().isNull())
+        return false;
+    while (!in.atEnd())
+    {
+        const QStringList fields = in.readLine().split('\t');
+        if (fields.size() != 7)
+            return false;
+        bool ok[6];
+        Frame frame;
+        frame.timestamp = fields.at(0).toLongLong(&ok[0]);
+        frame.roi = cv::Rect(fields.at(1).toInt(&ok[1]), fields.at(2).toInt(&ok[2]),
+                             fields.at(3).toInt(&ok[3]), fields.at(4).toInt(&ok[4]));
+        frame.label = fields.at(5);
+        frame.sampled = fields.at(6).toInt(&ok[5]) != 0;
+        for (const auto &o : ok)
+            if (!o)
+                return false;
+        frames.push_back(frame);
+    }
+    return true;
+}
+
+void SessionRecorder::run()
+{
+    QMutexLocker lock(&_mutex);
+    while (true)
+    {
+        while (_queue.empty() && !_stopping)
+            _not_empty.wait(&_mutex);
+        if (_queue.empty())
+            break;
+
+        Job job = std::move(_queue.front());
+        _queue.pop_front();
+        ++_busy;
+        _not_full.wakeAll();
+
+        lock.unlock();
+        bool success = _write(job);
+        lock.relock();
+
+        --_busy;
+        if (!success)
+            emit recordFailed(_file_path);
+        if (_queue.empty())
+            _done.wakeAll();
+    }
+}
+
+bool SessionRecorder::_write(const Job &job)
+{
+    try
+    {
+        _video.write(job.image);
+    }
+    catch (const cv::Exception &)
+    {
+        return false;
+    }
+    _sidecar_stream << job.frame.timestamp << '\t'
+                    << job.frame.roi.x << '\t' << job.frame.roi.y << '\t'
+                    << job.frame.roi.width << '\t' << job.frame.roi.height << '\t'
+                    << job.frame.label << '\t'
+                    << (job.frame.sampled ? 1 : 0) << '\n';
+    return _sidecar_stream.status() == QTextStream::Ok;
+}
+
+void SessionRecorder::_waitForDone()
+{
+    QMutexLocker lock(&_mutex);
+    while (!_queue.empty() || _busy > 0)
+        _done.wait(&_mutex);
+}
@@ -0,0 +1,150 @@
+#ifndef SESSIONRECORDER_H
+#define SESSIONRECORDER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SessionRecorder.hpp file contains the class recording the frames of a sampling session into a lossless video.
+ */
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QString>
+#include <QFile>
+#include <QTextStream>
+#include <deque>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "config.h"
+
+/**
+ * @brief The SessionRecorder class records the frames of a sampling session into a lossless video in its own thread,
+ *        so that hands can be detected again on the session later with other parameters.
+ *
+ * Frames are encoded by `cv::VideoWriter` using #RECORDING_CODEC . Since the region of interesting may be moved
+ * during a session while a video has a fixed frame size, whole frames are recorded, and the timestamp, the region
+ * of interesting, the label and if a sample was taken are written for each frame, as a line, into a sidecar file
+ * at the path of the video plus #RECORDING_SIDECAR_SUFFIX . Recording is sequential I/O, which costs much less than
+ * storing an image file per frame.
+ *
+ * Frames are queued by #SessionRecorder::record and recorded in order. The queue holds at most #RECORDING_QUEUE_SIZE
+ * frames; #SessionRecorder::record blocks while the queue is full, so that no frame is dropped.
+ *
+ * The functions of this class are thread-safe, but a recording should be opened, fed and closed by the same thread.
+ */
+class SessionRecorder : public QThread
+{
+    Q_OBJECT
+public:
+    /**
+     * @brief The Frame struct is the sidecar line of a recorded frame.
+     */
+    struct Frame
+    {
+        /**
+         * @brief timestamp is the time, in milliseconds since epoch, when the frame was captured.
+         */
+        qint64 timestamp = 0;
+        /**
+         * @brief roi is the region of interesting on the frame.
+         */
+        cv::Rect roi;
+        /**
+         * @brief label is the label of the session.
+         */
+        QString label;
+        /**
+         * @brief sampled is if a sample was taken from the frame when it was recorded.
+         */
+        bool sampled = false;
+    };
+
+    explicit SessionRecorder(QObject *parent = 0);
+    /**
+     * @brief ~SessionRecorder closes the recording.
+     */
+    ~SessionRecorder();
+
+    /**
+     * @brief open starts a recording. The recording opened previously is closed.
+     * @param file_path : path of the video file, whose suffix selects the container, see #RECORDING_FILE_SUFFIX
+     * @param frame_size : size of all frames
+     * @param fps : frame rate written into the video
+     * @param label : the label of the session
+     * @retval true : successfully opened the video and the sidecar files
+     * @retval false : failed, e.g. since the codec is not supported by the OpenCV build
+     */
+    bool open(const QString &file_path, const cv::Size &frame_size, const double &fps, const QString &label);
+    /**
+     * @brief isOpen returns if a recording is opened.
+     */
+    bool isOpen();
+    /**
+     * @brief record queues a frame to be recorded.
+     *
+     * The image data is shared with the caller; clone the image first if the caller would modify it later.
+     * A frame of a size other than the one given to #SessionRecorder::open is ignored.
+     *
+     * @param frame : the frame of type `CV_8UC3`
+     * @param timestamp : the time, in milliseconds since epoch, when the frame was captured
+     * @param roi : the region of interesting on the frame
+     * @param sampled : if a sample was taken from the frame
+     */
+    void record(const cv::Mat &frame, const qint64 &timestamp, const cv::Rect &roi, const bool &sampled);
+    /**
+     * @brief close records all queued frames and closes the recording.
+     */
+    void close();
+
+    /**
+     * @brief sidecarPath returns the path of the sidecar file of the given video.
+     */
+    static QString sidecarPath(const QString &file_path);
+    /**
+     * @brief readSidecar reads the sidecar file of the given video.
+     * @param file_path : path of the video file
+     * @param frames : the lines of the frames, in the order of the frames
+     * @retval true : successfully read
+     * @retval false : no sidecar file exists, or it is not readable or malformed
+     */
+    static bool readSidecar(const QString &file_path, std::vector<Frame> &frames);
+
+signals:
+    /**
+     * @brief recordFailed is the signal emitted when a frame failed to be recorded.
+     * @param file_path : path of the video file
+     */
+    void recordFailed(const QString &file_path);
+
+protected:
+    void run() override;
+
+private:
+    struct Job
+    {
+        cv::Mat image;
+        Frame frame;
+    };
+
+    QMutex _mutex;
+    QWaitCondition _not_empty;
+    QWaitCondition _not_full;
+    QWaitCondition _done;
+    std::deque<Job> _queue;
+    int _busy;
+    bool _stopping;
+    // used by the recording thread while open
+    QString _file_path;
+    QString _label;
+    cv::Size _frame_size;
+    cv::VideoWriter _video;
+    QFile _sidecar;
+    QTextStream _sidecar_stream;
+    bool _open;
+
+    inline bool _write(const Job &job);
+    void _waitForDone();
+};
+
+#endif // SESSIONRECORDER_H
@@ -1,10 +1,22 @@
 #include "Settings.hpp"
 
+#include <QCoreApplication>
+
+const QStringList Settings::sample_orig_codecs = QStringList() << "BMP" << "PNG" << "WEBP" << "QOI";
+const QStringList Settings::sample_dedup_modes = QStringList() << "OFF" << "FLAG" << "SKIP";
+
 Settings * Settings::getInstance()
 {
     return Singleton<Settings>::instance(Settings::createInstance);
 }
 
+QString Settings::_config_file;
+
+void Settings::setConfigFile(const QString &file_path)
+{
+    _config_file = file_path;
+}
+
 Settings * Settings::createInstance()
 {
     return new Settings();
@@ -22,19 +34,49 @@ Settings::Settings(QObject * parent) :
     skin_color_max_H(_skin_color_max_H),
     skin_color_max_S(_skin_color_max_S),
     skin_color_max_V(_skin_color_max_V),
+    skin_color_ycrcb(_skin_color_ycrcb),
+    skin_color_min_Y(_skin_color_min_Y),
+    skin_color_min_Cr(_skin_color_min_Cr),
+    skin_color_min_Cb(_skin_color_min_Cb),
+    skin_color_max_Y(_skin_color_max_Y),
+    skin_color_max_Cr(_skin_color_max_Cr),
+    skin_color_max_Cb(_skin_color_max_Cb),
     skin_detection_area(_skin_detection_area),
     skin_morphology(_skin_morphology),
     sampling_amount_per_time(_sampling_amount_per_time),
     sampling_interval(_sampling_interval),
+    sampling_stable_frames(_sampling_stable_frames),
+    sampling_clip_length(_sampling_clip_length),
+    burst_seconds(_burst_seconds),
+    preview_fps(_preview_fps),
+    monitor_fps(_monitor_fps),
+    detection_fps(_detection_fps),
+    show_hud(_show_hud),
+    hand_tracking(_hand_tracking),
+    sample_resize_sizes(_sample_resize_sizes),
+    sample_orig_codec(_sample_orig_codec),
+    sample_orig_compression(_sample_orig_compression),
+    sample_dedup_mode(_sample_dedup_mode),
+    sample_dedup_distance(_sample_dedup_distance),
+    record_sessions(_record_sessions),
+    stream_landmarks(_stream_landmarks),
     gesture_selected(_gesture_selected),
     sample_storage_path(_sample_storage_path),
     gesture_list(_gesture_list),
     version(_version),
-    _settings(new QSettings(QSettings::IniFormat,
-                                          SETTING_SCOPE,
-                                          SETTING_ORGANIZATION_NAME,
-                                          SETTING_APPLICATION_NAME))
+    _settings(_config_file.isEmpty() ? new QSettings(QSettings::IniFormat,
+                                                     SETTING_SCOPE,
+                                                     SETTING_ORGANIZATION_NAME,
+                                                     SETTING_APPLICATION_NAME)
+                                     : new QSettings(_config_file, QSettings::IniFormat)),
+    _sync_timer(new QTimer(this))
 {
+    _sync_timer->setSingleShot(true);
+    _sync_timer->setInterval(SETTING_SYNC_DELAY);
+    connect(_sync_timer, SIGNAL(timeout()), this, SLOT(sync()));
+    if (QCoreApplication::instance() != nullptr)
+        connect(QCoreApplication::instance(), SIGNAL(aboutToQuit()), this, SLOT(sync()));
+
     _roi_start_x = _settings->value("roi-start-x", DEFAULT_ROI_START_X).toInt();
     _roi_end_x = _settings->value("roi-end-x", DEFAULT_ROI_END_X).toInt();
     _roi_start_y = _settings->value("roi-start-y", DEFAULT_ROI_START_Y).toInt();
@@ -46,11 +88,43 @@ Settings::Settings(QObject * parent) :
     _skin_color_max_H = _settings->value("skin-color-max-H", DEFAULT_SKIN_COLOR_MAX_H).toInt();
     _skin_color_max_S = _settings->value("skin-color-max-S", DEFAULT_SKIN_COLOR_MAX_S).toInt();
     _skin_color_max_V = _settings->value("skin-color-max-V", DEFAULT_SKIN_COLOR_MAX_V).toInt();
+    _skin_color_ycrcb = _settings->value("skin-color-ycrcb", DEFAULT_SKIN_COLOR_YCRCB).toBool();
+    _skin_color_min_Y = _settings->value("skin-color-min-Y", DEFAULT_SKIN_COLOR_MIN_Y).toInt();
+    _skin_color_min_Cr = _settings->value("skin-color-min-Cr", DEFAULT_SKIN_COLOR_MIN_CR).toInt();
+    _skin_color_min_Cb = _settings->value("skin-color-min-Cb", DEFAULT_SKIN_COLOR_MIN_CB).toInt();
+    _skin_color_max_Y = _settings->value("skin-color-max-Y", DEFAULT_SKIN_COLOR_MAX_Y).toInt();
+    _skin_color_max_Cr = _settings->value("skin-color-max-Cr", DEFAULT_SKIN_COLOR_MAX_CR).toInt();
+    _skin_color_max_Cb = _settings->value("skin-color-max-Cb", DEFAULT_SKIN_COLOR_MAX_CB).toInt();
     _skin_detection_area = _settings->value("skin-detection-area", DEFAULT_SKIN_DETECTION_AREA).toInt();
     _skin_morphology = _settings->value("skin-morphology", DEFAULT_SKIN_MORPHOLOGY).toBool();
 
     _sampling_amount_per_time = _settings->value("sampling-amount-per-time", DEFAULT_SAMPLING_AMOUNT_PER_TIME).toInt();
     _sampling_interval = _settings->value("sampling-interval", DEFAULT_SAMPLING_INTERVAL).toInt();
+    _sampling_stable_frames = qMax(0, _settings->value("sampling-stable-frames", DEFAULT_SAMPLING_STABLE_FRAMES).toInt());
+    _sampling_clip_length = qBound(0, _settings->value("sampling-clip-length", DEFAULT_SAMPLING_CLIP_LENGTH).toInt(),
+                                   SAMPLING_CLIP_MAX_LENGTH);
+    _burst_seconds = qBound(0, _settings->value("burst-seconds", DEFAULT_BURST_SECONDS).toInt(), BURST_MAX_SECONDS);
+    _preview_fps = qBound(1, _settings->value("preview-fps", DEFAULT_PREVIEW_FPS).toInt(), CAMERA_FPS);
+    _monitor_fps = qBound(1, _settings->value("monitor-fps", DEFAULT_MONITOR_FPS).toInt(), CAMERA_FPS);
+    _detection_fps = qBound(1, _settings->value("detection-fps", DEFAULT_DETECTION_FPS).toInt(), CAMERA_FPS);
+    _show_hud = _settings->value("show-hud", DEFAULT_SHOW_HUD).toBool();
+    _hand_tracking = _settings->value("hand-tracking", DEFAULT_HAND_TRACKING).toBool();
+    for (const auto &size : _settings->value("sample-resize-sizes", DEFAULT_SAMPLE_RESIZE_SIZES).toString().split(',', QString::SkipEmptyParts))
+    {
+        int s = size.trimmed().toInt();
+        if (s > 0 && !_sample_resize_sizes.contains(s))
+            _sample_resize_sizes.append(s);
+    }
+    _sample_orig_codec = _settings->value("sample-orig-codec", DEFAULT_SAMPLE_ORIG_CODEC).toString().toUpper();
+    if (!sample_orig_codecs.contains(_sample_orig_codec))
+        _sample_orig_codec = DEFAULT_SAMPLE_ORIG_CODEC;
+    _sample_orig_compression = qBound(0, _settings->value("sample-orig-compression", DEFAULT_SAMPLE_ORIG_COMPRESSION).toInt(), 9);
+    _sample_dedup_mode = _settings->value("sample-dedup-mode", DEFAULT_SAMPLE_DEDUP_MODE).toString().toUpper();
+    if (!sample_dedup_modes.contains(_sample_dedup_mode))
+        _sample_dedup_mode = DEFAULT_SAMPLE_DEDUP_MODE;
+    _sample_dedup_distance = qBound(0, _settings->value("sample-dedup-distance", DEFAULT_SAMPLE_DEDUP_DISTANCE).toInt(), 64);
+    _record_sessions = _settings->value("record-sessions", DEFAULT_RECORD_SESSIONS).toBool();
+    _stream_landmarks = _settings->value("stream-landmarks", DEFAULT_STREAM_LANDMARKS).toBool();
     _gesture_selected = _settings->value("gesture-selected", 0).toInt();
     _sample_storage_path = _settings->value("sample-storage-path").toString();
 
@@ -61,91 +135,257 @@ Settings::Settings(QObject * parent) :
 
 Settings::~Settings()
 {
+    sync();
     delete _settings;
 }
 
+void Settings::sync()
+{
+    _sync_timer->stop();
+    if (_pending.isEmpty())
+        return;
+    for (auto it = _pending.constBegin(); it != _pending.constEnd(); ++it)
+        _settings->setValue(it.key(), it.value());
+    _pending.clear();
+    _settings->sync();
+}
+
+void Settings::_store(const QString &key, const QVariant &value)
+{
+    _pending.insert(key, value);
+    if (!_sync_timer->isActive())
+        _sync_timer->start();
+}
+
 void Settings::setRoiStartX(const int &x)
 {
     _roi_start_x = x;
-    _settings->setValue("roi-start-x", x);
+    _store("roi-start-x", x);
 }
 
 void Settings::setRoiEndX(const int &x)
 {
     _roi_end_x = x;
-    _settings->setValue("roi-end-x", x);
+    _store("roi-end-x", x);
 }
 
 void Settings::setRoiStartY(const int &y)
 {
     _roi_start_y = y;
-    _settings->setValue("roi-start-y", y);
+    _store("roi-start-y", y);
 }
 
 void Settings::setRoiEndY(const int &y)
 {
     _roi_end_y = y;
-    _settings->setValue("roi-end-y", y);
+    _store("roi-end-y", y);
 }
 
 void Settings::setSkinColorMinH(const int &h)
 {
     _skin_color_min_H = h;
-    _settings->setValue("skin-color-min-H", h);
+    _store("skin-color-min-H", h);
 }
 
 void Settings::setSkinColorMinS(const int &s)
 {
-    _skin_color_min_H = s;
-    _settings->setValue("skin-color-min-S", s);
+    _skin_color_min_S = s;
+    _store("skin-color-min-S", s);
 }
 
 void Settings::setSkinColorMinV(const int &v)
 {
     _skin_color_min_V = v;
-    _settings->setValue("skin-color-min-V", v);
+    _store("skin-color-min-V", v);
 }
 
 void Settings::setSkinColorMaxH(const int &h)
 {
     _skin_color_max_H = h;
-    _settings->setValue("skin-color-max-H", h);
+    _store("skin-color-max-H", h);
 }
 
 void Settings::setSkinColorMaxS(const int &s)
 {
     _skin_color_max_S = s;
-    _settings->setValue("skin-color-max-S", s);
+    _store("skin-color-max-S", s);
 }
 
 void Settings::setSkinColorMaxV(const int &v)
 {
     _skin_color_max_V = v;
-    _settings->setValue("skin-color-max-V", v);
+    _store("skin-color-max-V", v);
+}
+
+void Settings::setSkinColorYCrCb(const bool &ycrcb)
+{
+    _skin_color_ycrcb = ycrcb;
+    _store("skin-color-ycrcb", ycrcb);
+}
+
+void Settings::setSkinColorMinY(const int &y)
+{
+    _skin_color_min_Y = y;
+    _store("skin-color-min-Y", y);
+}
+
+void Settings::setSkinColorMinCr(const int &cr)
+{
+    _skin_color_min_Cr = cr;
+    _store("skin-color-min-Cr", cr);
+}
+
+void Settings::setSkinColorMinCb(const int &cb)
+{
+    _skin_color_min_Cb = cb;
+    _store("skin-color-min-Cb", cb);
+}
+
+void Settings::setSkinColorMaxY(const int &y)
+{
+    _skin_color_max_Y = y;
+    _store("skin-color-max-Y", y);
+}
+
+void Settings::setSkinColorMaxCr(const int &cr)
+{
+    _skin_color_max_Cr = cr;
+    _store("skin-color-max-Cr", cr);
+}
+
+void Settings::setSkinColorMaxCb(const int &cb)
+{
+    _skin_color_max_Cb = cb;
+    _store("skin-color-max-Cb", cb);
 }
 
 void Settings::setSkinDetectionArea(const int &area)
 {
     _skin_detection_area = area;
-    _settings->setValue("skin-detection-area", area);
+    _store("skin-detection-area", area);
 }
 
 void Settings::setSkinMorphology(const bool &perform_morphology)
 {
     _skin_morphology = perform_morphology;
-    _settings->setValue("skin-morphology", perform_morphology);
+    _store("skin-morphology", perform_morphology);
 }
 
 void Settings::setSamplingAmountPerTime(const int &amount)
 {
     _sampling_amount_per_time = amount;
-    _settings->setValue("sampling-amount-per-time", amount);
+    _store("sampling-amount-per-time", amount);
 }
 
 void Settings::setSamplingInterval(const int &ms)
 {
     _sampling_interval = ms;
-    _settings->setValue("sampling-interval", ms);
+    _store("sampling-interval", ms);
+}
+
+void Settings::setSamplingStableFrames(const int &frames)
+{
+    _sampling_stable_frames = qMax(0, frames);
+    _store("sampling-stable-frames", _sampling_stable_frames);
+}
+
+void Settings::setSamplingClipLength(const int &frames)
+{
+    _sampling_clip_length = qBound(0, frames, SAMPLING_CLIP_MAX_LENGTH);
+    _store("sampling-clip-length", _sampling_clip_length);
+}
+
+void Settings::setBurstSeconds(const int &seconds)
+{
+    _burst_seconds = qBound(0, seconds, BURST_MAX_SECONDS);
+    _store("burst-seconds", _burst_seconds);
+}
+
+void Settings::setPreviewFps(const int &fps)
+{
+    _preview_fps = qBound(1, fps, CAMERA_FPS);
+    _store("preview-fps", _preview_fps);
+}
+
+void Settings::setMonitorFps(const int &fps)
+{
+    _monitor_fps = qBound(1, fps, CAMERA_FPS);
+    _store("monitor-fps", _monitor_fps);
+}
+
+void Settings::setDetectionFps(const int &fps)
+{
+    _detection_fps = qBound(1, fps, CAMERA_FPS);
+    _store("detection-fps", _detection_fps);
+}
+
+void Settings::setShowHud(const bool &show)
+{
+    _show_hud = show;
+    _store("show-hud", show);
+}
+
+void Settings::setHandTracking(const bool &track)
+{
+    _hand_tracking = track;
+    _store("hand-tracking", track);
+}
+
+void Settings::setSampleResizeSizes(const QList<int> &sizes)
+{
+    QStringList list;
+    _sample_resize_sizes.clear();
+    for (const auto &s : sizes)
+    {
+        if (s > 0 && !_sample_resize_sizes.contains(s))
+        {
+            _sample_resize_sizes.append(s);
+            list.append(QString::number(s));
+        }
+    }
+    _store("sample-resize-sizes", list.join(','));
+}
+
+void Settings::setSampleOrigCodec(const QString &codec)
+{
+    QString c = codec.toUpper();
+    if (!sample_orig_codecs.contains(c))
+        return;
+    _sample_orig_codec = c;
+    _store("sample-orig-codec", c);
+}
+
+void Settings::setSampleOrigCompression(const int &level)
+{
+    _sample_orig_compression = qBound(0, level, 9);
+    _store("sample-orig-compression", _sample_orig_compression);
+}
+
+void Settings::setSampleDedupMode(const QString &mode)
+{
+    QString m = mode.toUpper();
+    if (!sample_dedup_modes.contains(m))
+        return;
+    _sample_dedup_mode = m;
+    _store("sample-dedup-mode", m);
+}
+
+void Settings::setSampleDedupDistance(const int &distance)
+{
+    _sample_dedup_distance = qBound(0, distance, 64);
+    _store("sample-dedup-distance", _sample_dedup_distance);
+}
+
+void Settings::setRecordSessions(const bool &record)
+{
+    _record_sessions = record;
+    _store("record-sessions", record);
+}
+
+void Settings::setStreamLandmarks(const bool &stream)
+{
+    _stream_landmarks = stream;
+    _store("stream-landmarks", stream);
 }
 
 void Settings::setSelectedGesture(const int &index)
@@ -153,13 +393,13 @@ void Settings::setSelectedGesture(const int &index)
     if (index < 0)
         return;
     _gesture_selected = index;
-    _settings->setValue("gesture-selected", index);
+    _store("gesture-selected", index);
 }
 
 void Settings::setSampleStoragePath(const QString &path)
 {
     _sample_storage_path = path;
-    _settings->setValue("sample-storage-path", path);
+    _store("sample-storage-path", path);
 }
 
 QString Settings::filterGestureName(const QString & text)
@@ -174,7 +414,7 @@ bool Settings::modifyGestureName(const int &index, const QString &new_name)
         if (_gesture_list.contains(new_name))
             return false;
         _gesture_list[index] = new_name;
-        _settings->setValue("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
+        _store("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
         return true;
     }
     return false;
@@ -187,7 +427,7 @@ int Settings::addGestrue(const QString &gesture_name)
         if (_gesture_list.contains(gesture_name))
             return _gesture_list.lastIndexOf(gesture_name);
         _gesture_list.append(gesture_name);
-        _settings->setValue("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
+        _store("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
     }
     return _gesture_list.size() - 1;
 }
@@ -197,16 +437,16 @@ void Settings::removeGesture(const int &index)
     if (_gesture_list.size() > index && index > -1)
     {
         _gesture_list.removeAt(index);
-        _settings->setValue("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
+        _store("gesture-list", _gesture_list.join(SETTING_STRING_DELIMITER));
         if (index == _gesture_selected)
         {
             _gesture_selected = 0;
-            _settings->setValue("gesture-selected", 0);
+            _store("gesture-selected", 0);
         }
         else if (index > _gesture_selected)
         {
             _gesture_selected -= 1;
-            _settings->setValue("gesture-selected", _gesture_selected);
+            _store("gesture-selected", _gesture_selected);
         }
     }
 }
@@ -9,6 +9,9 @@
 
 #include <QObject>
 #include <QSettings>
+#include <QTimer>
+#include <QHash>
+#include <QVariant>
 #include <iostream>
 #include "config.h"
 #include "Singleton.hpp"
@@ -28,6 +31,14 @@ public:
      * @return the singleton instance of this class
      */
     static Settings *getInstance();
+    /**
+     * @brief setConfigFile makes the settings read from and written to the given INI file instead of the settings of the user.
+     *
+     * It takes effect only if called before the first call of #Settings::getInstance .
+     *
+     * @param file_path : path of the INI file, whose keys are the same as the settings of the user
+     */
+    static void setConfigFile(const QString &file_path);
     ~Settings();
 
     /**
@@ -120,6 +131,69 @@ public:
      * @param v : new upper bound of value in HSV color space
      */
     void setSkinColorMaxV(const int &v);
+    /**
+     * @brief skin_color_ycrcb is the flag of filtering skin colors in YCrCb color space instead of HSV color space.
+     */
+    const bool &skin_color_ycrcb;
+    /**
+     * @brief setSkinColorYCrCb sets the flag of filtering skin colors in YCrCb color space.
+     * @param ycrcb : filter in YCrCb color space or not
+     */
+    void setSkinColorYCrCb(const bool &ycrcb);
+    /**
+     * @brief skin_color_min_Y is the current lower bound of skin color filter for luma in YCrCb color space.
+     */
+    const int &skin_color_min_Y;
+    /**
+     * @brief setSkinColorMinY sets the lower bound of skin color filter for luma in YCrCb color space.
+     * @param y : new lower bound of luma in YCrCb color space
+     */
+    void setSkinColorMinY(const int &y);
+    /**
+     * @brief skin_color_min_Cr is the current lower bound of skin color filter for red difference in YCrCb color space.
+     */
+    const int &skin_color_min_Cr;
+    /**
+     * @brief setSkinColorMinCr sets the lower bound of skin color filter for red difference in YCrCb color space.
+     * @param cr : new lower bound of red difference in YCrCb color space
+     */
+    void setSkinColorMinCr(const int &cr);
+    /**
+     * @brief skin_color_min_Cb is the current lower bound of skin color filter for blue difference in YCrCb color space.
+     */
+    const int &skin_color_min_Cb;
+    /**
+     * @brief setSkinColorMinCb sets the lower bound of skin color filter for blue difference in YCrCb color space.
+     * @param cb : new lower bound of blue difference in YCrCb color space
+     */
+    void setSkinColorMinCb(const int &cb);
+    /**
+     * @brief skin_color_max_Y is the current upper bound of skin color filter for luma in YCrCb color space.
+     */
+    const int &skin_color_max_Y;
+    /**
+     * @brief setSkinColorMaxY sets the upper bound of skin color filter for luma in YCrCb color space.
+     * @param y : new upper bound of luma in YCrCb color space
+     */
+    void setSkinColorMaxY(const int &y);
+    /**
+     * @brief skin_color_max_Cr is the current upper bound of skin color filter for red difference in YCrCb color space.
+     */
+    const int &skin_color_max_Cr;
+    /**
+     * @brief setSkinColorMaxCr sets the upper bound of skin color filter for red difference in YCrCb color space.
+     * @param cr : new upper bound of red difference in YCrCb color space
+     */
+    void setSkinColorMaxCr(const int &cr);
+    /**
+     * @brief skin_color_max_Cb is the current upper bound of skin color filter for blue difference in YCrCb color space.
+     */
+    const int &skin_color_max_Cb;
+    /**
+     * @brief setSkinColorMaxCb sets the upper bound of skin color filter for blue difference in YCrCb color space.
+     * @param cb : new upper bound of blue difference in YCrCb color space
+     */
+    void setSkinColorMaxCb(const int &cb);
     /**
      * @brief skin_detection_area is the current minimum area of contour who is considered the contour of hand.
      */
@@ -156,6 +230,164 @@ public:
      * @param ms : the interval in milliseconds.
      */
     void setSamplingInterval(const int &ms);
+    /**
+     * @brief sampling_stable_frames is the number of consecutive frames on which the hand should stay still before a sample is taken.
+     *
+     * @see #StabilityTrigger
+     */
+    const int &sampling_stable_frames;
+    /**
+     * @brief setSamplingStableFrames sets the number of consecutive frames on which the hand should stay still before a sample is taken.
+     * @param frames : the number of frames, or 0 to take samples at #Settings::sampling_interval regardless
+     */
+    void setSamplingStableFrames(const int &frames);
+    /**
+     * @brief sampling_clip_length is the number of consecutive frames stored as one clip per sampling action.
+     *
+     * @see #ClipCodec
+     */
+    const int &sampling_clip_length;
+    /**
+     * @brief setSamplingClipLength sets the number of consecutive frames stored as one clip per sampling action.
+     * @param frames : the number of frames, at most #SAMPLING_CLIP_MAX_LENGTH , or 0 to take a still per sampling action
+     */
+    void setSamplingClipLength(const int &frames);
+    /**
+     * @brief burst_seconds is the length of the frames kept before sampling starts, which are stored first once it starts.
+     *
+     * @see #BurstBuffer
+     */
+    const int &burst_seconds;
+    /**
+     * @brief setBurstSeconds sets the length of the frames kept before sampling starts.
+     * @param seconds : from 0, keeping no frame, to #BURST_MAX_SECONDS
+     */
+    void setBurstSeconds(const int &seconds);
+    /**
+     * @brief preview_fps is the refresh rate of the video shown on the main window.
+     */
+    const int &preview_fps;
+    /**
+     * @brief setPreviewFps sets the refresh rate of the video shown on the main window.
+     * @param fps : frames per second, from 1 to #CAMERA_FPS
+     */
+    void setPreviewFps(const int &fps);
+    /**
+     * @brief monitor_fps is the refresh rate of the images shown on the monitor window.
+     */
+    const int &monitor_fps;
+    /**
+     * @brief setMonitorFps sets the refresh rate of the images shown on the monitor window.
+     * @param fps : frames per second, from 1 to #CAMERA_FPS
+     */
+    void setMonitorFps(const int &fps);
+    /**
+     * @brief detection_fps is the rate of detecting hands while not sampling.
+     */
+    const int &detection_fps;
+    /**
+     * @brief setDetectionFps sets the rate of detecting hands while not sampling.
+     * @param fps : frames per second, from 1 to #CAMERA_FPS
+     */
+    void setDetectionFps(const int &fps);
+    /**
+     * @brief show_hud is the flag of showing the performance HUD over the video on the main window.
+     */
+    const bool &show_hud;
+    /**
+     * @brief setShowHud sets the flag of showing the performance HUD.
+     * @param show : show the HUD or not
+     */
+    void setShowHud(const bool &show);
+    /**
+     * @brief hand_tracking is the flag of tracking a detected hand between full detections for the monitor window.
+     */
+    const bool &hand_tracking;
+    /**
+     * @brief setHandTracking sets the flag of tracking a detected hand between full detections.
+     * @param track : track hands or not
+     */
+    void setHandTracking(const bool &track);
+    /**
+     * @brief sample_resize_sizes is the sizes to which a sample is resized additionally.
+     *
+     * Each resized sample is stored in the directory named by its size. No resizing is done if it is empty.
+     */
+    const QList<int> &sample_resize_sizes;
+    /**
+     * @brief setSampleResizeSizes sets the sizes to which a sample is resized additionally.
+     * @param sizes : the width and height of the resized samples. Invalid or repeated sizes are ignored.
+     */
+    void setSampleResizeSizes(const QList<int> &sizes);
+    /**
+     * @brief sample_orig_codec is the codec, `BMP`, `PNG`, `WEBP` or `QOI`, using which to store the original sample images.
+     */
+    const QString &sample_orig_codec;
+    /**
+     * @brief setSampleOrigCodec sets the codec using which to store the original sample images.
+     * @param codec : one of `BMP`, `PNG`, `WEBP` and `QOI`. An unknown codec is ignored.
+     */
+    void setSampleOrigCodec(const QString &codec);
+    /**
+     * @brief sample_orig_compression is the compression level, from 0 to 9, used when the original sample images are stored as `PNG`.
+     */
+    const int &sample_orig_compression;
+    /**
+     * @brief setSampleOrigCompression sets the compression level of the `PNG` codec.
+     * @param level : from 0, fastest, to 9, smallest
+     */
+    void setSampleOrigCompression(const int &level);
+    /**
+     * @brief sample_dedup_mode is the treatment, `OFF`, `FLAG` or `SKIP`, of a sample nearly identical to a recent one.
+     *
+     * @see #SampleHashIndex
+     */
+    const QString &sample_dedup_mode;
+    /**
+     * @brief setSampleDedupMode sets the treatment of a sample nearly identical to a recent one.
+     * @param mode : one of #Settings::sample_dedup_modes
+     */
+    void setSampleDedupMode(const QString &mode);
+    /**
+     * @brief sample_dedup_distance is the maximum Hamming distance between the perceptual hashes of two samples
+     *        considered nearly identical.
+     */
+    const int &sample_dedup_distance;
+    /**
+     * @brief setSampleDedupDistance sets the maximum Hamming distance between two samples considered nearly identical.
+     * @param distance : from 0, identical hashes only, to 64
+     */
+    void setSampleDedupDistance(const int &distance);
+    /**
+     * @brief record_sessions is the flag of recording the frames of each sampling session into a lossless video.
+     *
+     * @see #SessionRecorder
+     */
+    const bool &record_sessions;
+    /**
+     * @brief setRecordSessions sets the flag of recording the frames of each sampling session.
+     * @param record : record sessions or not
+     */
+    void setRecordSessions(const bool &record);
+    /**
+     * @brief stream_landmarks is the flag of streaming the hand landmarks of each frame of a sampling session into a file.
+     *
+     * @see #LandmarkStream
+     */
+    const bool &stream_landmarks;
+    /**
+     * @brief setStreamLandmarks sets the flag of streaming the hand landmarks of sampling sessions.
+     * @param stream : stream landmarks or not
+     */
+    void setStreamLandmarks(const bool &stream);
+    /**
+     * @brief sample_orig_codecs is the list of the supported codecs of the original sample images.
+     */
+    static const QStringList sample_orig_codecs;
+    /**
+     * @brief sample_dedup_modes is the list of the treatments of nearly identical samples.
+     */
+    static const QStringList sample_dedup_modes;
     /**
      * @brief gesture_selected is the index of the gesture who is selected by default.
      *
@@ -219,13 +451,27 @@ public:
      */
     const QString &version;
 
+public slots:
+    /**
+     * @brief sync writes the changed settings into the setting file immediately.
+     *
+     * The setters change the settings in memory at once, but write them into the setting file
+     * #SETTING_SYNC_DELAY milliseconds after the first change, so that a slider being dragged costs no disk access.
+     * This function is called when the application quits and when this class is destroyed.
+     */
+    void sync();
+
 private:
     Settings(QObject * parent = 0);
     static Settings * createInstance();
+    static QString _config_file;
     Settings(const Settings &) = delete;
     Settings &operator=(const Settings &) = delete;
 
     QSettings * _settings;
+    QHash<QString, QVariant> _pending;
+    QTimer *_sync_timer;
+    void _store(const QString &key, const QVariant &value);
     int _roi_start_x;
     int _roi_end_x;
     int _roi_start_y;
@@ -236,10 +482,32 @@ private:
     int _skin_color_max_H;
     int _skin_color_max_S;
     int _skin_color_max_V;
+    bool _skin_color_ycrcb;
+    int _skin_color_min_Y;
+    int _skin_color_min_Cr;
+    int _skin_color_min_Cb;
+    int _skin_color_max_Y;
+    int _skin_color_max_Cr;
+    int _skin_color_max_Cb;
     int _skin_detection_area;
     bool _skin_morphology;
     int _sampling_amount_per_time;
     int _sampling_interval;
+    int _sampling_stable_frames;
+    int _sampling_clip_length;
+    int _burst_seconds;
+    int _preview_fps;
+    int _monitor_fps;
+    int _detection_fps;
+    bool _show_hud;
+    bool _hand_tracking;
+    QList<int> _sample_resize_sizes;
+    QString _sample_orig_codec;
+    int _sample_orig_compression;
+    QString _sample_dedup_mode;
+    int _sample_dedup_distance;
+    bool _record_sessions;
+    bool _stream_landmarks;
     int _gesture_selected;
     QString _sample_storage_path;
     QStringList _gesture_list;
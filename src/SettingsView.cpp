@@ -32,12 +32,35 @@ void SettingsView::setToCurrentSettings()
     _ui_sld_horizon1->setValue(_settings->roi_start_x);
     _ui_sld_horizon2->setValue(_settings->roi_end_x);
     _ui_sld_vertical1->setValue(_settings->roi_start_y);
+    _ui_box_ycrcb->setChecked(_settings->skin_color_ycrcb);
+    _ui_box_y1->setValue(_settings->skin_color_min_Y);
+    _ui_box_y2->setValue(_settings->skin_color_max_Y);
+    _ui_box_cr1->setValue(_settings->skin_color_min_Cr);
+    _ui_box_cr2->setValue(_settings->skin_color_max_Cr);
+    _ui_box_cb1->setValue(_settings->skin_color_min_Cb);
+    _ui_box_cb2->setValue(_settings->skin_color_max_Cb);
 
     blockSignals(false);
+    _emitSkinColorYCrCbChangeSignal();
     _ui_sld_value2->setValue(_settings->skin_color_max_V);
     _ui_sld_vertical2->setValue(_settings->roi_end_y);
     _ui_box_detection_area->setValue(_settings->skin_detection_area);
     _ui_box_morphology->setChecked(_settings->skin_morphology);
+    QStringList sizes;
+    for (const auto &size : _settings->sample_resize_sizes)
+        sizes.append(QString::number(size));
+    _ui_txt_resize_sizes->setText(sizes.join(','));
+    _ui_cmb_orig_codec->setCurrentText(_settings->sample_orig_codec);
+    _ui_box_orig_compression->setValue(_settings->sample_orig_compression);
+    _ui_cmb_dedup_mode->setCurrentText(_settings->sample_dedup_mode);
+    _ui_box_dedup_distance->setValue(_settings->sample_dedup_distance);
+    _ui_box_record_sessions->setChecked(_settings->record_sessions);
+    _ui_box_stream_landmarks->setChecked(_settings->stream_landmarks);
+    _ui_box_preview_fps->setValue(_settings->preview_fps);
+    _ui_box_monitor_fps->setValue(_settings->monitor_fps);
+    _ui_box_detection_fps->setValue(_settings->detection_fps);
+    _ui_box_hud->setChecked(_settings->show_hud);
+    _ui_box_tracking->setChecked(_settings->hand_tracking);
 }
 
 void SettingsView::setToDefaultSettings()
@@ -51,12 +74,32 @@ void SettingsView::setToDefaultSettings()
     _ui_sld_horizon1->setValue(DEFAULT_ROI_START_X);
     _ui_sld_horizon2->setValue(DEFAULT_ROI_END_X);
     _ui_sld_vertical1->setValue(DEFAULT_ROI_START_Y);
+    _ui_box_ycrcb->setChecked(DEFAULT_SKIN_COLOR_YCRCB);
+    _ui_box_y1->setValue(DEFAULT_SKIN_COLOR_MIN_Y);
+    _ui_box_y2->setValue(DEFAULT_SKIN_COLOR_MAX_Y);
+    _ui_box_cr1->setValue(DEFAULT_SKIN_COLOR_MIN_CR);
+    _ui_box_cr2->setValue(DEFAULT_SKIN_COLOR_MAX_CR);
+    _ui_box_cb1->setValue(DEFAULT_SKIN_COLOR_MIN_CB);
+    _ui_box_cb2->setValue(DEFAULT_SKIN_COLOR_MAX_CB);
 
     blockSignals(false);
+    _emitSkinColorYCrCbChangeSignal();
     _ui_sld_value2->setValue(DEFAULT_SKIN_COLOR_MAX_H);
     _ui_sld_vertical2->setValue(DEFAULT_ROI_END_Y);
     _ui_box_detection_area->setValue(DEFAULT_SKIN_DETECTION_AREA);
     _ui_box_morphology->setChecked(DEFAULT_SKIN_MORPHOLOGY);
+    _ui_txt_resize_sizes->setText(DEFAULT_SAMPLE_RESIZE_SIZES);
+    _ui_cmb_orig_codec->setCurrentText(DEFAULT_SAMPLE_ORIG_CODEC);
+    _ui_box_orig_compression->setValue(DEFAULT_SAMPLE_ORIG_COMPRESSION);
+    _ui_cmb_dedup_mode->setCurrentText(DEFAULT_SAMPLE_DEDUP_MODE);
+    _ui_box_dedup_distance->setValue(DEFAULT_SAMPLE_DEDUP_DISTANCE);
+    _ui_box_record_sessions->setChecked(DEFAULT_RECORD_SESSIONS);
+    _ui_box_stream_landmarks->setChecked(DEFAULT_STREAM_LANDMARKS);
+    _ui_box_preview_fps->setValue(DEFAULT_PREVIEW_FPS);
+    _ui_box_monitor_fps->setValue(DEFAULT_MONITOR_FPS);
+    _ui_box_detection_fps->setValue(DEFAULT_DETECTION_FPS);
+    _ui_box_hud->setChecked(DEFAULT_SHOW_HUD);
+    _ui_box_tracking->setChecked(DEFAULT_HAND_TRACKING);
 }
 
 void SettingsView::activatePage(const SettingsView::SETTINGS_VIEW_PAGE &page)
@@ -84,6 +127,21 @@ void SettingsView::syncSettings()
         _settings->setSkinColorMaxV(_ui_sld_value1->value() > _ui_sld_value2->value() ? _ui_sld_value1->value() : _ui_sld_value2->value());
         _flag_change_value = false;
     }
+    if (_flag_change_ycrcb)
+    {
+        _settings->setSkinColorYCrCb(_ui_box_ycrcb->isChecked());
+        _flag_change_ycrcb = false;
+    }
+    if (_flag_change_ycrcb_bounds)
+    {
+        _settings->setSkinColorMinY( qMin(_ui_box_y1->value(),  _ui_box_y2->value()));
+        _settings->setSkinColorMaxY( qMax(_ui_box_y1->value(),  _ui_box_y2->value()));
+        _settings->setSkinColorMinCr(qMin(_ui_box_cr1->value(), _ui_box_cr2->value()));
+        _settings->setSkinColorMaxCr(qMax(_ui_box_cr1->value(), _ui_box_cr2->value()));
+        _settings->setSkinColorMinCb(qMin(_ui_box_cb1->value(), _ui_box_cb2->value()));
+        _settings->setSkinColorMaxCb(qMax(_ui_box_cb1->value(), _ui_box_cb2->value()));
+        _flag_change_ycrcb_bounds = false;
+    }
     if (_flag_change_roi_x)
     {
         _settings->setRoiStartX(_ui_sld_horizon1->value() < _ui_sld_horizon2->value() ? _ui_sld_horizon1->value() : _ui_sld_horizon2->value());
@@ -106,6 +164,61 @@ void SettingsView::syncSettings()
         _settings->setSkinMorphology(_ui_box_morphology->isChecked());
         _flag_change_morphology = false;
     }
+    if (_flag_change_resize_sizes)
+    {
+        QList<int> sizes;
+        for (const auto &size : _ui_txt_resize_sizes->text().split(',', QString::SkipEmptyParts))
+            sizes.append(size.trimmed().toInt());
+        _settings->setSampleResizeSizes(sizes);
+        _flag_change_resize_sizes = false;
+    }
+    if (_flag_change_orig_codec)
+    {
+        _settings->setSampleOrigCodec(_ui_cmb_orig_codec->currentText());
+        _flag_change_orig_codec = false;
+    }
+    if (_flag_change_orig_compression)
+    {
+        _settings->setSampleOrigCompression(_ui_box_orig_compression->value());
+        _flag_change_orig_compression = false;
+    }
+    if (_flag_change_dedup_mode)
+    {
+        _settings->setSampleDedupMode(_ui_cmb_dedup_mode->currentText());
+        _flag_change_dedup_mode = false;
+    }
+    if (_flag_change_dedup_distance)
+    {
+        _settings->setSampleDedupDistance(_ui_box_dedup_distance->value());
+        _flag_change_dedup_distance = false;
+    }
+    if (_flag_change_record_sessions)
+    {
+        _settings->setRecordSessions(_ui_box_record_sessions->isChecked());
+        _flag_change_record_sessions = false;
+    }
+    if (_flag_change_stream_landmarks)
+    {
+        _settings->setStreamLandmarks(_ui_box_stream_landmarks->isChecked());
+        _flag_change_stream_landmarks = false;
+    }
+    if (_flag_change_refresh_rates)
+    {
+        _settings->setPreviewFps(_ui_box_preview_fps->value());
+        _settings->setMonitorFps(_ui_box_monitor_fps->value());
+        _settings->setDetectionFps(_ui_box_detection_fps->value());
+        _flag_change_refresh_rates = false;
+    }
+    if (_flag_change_hud)
+    {
+        _settings->setShowHud(_ui_box_hud->isChecked());
+        _flag_change_hud = false;
+    }
+    if (_flag_change_tracking)
+    {
+        _settings->setHandTracking(_ui_box_tracking->isChecked());
+        _flag_change_tracking = false;
+    }
 }
 
 void SettingsView::_uiSldHue1ValueChanged(const int &val)
@@ -168,6 +281,19 @@ void SettingsView::_uiSldValue2ValueChanged(const int &val)
     _emitSkinColorRangeChangeSignal();
 }
 
+void SettingsView::_uiBoxYCrCbToggled(const bool &checked)
+{
+    _flag_change_ycrcb = true;
+    _enableSkinColorBounds();
+    emit changeSkinColorYCrCb(checked);
+}
+
+void SettingsView::_uiBoxYCrCbBoundValueChanged(const int &)
+{
+    _flag_change_ycrcb_bounds = true;
+    _emitSkinColorYCrCbChangeSignal();
+}
+
 void SettingsView::_uiSldHorizon1ValueChanged(const int &val)
 {
     _flag_change_roi_x = true;
@@ -220,6 +346,61 @@ void SettingsView::_uiBoxMorphologyToggled(const bool &checked)
     emit changeMorphology(checked);
 }
 
+void SettingsView::_uiTxtResizeSizesChanged(const QString &)
+{
+    _flag_change_resize_sizes = true;
+}
+
+void SettingsView::_uiCmbOrigCodecChanged(const QString &codec)
+{
+    _flag_change_orig_codec = true;
+    _ui_box_orig_compression->setEnabled(codec == "PNG");
+}
+
+void SettingsView::_uiBoxOrigCompressionValueChanged(const int &)
+{
+    _flag_change_orig_compression = true;
+}
+
+void SettingsView::_uiCmbDedupModeChanged(const QString &mode)
+{
+    _flag_change_dedup_mode = true;
+    _ui_box_dedup_distance->setEnabled(mode != "OFF");
+}
+
+void SettingsView::_uiBoxDedupDistanceValueChanged(const int &)
+{
+    _flag_change_dedup_distance = true;
+}
+
+void SettingsView::_uiBoxRecordSessionsToggled(const bool &)
+{
+    _flag_change_record_sessions = true;
+}
+
+void SettingsView::_uiBoxStreamLandmarksToggled(const bool &)
+{
+    _flag_change_stream_landmarks = true;
+}
+
+void SettingsView::_uiBoxRefreshRateValueChanged(const int &)
+{
+    _flag_change_refresh_rates = true;
+    emit changeRefreshRates(_ui_box_preview_fps->value(), _ui_box_monitor_fps->value(), _ui_box_detection_fps->value());
+}
+
+void SettingsView::_uiBoxHudToggled(const bool &checked)
+{
+    _flag_change_hud = true;
+    emit changeHud(checked);
+}
+
+void SettingsView::_uiBoxTrackingToggled(const bool &checked)
+{
+    _flag_change_tracking = true;
+    emit changeTracking(checked);
+}
+
 void SettingsView::_emitSkinColorRangeChangeSignal()
 {
     emit changeSkinColorLowerBound(_ui_sld_hue1->value()        < _ui_sld_hue2->value()        ? _ui_sld_hue1->value() : _ui_sld_hue2->value(),
@@ -230,6 +411,28 @@ void SettingsView::_emitSkinColorRangeChangeSignal()
                                    _ui_sld_value1->value()      > _ui_sld_value2->value()      ? _ui_sld_value1->value() : _ui_sld_value2->value());
 }
 
+void SettingsView::_emitSkinColorYCrCbChangeSignal()
+{
+    emit changeSkinColorYCrCb(_ui_box_ycrcb->isChecked());
+    emit changeSkinColorYCrCbLowerBound(qMin(_ui_box_y1->value(),  _ui_box_y2->value()),
+                                        qMin(_ui_box_cr1->value(), _ui_box_cr2->value()),
+                                        qMin(_ui_box_cb1->value(), _ui_box_cb2->value()));
+    emit changeSkinColorYCrCbUpperBound(qMax(_ui_box_y1->value(),  _ui_box_y2->value()),
+                                        qMax(_ui_box_cr1->value(), _ui_box_cr2->value()),
+                                        qMax(_ui_box_cb1->value(), _ui_box_cb2->value()));
+}
+
+void SettingsView::_enableSkinColorBounds()
+{
+    // the bounds are not used by the calibrated filter, and only the ones of the selected color space are used otherwise
+    const bool ycrcb = _ui_box_ycrcb->isChecked();
+    for (auto sld : {_ui_sld_hue1, _ui_sld_hue2, _ui_sld_saturation1, _ui_sld_saturation2, _ui_sld_value1, _ui_sld_value2})
+        sld->setEnabled(!_skin_color_calibrated && !ycrcb);
+    for (auto box : {_ui_box_y1, _ui_box_y2, _ui_box_cr1, _ui_box_cr2, _ui_box_cb1, _ui_box_cb2})
+        box->setEnabled(!_skin_color_calibrated && ycrcb);
+    _ui_box_ycrcb->setEnabled(!_skin_color_calibrated);
+}
+
 void SettingsView::_emitRoiRangeChangeSignal()
 {
     emit changeRoiRange(_ui_sld_horizon1->value()  < _ui_sld_horizon2->value()  ? _ui_sld_horizon1->value() : _ui_sld_horizon2->value(),
@@ -250,14 +453,40 @@ void SettingsView::_backgroundClearingRequest()
     emit backgroundClearingRequest();
 }
 
+void SettingsView::_skinColorCalibrationRequest()
+{
+    _ui_btn_calibrate->setEnabled(false);
+    emit skinColorCalibrationRequest();
+}
+
+void SettingsView::_skinColorCalibrationClearingRequest()
+{
+    _ui_btn_calibration_clear->setEnabled(false);
+    emit skinColorCalibrationClearingRequest();
+}
+
+void SettingsView::setSkinColorCalibrated(const bool &calibrated)
+{
+    _ui_btn_calibrate->setEnabled(_ui_btn_bg_set->isEnabled());
+    _ui_btn_calibration_clear->setEnabled(calibrated);
+    _ui_btn_calibrate->setText(calibrated ? tr("Recalibrate") : tr("Calibrate"));
+    _skin_color_calibrated = calibrated;
+    _enableSkinColorBounds();
+}
+
 void SettingsView::enableBackgroundSetting()
 {
     _ui_btn_bg_set->setEnabled(true);
+    _ui_box_freeze_frame->setEnabled(true);
+    _ui_btn_calibrate->setEnabled(true);
 }
 
 void SettingsView::disableBackgroundSetting()
 {
     _ui_btn_bg_set->setEnabled(false);
+    _ui_btn_calibrate->setEnabled(false);
+    _ui_box_freeze_frame->setChecked(false);
+    _ui_box_freeze_frame->setEnabled(false);
 }
 
 void SettingsView::setBackgroundImage(const QPixmap &img)
@@ -394,6 +623,48 @@ void SettingsView::_setupUi()
     ui_group_skin_color_layout->addWidget(_ui_sld_hue2,             3, 0, 1, 1, Qt::AlignHCenter);
     ui_group_skin_color_layout->addWidget(_ui_sld_saturation2,      3, 1, 1, 1, Qt::AlignHCenter);
     ui_group_skin_color_layout->addWidget(_ui_sld_value2,           3, 2, 1, 1, Qt::AlignHCenter);
+    _ui_box_ycrcb = new QCheckBox(tr("Filter in YCrCb Color Space"));
+    _ui_box_ycrcb->setToolTip(tr("Use the ranges of Y, Cr and Cb below instead of the sliders. It is faster than HSV."));
+    QLabel * ui_lbl_y = new QLabel(tr("Y"));
+    QLabel * ui_lbl_cr = new QLabel(tr("Cr"));
+    QLabel * ui_lbl_cb = new QLabel(tr("Cb"));
+    _ui_box_y1 = new QSpinBox;
+    _ui_box_y2 = new QSpinBox;
+    _ui_box_cr1 = new QSpinBox;
+    _ui_box_cr2 = new QSpinBox;
+    _ui_box_cb1 = new QSpinBox;
+    _ui_box_cb2 = new QSpinBox;
+    for (auto box : {_ui_box_y1, _ui_box_y2, _ui_box_cr1, _ui_box_cr2, _ui_box_cb1, _ui_box_cb2})
+    {
+        box->setRange(0, 255);
+        box->setFocusPolicy(Qt::StrongFocus);
+        box->setStyleSheet("QSpinBox {outline:none}");
+    }
+    ui_group_skin_color_layout->addWidget(_ui_box_ycrcb,            4, 0, 1, 3);
+    ui_group_skin_color_layout->addWidget(ui_lbl_y,                 5, 0, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(ui_lbl_cr,                5, 1, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(ui_lbl_cb,                5, 2, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_y1,               6, 0, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_cr1,              6, 1, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_cb1,              6, 2, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_y2,               7, 0, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_cr2,              7, 1, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_box_cb2,              7, 2, 1, 1, Qt::AlignHCenter);
+    _ui_box_freeze_frame = new QCheckBox(tr("Freeze Frame"));
+    _ui_box_freeze_frame->setToolTip(tr("Tune the filter on the current frame. Sampling always uses live frames."));
+    ui_group_skin_color_layout->addWidget(_ui_box_freeze_frame,     8, 0, 1, 3);
+    _ui_btn_calibrate = new QPushButton(tr("Calibrate"));
+    _ui_btn_calibrate->setToolTip(tr("Learn the skin colors from the hand in the region of interesting"));
+    _ui_btn_calibration_clear = new QPushButton(tr("Clear"));
+    _ui_btn_calibration_clear->setToolTip(tr("Use the ranges of the sliders again"));
+    for (auto btn : {_ui_btn_calibrate, _ui_btn_calibration_clear})
+    {
+        btn->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
+        btn->setAutoDefault(false);
+        btn->setFocusPolicy(Qt::NoFocus);
+    }
+    ui_group_skin_color_layout->addWidget(_ui_btn_calibrate,        9, 0, 1, 1, Qt::AlignHCenter);
+    ui_group_skin_color_layout->addWidget(_ui_btn_calibration_clear, 9, 1, 1, 1, Qt::AlignHCenter);
     QGroupBox * ui_group_skin_color = new QGroupBox(tr("Skin Color Filter"));
     ui_group_skin_color->setLayout(ui_group_skin_color_layout);
 
@@ -436,13 +707,93 @@ void SettingsView::_setupUi()
     _ui_box_detection_area->setFocusPolicy(Qt::StrongFocus);
     _ui_box_detection_area->setStyleSheet("QSpinBox {outline:none}");
     _ui_box_morphology = new QCheckBox(tr("Morphological Transformation"));
+    QLabel * ui_lbl_resize_sizes = new QLabel(tr("Resize Samples to"));
+    _ui_txt_resize_sizes = new QLineEdit;
+    _ui_txt_resize_sizes->setPlaceholderText("128,64,32");
+    _ui_txt_resize_sizes->setToolTip(tr("Sizes, separated by comma, to which samples are resized additionally"));
+    _ui_txt_resize_sizes->setValidator(new QRegExpValidator(QRegExp("[0-9,]*"), _ui_txt_resize_sizes));
+    QLabel * ui_lbl_orig_codec = new QLabel(tr("Original Image Codec"));
+    _ui_cmb_orig_codec = new QComboBox;
+    _ui_cmb_orig_codec->addItems(Settings::sample_orig_codecs);
+    _ui_cmb_orig_codec->setToolTip(tr("Lossless codec by which the original sample images are stored"));
+    _ui_cmb_orig_codec->setFocusPolicy(Qt::StrongFocus);
+    QLabel * ui_lbl_orig_compression = new QLabel(tr("PNG Compression"));
+    _ui_box_orig_compression = new QSpinBox;
+    _ui_box_orig_compression->setRange(0, 9);
+    _ui_box_orig_compression->setToolTip(tr("Higher levels produce smaller files but take longer to encode"));
+    _ui_box_orig_compression->setFocusPolicy(Qt::StrongFocus);
+    _ui_box_orig_compression->setStyleSheet("QSpinBox {outline:none}");
+    _ui_box_orig_compression->setEnabled(_ui_cmb_orig_codec->currentText() == "PNG");
     QGridLayout * ui_group_others_layout = new QGridLayout;
     ui_group_others_layout->addWidget(ui_lbl_detection_area,  0, 0, 1, 1);
     ui_group_others_layout->addWidget(_ui_box_detection_area, 0, 1, 1, 1);
     ui_group_others_layout->addWidget(_ui_box_morphology,     1, 0, 1, 2);
+    ui_group_others_layout->addWidget(ui_lbl_resize_sizes,    2, 0, 1, 1);
+    ui_group_others_layout->addWidget(_ui_txt_resize_sizes,   2, 1, 1, 1);
+    ui_group_others_layout->addWidget(ui_lbl_orig_codec,      3, 0, 1, 1);
+    ui_group_others_layout->addWidget(_ui_cmb_orig_codec,     3, 1, 1, 1);
+    ui_group_others_layout->addWidget(ui_lbl_orig_compression,  4, 0, 1, 1);
+    ui_group_others_layout->addWidget(_ui_box_orig_compression, 4, 1, 1, 1);
+    _ui_box_record_sessions = new QCheckBox(tr("Record Sampling Sessions"));
+    _ui_box_record_sessions->setToolTip(tr("Record the frames of each sampling session into a lossless video beside the samples, "
+                                           "on which hands can be detected again later by the headless tool"));
+    ui_group_others_layout->addWidget(_ui_box_record_sessions,  5, 0, 1, 2);
+    _ui_box_stream_landmarks = new QCheckBox(tr("Stream Hand Landmarks of Sampling Sessions"));
+    _ui_box_stream_landmarks->setToolTip(tr("Write the palm, fingers and bounding box of the hand on every frame of each sampling session "
+                                            "into a compact binary file beside the samples, for dynamic gestures"));
+    ui_group_others_layout->addWidget(_ui_box_stream_landmarks, 6, 0, 1, 2);
+    QLabel * ui_lbl_dedup_mode = new QLabel(tr("Near-Duplicate Samples"));
+    _ui_cmb_dedup_mode = new QComboBox;
+    _ui_cmb_dedup_mode->addItems(Settings::sample_dedup_modes);
+    _ui_cmb_dedup_mode->setToolTip(tr("Flag in the manifest, or skip, a sample nearly identical to a recent one of the same gesture"));
+    _ui_cmb_dedup_mode->setFocusPolicy(Qt::StrongFocus);
+    QLabel * ui_lbl_dedup_distance = new QLabel(tr("Duplicate Distance"));
+    _ui_box_dedup_distance = new QSpinBox;
+    _ui_box_dedup_distance->setRange(0, 64);
+    _ui_box_dedup_distance->setToolTip(tr("Maximum number of different bits between the 64-bit hashes of two nearly identical samples"));
+    _ui_box_dedup_distance->setFocusPolicy(Qt::StrongFocus);
+    _ui_box_dedup_distance->setStyleSheet("QSpinBox {outline:none}");
+    _ui_box_dedup_distance->setEnabled(_ui_cmb_dedup_mode->currentText() != "OFF");
+    ui_group_others_layout->addWidget(ui_lbl_dedup_mode,        7, 0, 1, 1);
+    ui_group_others_layout->addWidget(_ui_cmb_dedup_mode,       7, 1, 1, 1);
+    ui_group_others_layout->addWidget(ui_lbl_dedup_distance,    8, 0, 1, 1);
+    ui_group_others_layout->addWidget(_ui_box_dedup_distance,   8, 1, 1, 1);
     QGroupBox * ui_group_others = new QGroupBox(tr("Miscellanea"));
     ui_group_others->setLayout(ui_group_others_layout);
 
+    QLabel * ui_lbl_preview_fps = new QLabel(tr("Preview"));
+    _ui_box_preview_fps = new QSpinBox;
+    _ui_box_preview_fps->setToolTip(tr("Refresh rate of the video on the main window"));
+    QLabel * ui_lbl_monitor_fps = new QLabel(tr("Monitor"));
+    _ui_box_monitor_fps = new QSpinBox;
+    _ui_box_monitor_fps->setToolTip(tr("Refresh rate of the images on the monitor window"));
+    QLabel * ui_lbl_detection_fps = new QLabel(tr("Detection"));
+    _ui_box_detection_fps = new QSpinBox;
+    _ui_box_detection_fps->setToolTip(tr("Rate of detecting hands for the monitor window. Sampling always detects on every frame."));
+    for (auto box : {_ui_box_preview_fps, _ui_box_monitor_fps, _ui_box_detection_fps})
+    {
+        box->setRange(1, CAMERA_FPS);
+        box->setSuffix(" fps");
+        box->setFocusPolicy(Qt::StrongFocus);
+        box->setStyleSheet("QSpinBox {outline:none}");
+    }
+    QGridLayout * ui_group_refresh_rates_layout = new QGridLayout;
+    ui_group_refresh_rates_layout->addWidget(ui_lbl_preview_fps,    0, 0, 1, 1);
+    ui_group_refresh_rates_layout->addWidget(_ui_box_preview_fps,   0, 1, 1, 1);
+    ui_group_refresh_rates_layout->addWidget(ui_lbl_monitor_fps,    0, 2, 1, 1);
+    ui_group_refresh_rates_layout->addWidget(_ui_box_monitor_fps,   0, 3, 1, 1);
+    ui_group_refresh_rates_layout->addWidget(ui_lbl_detection_fps,  0, 4, 1, 1);
+    ui_group_refresh_rates_layout->addWidget(_ui_box_detection_fps, 0, 5, 1, 1);
+    _ui_box_hud = new QCheckBox(tr("Show Performance HUD on the Video"));
+    _ui_box_hud->setToolTip(tr("Capture rate, detection latency, writer queue, dropped frames and disk throughput"));
+    ui_group_refresh_rates_layout->addWidget(_ui_box_hud,           1, 0, 1, 6);
+    _ui_box_tracking = new QCheckBox(tr("Track Hands between Detections"));
+    _ui_box_tracking->setToolTip(tr("Follow a detected hand by optical flow for the monitor window and detect it again every %1 frames or once lost. "
+                                    "Sampling always detects on every frame.").arg(TRACKING_INTERVAL));
+    ui_group_refresh_rates_layout->addWidget(_ui_box_tracking,      2, 0, 1, 6);
+    QGroupBox * ui_group_refresh_rates = new QGroupBox(tr("Refresh Rates"));
+    ui_group_refresh_rates->setLayout(ui_group_refresh_rates_layout);
+
     _ui_btn_general_reset = new QPushButton(tr("Reset"));
     _ui_btn_general_default = new QPushButton(tr("Reset to Default"));
     _ui_btn_general_reset->setSizePolicy(QSizePolicy::Fixed, QSizePolicy::Fixed);
@@ -463,6 +814,7 @@ void SettingsView::_setupUi()
     ui_general_page_layout->addWidget(ui_group_skin_color);
     ui_general_page_layout->addWidget(ui_group_roi);
     ui_general_page_layout->addWidget(ui_group_others);
+    ui_general_page_layout->addWidget(ui_group_refresh_rates);
     ui_general_page_layout->addLayout(ui_general_page_button_box);
     QWidget * ui_general_page = new QWidget;
     ui_general_page->setLayout(ui_general_page_layout);
@@ -540,11 +892,38 @@ void SettingsView::_setupUi()
     ui_lbl_hue->setFont(font);
     ui_lbl_saturation->setFont(font);
     ui_lbl_value->setFont(font);
+    _ui_box_ycrcb->setFont(font);
+    ui_lbl_y->setFont(font);
+    ui_lbl_cr->setFont(font);
+    ui_lbl_cb->setFont(font);
+    for (auto box : {_ui_box_y1, _ui_box_y2, _ui_box_cr1, _ui_box_cr2, _ui_box_cb1, _ui_box_cb2})
+        box->setFont(font);
     ui_lbl_horizon->setFont(font);
     ui_lbl_vertical->setFont(font);
     ui_lbl_detection_area->setFont(font);
     _ui_box_detection_area->setFont(font);
     _ui_box_morphology->setFont(font);
+    _ui_box_freeze_frame->setFont(font);
+    ui_lbl_resize_sizes->setFont(font);
+    _ui_txt_resize_sizes->setFont(font);
+    ui_lbl_orig_codec->setFont(font);
+    _ui_cmb_orig_codec->setFont(font);
+    ui_lbl_orig_compression->setFont(font);
+    _ui_box_orig_compression->setFont(font);
+    ui_lbl_dedup_mode->setFont(font);
+    _ui_cmb_dedup_mode->setFont(font);
+    ui_lbl_dedup_distance->setFont(font);
+    _ui_box_dedup_distance->setFont(font);
+    _ui_box_record_sessions->setFont(font);
+    _ui_box_stream_landmarks->setFont(font);
+    ui_lbl_preview_fps->setFont(font);
+    _ui_box_preview_fps->setFont(font);
+    ui_lbl_monitor_fps->setFont(font);
+    _ui_box_monitor_fps->setFont(font);
+    ui_lbl_detection_fps->setFont(font);
+    _ui_box_detection_fps->setFont(font);
+    _ui_box_hud->setFont(font);
+    _ui_box_tracking->setFont(font);
     if (font.pixelSize() < 0)
     {
         if (font.pointSize() > 8)
@@ -560,6 +939,10 @@ void SettingsView::_setupUi()
 
     _ui_btn_bg_set->setEnabled(false);
     _ui_btn_bg_clear->setEnabled(false);
+    _ui_box_freeze_frame->setEnabled(false);
+    _ui_btn_calibrate->setEnabled(false);
+    _ui_btn_calibration_clear->setEnabled(false);
+    _enableSkinColorBounds();
 
     setFixedSize(minimumSize());
     setWindowTitle(tr("Settings"));
@@ -573,16 +956,34 @@ void SettingsView::_makeConnections()
     connect(_ui_sld_saturation2,    SIGNAL(valueChanged(int)), this, SLOT(_uiSldSaturation2ValueChanged(int)));
     connect(_ui_sld_value1,         SIGNAL(valueChanged(int)), this, SLOT(_uiSldValue1ValueChanged(int)));
     connect(_ui_sld_value2,         SIGNAL(valueChanged(int)), this, SLOT(_uiSldValue2ValueChanged(int)));
+    connect(_ui_box_ycrcb,          SIGNAL(toggled(bool)),     this, SLOT(_uiBoxYCrCbToggled(bool)));
+    for (auto box : {_ui_box_y1, _ui_box_y2, _ui_box_cr1, _ui_box_cr2, _ui_box_cb1, _ui_box_cb2})
+        connect(box,                SIGNAL(valueChanged(int)), this, SLOT(_uiBoxYCrCbBoundValueChanged(int)));
     connect(_ui_sld_horizon1,       SIGNAL(valueChanged(int)), this, SLOT(_uiSldHorizon1ValueChanged(int)));
     connect(_ui_sld_horizon2,       SIGNAL(valueChanged(int)), this, SLOT(_uiSldHorizon2ValueChanged(int)));
     connect(_ui_sld_vertical1,      SIGNAL(valueChanged(int)), this, SLOT(_uiSldVertical1ValueChanged(int)));
     connect(_ui_sld_vertical2,      SIGNAL(valueChanged(int)), this, SLOT(_uiSldVertical2ValueChanged(int)));
     connect(_ui_box_detection_area, SIGNAL(valueChanged(int)), this, SLOT(_uiBoxDetectionAreaValueChanged(int)));
     connect(_ui_box_morphology,     SIGNAL(toggled(bool)),     this, SLOT(_uiBoxMorphologyToggled(bool)));
+    connect(_ui_txt_resize_sizes,   SIGNAL(textChanged(QString)), this, SLOT(_uiTxtResizeSizesChanged(QString)));
+    connect(_ui_cmb_orig_codec,     SIGNAL(currentTextChanged(QString)), this, SLOT(_uiCmbOrigCodecChanged(QString)));
+    connect(_ui_box_orig_compression, SIGNAL(valueChanged(int)), this, SLOT(_uiBoxOrigCompressionValueChanged(int)));
+    connect(_ui_cmb_dedup_mode,     SIGNAL(currentTextChanged(QString)), this, SLOT(_uiCmbDedupModeChanged(QString)));
+    connect(_ui_box_dedup_distance, SIGNAL(valueChanged(int)), this, SLOT(_uiBoxDedupDistanceValueChanged(int)));
+    connect(_ui_box_record_sessions,  SIGNAL(toggled(bool)),     this, SLOT(_uiBoxRecordSessionsToggled(bool)));
+    connect(_ui_box_stream_landmarks, SIGNAL(toggled(bool)),     this, SLOT(_uiBoxStreamLandmarksToggled(bool)));
+    connect(_ui_box_preview_fps,    SIGNAL(valueChanged(int)), this, SLOT(_uiBoxRefreshRateValueChanged(int)));
+    connect(_ui_box_monitor_fps,    SIGNAL(valueChanged(int)), this, SLOT(_uiBoxRefreshRateValueChanged(int)));
+    connect(_ui_box_detection_fps,  SIGNAL(valueChanged(int)), this, SLOT(_uiBoxRefreshRateValueChanged(int)));
+    connect(_ui_box_hud,            SIGNAL(toggled(bool)),     this, SLOT(_uiBoxHudToggled(bool)));
+    connect(_ui_box_tracking,       SIGNAL(toggled(bool)),     this, SLOT(_uiBoxTrackingToggled(bool)));
     connect(_ui_btn_general_reset,  SIGNAL(released()),        this, SLOT(setToCurrentSettings()));
     connect(_ui_btn_general_default,SIGNAL(released()),        this, SLOT(setToDefaultSettings()));
     connect(_ui_btn_bg_set,         SIGNAL(released()),        this, SLOT(_backgroundSettingRequest()));
     connect(_ui_btn_bg_clear,       SIGNAL(released()),        this, SLOT(_backgroundClearingRequest()));
+    connect(_ui_box_freeze_frame,   SIGNAL(toggled(bool)),     this, SIGNAL(freezeFrameRequest(bool)));
+    connect(_ui_btn_calibrate,      SIGNAL(released()),        this, SLOT(_skinColorCalibrationRequest()));
+    connect(_ui_btn_calibration_clear, SIGNAL(released()),     this, SLOT(_skinColorCalibrationClearingRequest()));
     connect(_ui_btn_gesture_add,    SIGNAL(released()),        this, SLOT(_gestureListAdd()));
     connect(_ui_btn_gesture_remove, SIGNAL(released()),        this, SLOT(_gestureListRemove()));
     connect(_ui_lst_gesture,        SIGNAL(itemDoubleClicked(QListWidgetItem*)), this, SLOT(_gestureEdit(QListWidgetItem*)));
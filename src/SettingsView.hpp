@@ -11,6 +11,7 @@
 #include <QSlider>
 #include <QSpinBox>
 #include <QCheckBox>
+#include <QComboBox>
 #include <QPushButton>
 #include <QGroupBox>
 #include <QVBoxLayout>
@@ -21,6 +22,7 @@
 #include <QListWidget>
 #include <QListWidgetItem>
 #include <QLineEdit>
+#include <QRegExpValidator>
 #include <QInputDialog>
 #include <QMessageBox>
 #include <QSizePolicy>
@@ -103,6 +105,33 @@ signals:
      * @see #SettingsView::changeSkinColorLowerBound
      */
     void changeSkinColorUpperBound(const int &h, const int &s, const int &v);
+    /**
+     * @brief changeSkinColorYCrCb is the signal of filtering skin colors in YCrCb color space instead of HSV color space or not.
+     * @param ycrcb : filter in YCrCb color space or not
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCb
+     */
+    void changeSkinColorYCrCb(const bool &ycrcb);
+    /**
+     * @brief changeSkinColorYCrCbLowerBound is the signal of the new lower bound for the skin color filter in YCrCb color space.
+     * @param y : luma
+     * @param cr : red difference
+     * @param cb : blue difference
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCbLowerBound
+     * @see #SettingsView::changeSkinColorYCrCbUpperBound
+     */
+    void changeSkinColorYCrCbLowerBound(const int &y, const int &cr, const int &cb);
+    /**
+     * @brief changeSkinColorYCrCbUpperBound is the signal of the new upper bound for the skin color filter in YCrCb color space.
+     * @param y : luma
+     * @param cr : red difference
+     * @param cb : blue difference
+     *
+     * @see #HandDetector::setSkinColorFilterYCrCbUpperBound
+     * @see #SettingsView::changeSkinColorYCrCbLowerBound
+     */
+    void changeSkinColorYCrCbUpperBound(const int &y, const int &cr, const int &cb);
     /**
      * @brief changeRoiRange is the signal to indicate the new region of interesting area.
      *
@@ -127,6 +156,29 @@ signals:
      * @see #HandDetector::setMorphology
      */
     void changeMorphology(const bool &perform_morphology);
+    /**
+     * @brief changeRefreshRates is the signal of the new refresh rates of the windows and the new detection rate.
+     * @param preview_fps : refresh rate of the video shown on the main window
+     * @param monitor_fps : refresh rate of the images shown on the monitor window
+     * @param detection_fps : rate of detecting hands while not sampling
+     *
+     * @see #GestureSampleCollector::setRefreshRates
+     */
+    void changeRefreshRates(const int &preview_fps, const int &monitor_fps, const int &detection_fps);
+    /**
+     * @brief changeHud is the signal of showing the performance HUD or not.
+     * @param show : the flag to show the HUD or not
+     *
+     * @see #GestureSampleCollector::setHudEnabled
+     */
+    void changeHud(const bool &show);
+    /**
+     * @brief changeTracking is the signal of tracking hands between full detections or not.
+     * @param track : the flag to track hands or not
+     *
+     * @see #GestureSampleCollector::setTrackingEnabled
+     */
+    void changeTracking(const bool &track);
     /**
      * @brief backgroundSettingRequest is the signal of the request for setting background image for the background subtractor.
      *
@@ -141,6 +193,26 @@ signals:
      * @see #HandDetector::clearBackgroundImage
      */
     void backgroundClearingRequest();
+    /**
+     * @brief freezeFrameRequest is the signal of the request for freezing the video on the current frame or not,
+     *        so that the hand detector can be tuned on the frame.
+     * @param freeze : freeze the video or not
+     *
+     * @see #FramePipeline::setFrozen
+     */
+    void freezeFrameRequest(const bool &freeze);
+    /**
+     * @brief skinColorCalibrationRequest is the signal of the request for calibrating the skin color filter on the next frame.
+     *
+     * @see #HandDetector::calibrateSkinColor
+     */
+    void skinColorCalibrationRequest();
+    /**
+     * @brief skinColorCalibrationClearingRequest is the signal of the request for clearing the skin color calibration.
+     *
+     * @see #HandDetector::clearSkinColorCalibration
+     */
+    void skinColorCalibrationClearingRequest();
     /**
      * @brief changeLabelList functions is the signal of the change in gesture label list.
      * @see #TrackingView::reloadLabelList
@@ -157,12 +229,12 @@ public slots:
      */
     void setToDefaultSettings();
     /**
-     * @brief enableBackgroundSetting enables setting image for the background subtractor.
+     * @brief enableBackgroundSetting enables setting image for the background subtractor and freezing the video.
      *        Use this func when the camera is ready.
      */
     void enableBackgroundSetting();
     /**
-     * @brief disableBackgroundSetting disables setting image for the background subtractor.
+     * @brief disableBackgroundSetting disables setting image for the background subtractor and freezing the video.
      *        Use this func when the camera is closed.
      */
     void disableBackgroundSetting();
@@ -182,6 +254,14 @@ public slots:
      * @see #HandDetector::backgroundImageCleared
      */
     void clearBackgroundImage();
+    /**
+     * @brief setSkinColorCalibrated shows if the calibrated skin color filter is in use instead of the skin color bounds.
+     * @param calibrated : the calibrated skin color filter is in use or not
+     *
+     * @see #HandDetector::skinColorCalibrated
+     * @see #HandDetector::skinColorCalibrationCleared
+     */
+    void setSkinColorCalibrated(const bool &calibrated);
 
 private slots:
     void _uiSldHue1ValueChanged(const int &val);
@@ -190,14 +270,28 @@ private slots:
     void _uiSldSaturation2ValueChanged(const int &val);
     void _uiSldValue1ValueChanged(const int &val);
     void _uiSldValue2ValueChanged(const int &val);
+    void _uiBoxYCrCbToggled(const bool &checked);
+    void _uiBoxYCrCbBoundValueChanged(const int &val);
     void _uiSldHorizon1ValueChanged(const int &val);
     void _uiSldHorizon2ValueChanged(const int &val);
     void _uiSldVertical1ValueChanged(const int &val);
     void _uiSldVertical2ValueChanged(const int &val);
     void _uiBoxDetectionAreaValueChanged(const int &val);
     void _uiBoxMorphologyToggled(const bool &checked);
+    void _uiTxtResizeSizesChanged(const QString &text);
+    void _uiCmbOrigCodecChanged(const QString &codec);
+    void _uiBoxOrigCompressionValueChanged(const int &val);
+    void _uiCmbDedupModeChanged(const QString &mode);
+    void _uiBoxDedupDistanceValueChanged(const int &val);
+    void _uiBoxRecordSessionsToggled(const bool &checked);
+    void _uiBoxStreamLandmarksToggled(const bool &checked);
+    void _uiBoxRefreshRateValueChanged(const int &val);
+    void _uiBoxHudToggled(const bool &checked);
+    void _uiBoxTrackingToggled(const bool &checked);
     void _backgroundSettingRequest();
     void _backgroundClearingRequest();
+    void _skinColorCalibrationRequest();
+    void _skinColorCalibrationClearingRequest();
     void _gestureListAdd();
     void _gestureListRemove();
     void _gestureEdit(QListWidgetItem *item);
@@ -212,6 +306,8 @@ private:
     inline void _makeConnections();
 
     inline void _emitSkinColorRangeChangeSignal();
+    inline void _emitSkinColorYCrCbChangeSignal();
+    inline void _enableSkinColorBounds();
     inline void _emitRoiRangeChangeSignal();
     void closeEvent(QCloseEvent *e) override;
 
@@ -236,6 +332,28 @@ private:
     QSlider     *_ui_sld_vertical2;
     QSpinBox    *_ui_box_detection_area;
     QCheckBox   *_ui_box_morphology;
+    QCheckBox   *_ui_box_ycrcb;
+    QSpinBox    *_ui_box_y1;
+    QSpinBox    *_ui_box_y2;
+    QSpinBox    *_ui_box_cr1;
+    QSpinBox    *_ui_box_cr2;
+    QSpinBox    *_ui_box_cb1;
+    QSpinBox    *_ui_box_cb2;
+    QCheckBox   *_ui_box_freeze_frame;
+    QPushButton *_ui_btn_calibrate;
+    QPushButton *_ui_btn_calibration_clear;
+    QLineEdit   *_ui_txt_resize_sizes;
+    QComboBox   *_ui_cmb_orig_codec;
+    QSpinBox    *_ui_box_orig_compression;
+    QComboBox   *_ui_cmb_dedup_mode;
+    QSpinBox    *_ui_box_dedup_distance;
+    QCheckBox   *_ui_box_record_sessions;
+    QCheckBox   *_ui_box_stream_landmarks;
+    QSpinBox    *_ui_box_preview_fps;
+    QSpinBox    *_ui_box_monitor_fps;
+    QSpinBox    *_ui_box_detection_fps;
+    QCheckBox   *_ui_box_hud;
+    QCheckBox   *_ui_box_tracking;
     QPushButton *_ui_btn_general_reset;
     QPushButton *_ui_btn_general_default;
 
@@ -250,10 +368,24 @@ private:
     bool _flag_change_hue = false;
     bool _flag_change_saturation = false;
     bool _flag_change_value = false;
+    bool _flag_change_ycrcb = false;
+    bool _flag_change_ycrcb_bounds = false;
     bool _flag_change_roi_x = false;
     bool _flag_change_roi_y = false;
     bool _flag_change_detection_area = false;
     bool _flag_change_morphology = false;
+    bool _flag_change_resize_sizes = false;
+    bool _flag_change_orig_codec = false;
+    bool _flag_change_orig_compression = false;
+    bool _flag_change_dedup_mode = false;
+    bool _flag_change_dedup_distance = false;
+    bool _flag_change_record_sessions = false;
+    bool _flag_change_stream_landmarks = false;
+    bool _flag_change_refresh_rates = false;
+    bool _flag_change_hud = false;
+    bool _flag_change_tracking = false;
+
+    bool _skin_color_calibrated = false;
 
 };
 
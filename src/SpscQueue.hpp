@@ -0,0 +1,92 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SpscQueue.hpp file contains a template passing values from one thread to another through a ring without locking.
+ */
+#include <QAtomicInt>
+
+#include <vector>
+
+/**
+ * @brief The SpscQueue template is a bounded first-in-first-out queue between one producer thread and one consumer
+ *        thread without locking.
+ *
+ * The slots are allocated once, as a ring whose capacity is rounded up to a power of two. The producer calls
+ * #SpscQueue::push and the consumer #SpscQueue::pop . Neither of them ever waits for the other; a value pushed into
+ * a full queue is refused, so that the producer is never slowed down by a late consumer.
+ *
+ * The positions of both ends run over twice the capacity, so that a full queue is told from an empty one without
+ * wasting a slot.
+ *
+ * **ATTENTION**:
+ *  There should be only one producer thread and only one consumer thread.
+ */
+template <typename T>
+class SpscQueue
+{
+public:
+    /**
+     * @brief SpscQueue is the constructor.
+     * @param capacity : the minimum number of values held
+     */
+    explicit SpscQueue(const int &capacity) :
+        _head(0),
+        _tail(0)
+    {
+        int n = 1;
+        while (n < capacity)
+            n <<= 1;
+        _slots.resize(n);
+        _mask = n - 1;
+        _wrap = 2*n - 1;
+    }
+    /**
+     * @brief push appends a value. It is called by the producer.
+     * @retval true : the value is queued
+     * @retval false : the queue is full, and the value is dropped
+     */
+    bool push(const T &value)
+    {
+        const int tail = _tail.load();
+        if (((tail - _head.loadAcquire()) & _wrap) == capacity())
+            return false;
+        _slots[tail & _mask] = value;
+        _tail.storeRelease((tail + 1) & _wrap);
+        return true;
+    }
+    /**
+     * @brief pop takes the oldest value. It is called by the consumer.
+     * @retval true : a value is taken
+     * @retval false : the queue is empty
+     */
+    bool pop(T &value)
+    {
+        const int head = _head.load();
+        if (head == _tail.loadAcquire())
+            return false;
+        value = _slots[head & _mask];
+        _head.storeRelease((head + 1) & _wrap);
+        return true;
+    }
+    /**
+     * @brief capacity returns the number of values held at most.
+     */
+    int capacity() const
+    {
+        return _mask + 1;
+    }
+
+private:
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    std::vector<T> _slots;
+    int _mask;
+    int _wrap;
+    QAtomicInt _head;
+    QAtomicInt _tail;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,74 @@
+#include "StabilityTrigger.hpp"
+
+#include <algorithm>
+#include <bitset>
+
+StabilityTrigger::StabilityTrigger(const int &frames, const double &min_iou, const double &max_shift) :
+    _frames(frames),
+    _min_iou(min_iou),
+    _max_shift(max_shift),
+    _still(0),
+    _words(0)
+{}
+
+void StabilityTrigger::setFrames(const int &frames)
+{
+    _frames = frames;
+}
+
+bool StabilityTrigger::update(const cv::Mat &filtered_img, const DetectionResult &result)
+{
+    const cv::Rect bound = result.hand_bound & cv::Rect(0, 0, filtered_img.cols, filtered_img.rows);
+    if (!result.detected || bound.area() == 0)
+    {
+        reset();
+        return false;
+    }
+    if (_frames < 2)
+        return true;
+
+    _pack(filtered_img, bound);
+    const cv::Point shift = result.hand_center - _center;
+    if (_still > 0 && filtered_img.size() == _size &&
+            shift.dot(shift) <= _max_shift*_max_shift && _iou(bound) >= _min_iou)
+        ++_still;
+    else
+        _still = 1;
+    _size = filtered_img.size();
+    _bound = bound;
+    _center = result.hand_center;
+    _mask.swap(_last_mask);
+    return _still >= _frames;
+}
+
+void StabilityTrigger::reset()
+{
+    _still = 0;
+}
+
+void StabilityTrigger::_pack(const cv::Mat &filtered_img, const cv::Rect &bound)
+{
+    _words = (filtered_img.cols + 63)/64;
+    _mask.assign(static_cast<std::size_t>(_words)*filtered_img.rows, 0);
+    for (int y = bound.y; y < bound.y + bound.height; ++y)
+    {
+        const uchar *p = filtered_img.ptr<uchar>(y);
+        std::uint64_t *row = _mask.data() + static_cast<std::size_t>(y)*_words;
+        for (int x = bound.x; x < bound.x + bound.width; ++x)
+            row[x >> 6] |= static_cast<std::uint64_t>(p[x] != 0) << (x & 63);
+    }
+}
+
+double StabilityTrigger::_iou(const cv::Rect &bound) const
+{
+    // only the rows covered by either hand may have set bits
+    const int begin = std::min(bound.y, _bound.y);
+    const int end = std::max(bound.y + bound.height, _bound.y + _bound.height);
+    std::size_t intersection = 0, unions = 0;
+    for (std::size_t i = static_cast<std::size_t>(begin)*_words, n = static_cast<std::size_t>(end)*_words; i < n; ++i)
+    {
+        intersection += std::bitset<64>(_mask[i] & _last_mask[i]).count();
+        unions += std::bitset<64>(_mask[i] | _last_mask[i]).count();
+    }
+    return unions > 0 ? static_cast<double>(intersection)/unions : 0;
+}
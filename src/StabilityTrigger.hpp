@@ -0,0 +1,76 @@
+#ifndef STABILITYTRIGGER_H
+#define STABILITYTRIGGER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The StabilityTrigger.hpp file contains the class telling if a detected hand stays still long enough to be sampled.
+ */
+#include <opencv2/opencv.hpp>
+
+#include <cstdint>
+#include <vector>
+
+#include "config.h"
+#include "HandDetector.hpp"
+
+/**
+ * @brief The StabilityTrigger class tells if a hand has stayed still over a number of consecutive detections,
+ *        so that a sample is not taken from a blurry frame in the middle of a motion.
+ *
+ * The hand is still between two detections if the intersection over union of the two hand masks is at least
+ * #STABILITY_MIN_IOU , and the palm center moves no more than #STABILITY_MAX_SHIFT pixels. The masks are packed into
+ * bits, 64 pixels a word, so that the intersection and the union are counted a word at a time.
+ *
+ * **ATTENTION**:
+ *  This class is not thread-safe.
+ */
+class StabilityTrigger
+{
+public:
+    /**
+     * @brief StabilityTrigger is the constructor.
+     * @param frames : the number of consecutive detections on which the hand should stay still
+     * @param min_iou : the minimum intersection over union of two consecutive hand masks
+     * @param max_shift : the maximum distance which the palm center moves between two consecutive detections
+     */
+    explicit StabilityTrigger(const int &frames = DEFAULT_SAMPLING_STABLE_FRAMES,
+                              const double &min_iou = STABILITY_MIN_IOU,
+                              const double &max_shift = STABILITY_MAX_SHIFT);
+
+    /**
+     * @brief setFrames sets the number of consecutive detections on which the hand should stay still.
+     * @param frames : the number of detections, or 0 or 1 to fire on any detected hand
+     */
+    void setFrames(const int &frames);
+    /**
+     * @brief update takes the result of a detection on the next frame.
+     * @param filtered_img : the black-white mask of the detection, see #HandDetector::filtered_img
+     * @param result : the detection result
+     * @retval true : the hand has stayed still on the last given number of detections, including this one
+     * @retval false : otherwise, or no hand is detected
+     */
+    bool update(const cv::Mat &filtered_img, const DetectionResult &result);
+    /**
+     * @brief reset forgets the previous detections.
+     *
+     * It is called when a frame is not detected, so that the next detection is not compared with an older one.
+     */
+    void reset();
+
+private:
+    int _frames;
+    double _min_iou;
+    double _max_shift;
+    int _still;
+    cv::Size _size;
+    cv::Rect _bound;
+    cv::Point _center;
+    int _words;
+    std::vector<std::uint64_t> _mask;
+    std::vector<std::uint64_t> _last_mask;
+
+    inline void _pack(const cv::Mat &filtered_img, const cv::Rect &bound);
+    inline double _iou(const cv::Rect &bound) const;
+};
+
+#endif // STABILITYTRIGGER_H
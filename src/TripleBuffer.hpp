@@ -0,0 +1,96 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The TripleBuffer.hpp file contains a template handing off the latest value from one thread to another without locking.
+ */
+#include <QAtomicInt>
+
+/**
+ * @brief The TripleBuffer template hands off the latest value written by one thread to another thread without locking.
+ *
+ * The writer fills #TripleBuffer::back and calls #TripleBuffer::publish . The reader calls #TripleBuffer::update
+ * whenever it is ready for a new value, e.g. between two frames, and reads #TripleBuffer::front until the next update.
+ * Neither of them ever waits for the other. A value published before the reader takes it is replaced by the next one.
+ *
+ * Three slots are used, one owned by the writer, one by the reader and one in between, so that the writer
+ * can publish again while the reader is still reading the value published previously.
+ *
+ * **ATTENTION**:
+ *  There should be only one writer thread and only one reader thread.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    /**
+     * @brief TripleBuffer is the constructor.
+     * @param value : the initial value of all slots
+     */
+    explicit TripleBuffer(const T &value = T()) :
+        _back(0),
+        _middle(1),
+        _front(2)
+    {
+        for (auto &s : _slots)
+            s = value;
+    }
+    /**
+     * @brief back returns the slot owned by the writer.
+     */
+    T &back()
+    {
+        return _slots[_back];
+    }
+    /**
+     * @brief publish hands off the value in the back slot to the reader. It is called by the writer.
+     */
+    void publish()
+    {
+        _back = _middle.fetchAndStoreOrdered(_back | FLAG_NEW) & INDEX_MASK;
+    }
+    /**
+     * @brief update takes the latest value published. It is called by the reader.
+     * @retval true : a new value is taken into the front slot
+     * @retval false : nothing was published since last time
+     */
+    bool update()
+    {
+        if ((_middle.loadAcquire() & FLAG_NEW) == 0)
+            return false;
+        _front = _middle.fetchAndStoreOrdered(_front) & INDEX_MASK;
+        return true;
+    }
+    /**
+     * @brief pending returns if a value was published but not taken yet. It is called by the reader.
+     */
+    bool pending() const
+    {
+        return (_middle.loadAcquire() & FLAG_NEW) != 0;
+    }
+    /**
+     * @brief front returns the slot owned by the reader.
+     */
+    const T &front() const
+    {
+        return _slots[_front];
+    }
+
+private:
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    enum
+    {
+        INDEX_MASK = 0x3,
+        FLAG_NEW = 0x4
+    };
+
+    T _slots[3];
+    int _back;
+    QAtomicInt _middle;
+    int _front;
+};
+
+#endif // TRIPLEBUFFER_H
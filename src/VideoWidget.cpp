@@ -0,0 +1,132 @@
+#include "VideoWidget.hpp"
+
+#include <QPen>
+#include <QFontDatabase>
+
+VideoWidget::VideoWidget(QWidget *parent) :
+    QWidget(parent),
+    _detected(false),
+    _palm_radius(0)
+{
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void VideoWidget::setFrame(const QPixmap &frame)
+{
+    _frame = frame;
+    update();
+}
+
+void VideoWidget::setOverlay(const QSize &frame_size, const QRect &roi, const DetectionResult &result, const QPoint &offset)
+{
+    _frame_size = frame_size;
+    _roi = roi;
+    _detected = result.detected;
+    _contour.clear();
+    _fingers.clear();
+    if (_detected)
+    {
+        _contour.reserve(static_cast<int>(result.contour.size()));
+        for (const auto &p : result.contour)
+            _contour.append(QPoint(p.x, p.y) + offset);
+        _fingers.reserve(static_cast<int>(result.fingers.size()));
+        for (const auto &p : result.fingers)
+            _fingers.append(QPoint(p.x, p.y) + offset);
+        _hand_bound = QRect(result.hand_bound.x, result.hand_bound.y,
+                            result.hand_bound.width, result.hand_bound.height).translated(offset);
+        _hand_center = QPoint(result.hand_center.x, result.hand_center.y) + offset;
+        _palm_radius = static_cast<int>(result.palm_radius);
+    }
+    update();
+}
+
+void VideoWidget::setHud(const QString &text)
+{
+    if (_hud == text)
+        return;
+    _hud = text;
+    update();
+}
+
+void VideoWidget::clear()
+{
+    _frame = QPixmap();
+    _frame_size = QSize();
+    _roi = QRect();
+    _detected = false;
+    _contour.clear();
+    _fingers.clear();
+    update();
+}
+
+void VideoWidget::paintEvent(QPaintEvent *)
+{
+    const QSize frame_size = _frame_size.isEmpty() ? _frame.size() : _frame_size;
+    if (frame_size.isEmpty())
+        return;
+
+    QRect target(QPoint(0, 0), frame_size.scaled(size(), Qt::KeepAspectRatio));
+    target.moveCenter(rect().center());
+
+    QPainter painter(this);
+    if (_frame.isNull())
+        painter.fillRect(target, Qt::white);
+    else if (_frame.size() == target.size())
+        painter.drawPixmap(target.topLeft(), _frame);
+    else
+        painter.drawPixmap(target, _frame);
+
+    if (!_hud.isEmpty())
+    {
+        painter.save();
+        _drawHud(painter, target);
+        painter.restore();
+    }
+
+    if (_roi.isEmpty() && !_detected)
+        return;
+
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.translate(target.topLeft());
+    painter.scale(static_cast<qreal>(target.width())/frame_size.width(),
+                  static_cast<qreal>(target.height())/frame_size.height());
+    painter.setBrush(Qt::NoBrush);
+
+    QPen pen(Qt::green, 2);
+    pen.setCosmetic(true);
+    if (!_roi.isEmpty())
+    {
+        painter.setPen(pen);
+        painter.drawRect(_roi);
+    }
+    if (!_detected)
+        return;
+
+    painter.setPen(pen);
+    painter.drawRect(_hand_bound);
+    pen.setColor(Qt::gray);
+    painter.setPen(pen);
+    painter.drawPolygon(_contour);
+    pen.setColor(Qt::blue);
+    painter.setPen(pen);
+    for (const auto &p : _fingers)
+        painter.drawLine(p, _hand_center);
+    pen.setColor(Qt::red);
+    painter.setPen(pen);
+    for (const auto &p : _fingers)
+        painter.drawEllipse(p, 10, 10);
+    painter.drawEllipse(_hand_center, _palm_radius, _palm_radius);
+    painter.setBrush(Qt::red);
+    painter.drawEllipse(_hand_center, 4, 4);
+}
+
+void VideoWidget::_drawHud(QPainter &painter, const QRect &target)
+{
+    painter.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    const int margin = 4;
+    QRect bound = painter.fontMetrics().boundingRect(target.adjusted(2*margin, 2*margin, 0, 0),
+                                                     Qt::AlignLeft | Qt::AlignTop, _hud);
+    painter.fillRect(bound.adjusted(-margin, -margin, margin, margin), QColor(0, 0, 0, 160));
+    painter.setPen(Qt::white);
+    painter.drawText(bound, Qt::AlignLeft | Qt::AlignTop, _hud);
+}
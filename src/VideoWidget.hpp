@@ -0,0 +1,74 @@
+#ifndef VIDEOWIDGET_H
+#define VIDEOWIDGET_H
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The VideoWidget.hpp file contains the widget displaying a video frame with the detection drawn over it.
+ */
+#include <QWidget>
+#include <QPixmap>
+#include <QPolygon>
+#include <QVector>
+#include <QPaintEvent>
+#include <QPainter>
+
+#include "HandDetector.hpp"
+
+/**
+ * @brief The VideoWidget class displays a video frame, and draws the region of interesting and the hand geometry
+ *        estimated by #HandDetector over it.
+ *
+ * The frame is blitted as it is, centered and scaled to fit the widget keeping its aspect ratio,
+ * without any pixel of the frame being painted. The overlays are drawn by QPainter in the coordinates of the frame
+ * with cosmetic pens, so that they stay crisp and keep their line widths at any size of the widget.
+ *
+ * If no frame is set, a white canvas of the size given by #VideoWidget::setOverlay is drawn under the overlays.
+ */
+class VideoWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit VideoWidget(QWidget *parent = 0);
+    /**
+     * @brief setFrame sets the frame to be displayed.
+     * @param frame : the frame, which may be smaller than the frame given to #VideoWidget::setOverlay
+     */
+    void setFrame(const QPixmap &frame);
+    /**
+     * @brief setOverlay sets the geometry drawn over the frame.
+     * @param frame_size : size of the frame in which the coordinates are given
+     * @param roi : the region of interesting, which is not drawn if empty
+     * @param result : the hand geometry, which is not drawn if nothing was detected
+     * @param offset : offset of the coordinates of the hand geometry, e.g. the top-left corner of the region of interesting
+     */
+    void setOverlay(const QSize &frame_size, const QRect &roi, const DetectionResult &result, const QPoint &offset = QPoint());
+    /**
+     * @brief setHud sets the text drawn at the top-left corner of the frame, e.g. the performance statistics.
+     * @param text : the text, which may contain multiple lines and is not drawn if empty
+     */
+    void setHud(const QString &text);
+    /**
+     * @brief clear clears the frame and the overlays.
+     */
+    void clear();
+
+protected:
+    void paintEvent(QPaintEvent *e) override;
+
+private:
+    void _drawHud(QPainter &painter, const QRect &target);
+
+private:
+    QPixmap _frame;
+    QSize _frame_size;
+    QRect _roi;
+    bool _detected;
+    QPolygon _contour;
+    QVector<QPoint> _fingers;
+    QRect _hand_bound;
+    QPoint _hand_center;
+    int _palm_radius;
+    QString _hud;
+};
+
+#endif // VIDEOWIDGET_H
@@ -0,0 +1,147 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include <algorithm>
+#include <functional>
+
+#include "CvQtImgConvertor.hpp"
+#include "HandDetector.hpp"
+
+namespace
+{
+    QTextStream out(stdout);
+    volatile uchar sink;
+
+    void run(const QString &name, const int &iterations, const std::function<uchar()> &func)
+    {
+        // warm up the reused buffers and the caches
+        for (int i = 0; i < 3; ++i)
+            sink = func();
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < iterations; ++i)
+            sink = func();
+        out << name.leftJustified(36, ' ')
+            << QString::number(timer.nsecsElapsed()/1000.0/iterations, 'f', 2).rightJustified(10, ' ')
+            << " us" << endl;
+    }
+
+    void benchmarkMat2QImage(const cv::Mat &mat, const QString &name, const int &iterations)
+    {
+        run(name + " -> QImage", iterations, [&]() {
+            QImage img = CvQtImgConvertor::cvMat2QImage(mat);
+            return img.constBits()[0];
+        });
+        run(name + " -> QImage (deep copy)", iterations, [&]() {
+            QImage img = CvQtImgConvertor::cvMat2QImage(mat).copy();
+            return img.constBits()[0];
+        });
+    }
+
+    void benchmarkQImage2Mat(const QImage &img, const QString &name, const int &iterations)
+    {
+        run(name + " -> Mat", iterations, [&]() {
+            cv::Mat mat = CvQtImgConvertor::qImage2CvMat(img);
+            return mat.data[0];
+        });
+        run(name + " -> Mat (deep copy)", iterations, [&]() {
+            cv::Mat mat = CvQtImgConvertor::qImage2CvMat(img).clone();
+            return mat.data[0];
+        });
+    }
+
+    // the skin color filters as performed by HandDetector, with and without the background mask
+    void benchmarkSkinColorFilters(const cv::Mat &img, const cv::Mat &mask, const int &iterations)
+    {
+        const cv::Scalar hsv_lower(DEFAULT_SKIN_COLOR_MIN_H, DEFAULT_SKIN_COLOR_MIN_S, DEFAULT_SKIN_COLOR_MIN_V);
+        const cv::Scalar hsv_upper(DEFAULT_SKIN_COLOR_MAX_H, DEFAULT_SKIN_COLOR_MAX_S, DEFAULT_SKIN_COLOR_MAX_V);
+        const cv::Scalar ycrcb_lower(DEFAULT_SKIN_COLOR_MIN_Y, DEFAULT_SKIN_COLOR_MIN_CR, DEFAULT_SKIN_COLOR_MIN_CB);
+        const cv::Scalar ycrcb_upper(DEFAULT_SKIN_COLOR_MAX_Y, DEFAULT_SKIN_COLOR_MAX_CR, DEFAULT_SKIN_COLOR_MAX_CB);
+        const cv::Mat background = mask == 0;
+        cv::Mat converted, skin;
+        run("Skin filter HSV", iterations, [&]() {
+            cv::cvtColor(img, converted, cv::COLOR_RGB2HSV);
+            cv::inRange(converted, hsv_lower, hsv_upper, skin);
+            return skin.data[0];
+        });
+        run("Skin filter HSV (masked)", iterations, [&]() {
+            cv::cvtColor(img, converted, cv::COLOR_RGB2HSV);
+            converted.setTo(HandDetector::COLOR_BLACK, background);
+            cv::inRange(converted, hsv_lower, hsv_upper, skin);
+            return skin.data[0];
+        });
+        run("Skin filter cvtColor YCrCb", iterations, [&]() {
+            cv::cvtColor(img, converted, cv::COLOR_BGR2YCrCb);
+            cv::inRange(converted, ycrcb_lower, ycrcb_upper, skin);
+            return skin.data[0];
+        });
+        run("Skin filter YCrCb", iterations, [&]() {
+            HandDetector::filterSkinColorYCrCb(img, cv::Mat(), ycrcb_lower, ycrcb_upper, skin);
+            return skin.data[0];
+        });
+        run("Skin filter YCrCb (masked)", iterations, [&]() {
+            HandDetector::filterSkinColorYCrCb(img, mask, ycrcb_lower, ycrcb_upper, skin);
+            return skin.data[0];
+        });
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("benchmark");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measure the time of converting frames between cv::Mat and QImage in each format, "
+                                     "and of filtering skin colors in each color space.");
+    parser.addHelpOption();
+    QCommandLineOption iterations_option(QStringList() << "n" << "iterations",
+                                         "Number of conversions per format.", "n", "200");
+    QCommandLineOption width_option(QStringList() << "W" << "width", "Width of the frames.", "pixels", "1280");
+    QCommandLineOption height_option(QStringList() << "H" << "height", "Height of the frames.", "pixels", "720");
+    parser.addOption(iterations_option);
+    parser.addOption(width_option);
+    parser.addOption(height_option);
+    parser.process(a);
+
+    const int iterations = std::max(1, parser.value(iterations_option).toInt());
+    const int width = std::max(1, parser.value(width_option).toInt());
+    const int height = std::max(1, parser.value(height_option).toInt());
+
+    out << "Converting " << width << "x" << height << " frames, " << iterations << " times each" << endl;
+
+    cv::Mat mat_8uc1(height, width, CV_8UC1);
+    cv::Mat mat_8uc3(height, width, CV_8UC3);
+    cv::Mat mat_8uc4(height, width, CV_8UC4);
+    cv::randu(mat_8uc1, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::randu(mat_8uc3, cv::Scalar::all(0), cv::Scalar::all(255));
+    cv::randu(mat_8uc4, cv::Scalar::all(0), cv::Scalar::all(255));
+    benchmarkMat2QImage(mat_8uc1, "CV_8UC1", iterations);
+    benchmarkMat2QImage(mat_8uc3, "CV_8UC3", iterations);
+    benchmarkMat2QImage(mat_8uc4, "CV_8UC4", iterations);
+
+    QImage img_rgb32 = CvQtImgConvertor::cvMat2QImage(mat_8uc4).convertToFormat(QImage::Format_RGB32);
+    benchmarkQImage2Mat(img_rgb32, "Format_RGB32", iterations);
+    benchmarkQImage2Mat(img_rgb32.convertToFormat(QImage::Format_ARGB32), "Format_ARGB32", iterations);
+    benchmarkQImage2Mat(img_rgb32.convertToFormat(QImage::Format_RGB888), "Format_RGB888", iterations);
+#if QT_VERSION >= QT_VERSION_CHECK(5,14,0)
+    benchmarkQImage2Mat(img_rgb32.convertToFormat(QImage::Format_BGR888), "Format_BGR888", iterations);
+#endif
+#if QT_VERSION >= QT_VERSION_CHECK(5,5,0)
+    benchmarkQImage2Mat(img_rgb32.convertToFormat(QImage::Format_Grayscale8), "Format_Grayscale8", iterations);
+#endif
+    benchmarkQImage2Mat(img_rgb32.convertToFormat(QImage::Format_RGB16), "Format_RGB16", iterations);
+
+    std::vector<uchar> pixels(static_cast<size_t>(width)*height*3);
+    run("swapRedBlue (in place)", iterations, [&]() {
+        CvQtImgConvertor::swapRedBlue(pixels.data(), pixels.data(), width*height);
+        return pixels[0];
+    });
+
+    cv::Mat mask(height, width, CV_8UC1);
+    cv::randu(mask, cv::Scalar::all(0), cv::Scalar::all(2));
+    benchmarkSkinColorFilters(mat_8uc3, mask*255, iterations);
+    return 0;
+}
@@ -0,0 +1,72 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "DatasetChecker.hpp"
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("checker");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Verify a dataset made by the sample collector and rebuild its index.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("dataset", "Path of the dataset directory.");
+    QCommandLineOption fix_option(QStringList() << "f" << "fix",
+                                  "Remove invalid samples, regenerate resized samples and rewrite manifests.");
+    QCommandLineOption threads_option(QStringList() << "j" << "threads",
+                                      "Number of checking threads. Use the ideal thread count by default.",
+                                      "n", "0");
+    QCommandLineOption quiet_option(QStringList() << "q" << "quiet", "Print the summary only.");
+    parser.addOption(fix_option);
+    parser.addOption(threads_option);
+    parser.addOption(quiet_option);
+    parser.process(a);
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    QTextStream out(stdout);
+    const QString dataset = parser.positionalArguments().first();
+    const bool fix = parser.isSet(fix_option);
+    DatasetChecker checker(parser.value(threads_option).toInt());
+    DatasetChecker::Report report;
+    QElapsedTimer timer;
+    timer.start();
+    if (!checker.check(dataset, fix, report))
+    {
+        QTextStream(stderr) << "Invalid dataset directory: " << dataset << endl;
+        return 1;
+    }
+
+    if (!parser.isSet(quiet_option))
+        for (const auto &issue : report.issues)
+            out << "[" << DatasetChecker::describe(issue.problem) << "] " << issue.file_path << endl;
+
+    qint64 problems = 0;
+    out << "Checked " << report.files << " files of " << report.labels << " labels in "
+        << timer.elapsed() << " ms." << endl
+        << "Valid samples: " << report.samples << endl;
+    for (int p = DatasetChecker::PROBLEM_NONE + 1; p < DatasetChecker::PROBLEM_COUNT; ++p)
+    {
+        if (report.problems[p] == 0)
+            continue;
+        out << "  " << DatasetChecker::describe(static_cast<DatasetChecker::PROBLEM>(p)) << ": "
+            << report.problems[p] << endl;
+        if (p != DatasetChecker::PROBLEM_UNKNOWN_FILE)
+            problems += report.problems[p];
+    }
+    if (report.manifest_dropped > 0 || report.manifest_missing > 0)
+        out << "Manifest records without a valid sample: " << report.manifest_dropped << endl
+            << "Valid samples without a manifest record: " << report.manifest_missing << endl;
+    if (fix)
+        out << "Removed " << report.removed << " files, regenerated " << report.regenerated
+            << " resized samples." << endl;
+    if (!report.indexed)
+    {
+        QTextStream(stderr) << "Failed to write the index file." << endl;
+        return 1;
+    }
+    return problems > 0 && !fix ? 2 : 0;
+}
@@ -43,12 +43,125 @@
  * @brief SETTING_APPLICATION_NAME is the name of the system.
  */
 #define SETTING_APPLICATION_NAME "GestureSampleCollector"
+#ifndef SETTING_SYNC_DELAY
+/**
+ * @brief SETTING_SYNC_DELAY is the delay, in milliseconds, after which changed settings are written into the setting file.
+ *
+ * Settings changed within the delay are written together.
+ */
+#  define SETTING_SYNC_DELAY 1000
+#endif
 #ifndef CAMERA_FPS
 /**
  * @brief CAMERA_FPS is the FPS of the camera
  */
 #  define CAMERA_FPS 50
 #endif
+#ifndef DEFAULT_PREVIEW_FPS
+/**
+ * @brief DEFAULT_PREVIEW_FPS is the default refresh rate of the video shown on the main window.
+ */
+#  define DEFAULT_PREVIEW_FPS 30
+#endif
+#ifndef DEFAULT_MONITOR_FPS
+/**
+ * @brief DEFAULT_MONITOR_FPS is the default refresh rate of the images shown on the monitor window.
+ */
+#  define DEFAULT_MONITOR_FPS 10
+#endif
+#ifndef DEFAULT_DETECTION_FPS
+/**
+ * @brief DEFAULT_DETECTION_FPS is the default rate of detecting hands while not sampling.
+ *
+ * While sampling, a frame is always detected when a sample is due.
+ */
+#  define DEFAULT_DETECTION_FPS CAMERA_FPS
+#endif
+#ifndef DEFAULT_SHOW_HUD
+/**
+ * @brief DEFAULT_SHOW_HUD is the default flag of showing the performance HUD over the video on the main window.
+ */
+#  define DEFAULT_SHOW_HUD false
+#endif
+#ifndef HUD_REFRESH_INTERVAL
+/**
+ * @brief HUD_REFRESH_INTERVAL is the interval, in milliseconds, of refreshing the performance HUD.
+ */
+#  define HUD_REFRESH_INTERVAL 500
+#endif
+#ifndef MOTION_GATE_THRESHOLD
+/**
+ * @brief MOTION_GATE_THRESHOLD is the mean absolute difference, in gray levels, of a block of the region of interesting
+ *        above which the scene is considered changed, so that hands are detected again for the monitor window.
+ *
+ * The gate is disabled if it is not positive. Samples are always detected on their own frames.
+ *
+ * @see #MotionGate
+ */
+#  define MOTION_GATE_THRESHOLD 6
+#endif
+#ifndef MOTION_GATE_WIDTH
+/**
+ * @brief MOTION_GATE_WIDTH is the width, in pixels, to which the region of interesting is downsampled before being compared.
+ */
+#  define MOTION_GATE_WIDTH 64
+#endif
+#ifndef MOTION_GATE_BLOCK_SIZE
+/**
+ * @brief MOTION_GATE_BLOCK_SIZE is the size, in pixels of the downsampled region of interesting, of the blocks compared.
+ */
+#  define MOTION_GATE_BLOCK_SIZE 8
+#endif
+#ifndef MOTION_GATE_REFRESH_FRAMES
+/**
+ * @brief MOTION_GATE_REFRESH_FRAMES is the maximum number of detections skipped in a row by the motion gate.
+ *
+ * The next detection is performed however still the scene is, so that a slow drift is caught up eventually.
+ */
+#  define MOTION_GATE_REFRESH_FRAMES 30
+#endif
+#ifndef DEFAULT_HAND_TRACKING
+/**
+ * @brief DEFAULT_HAND_TRACKING is the default flag of tracking hands by optical flow between full detections for the monitor window.
+ */
+#  define DEFAULT_HAND_TRACKING false
+#endif
+#ifndef TRACKING_INTERVAL
+/**
+ * @brief TRACKING_INTERVAL is the number of frames after which a tracked hand is detected again by #HandDetector .
+ *
+ * @see #HandTracker
+ */
+#  define TRACKING_INTERVAL 10
+#endif
+#ifndef TRACKING_MIN_CONFIDENCE
+/**
+ * @brief TRACKING_MIN_CONFIDENCE is the minimum share of the points of a hand tracked reliably, below which
+ *        the hand is considered lost and detected again by #HandDetector .
+ */
+#  define TRACKING_MIN_CONFIDENCE 0.7
+#endif
+#ifndef TRACKING_MAX_ERROR
+/**
+ * @brief TRACKING_MAX_ERROR is the maximum distance, in pixels, between a point and the one tracked back from
+ *        its tracked position, within which the point is considered tracked reliably.
+ */
+#  define TRACKING_MAX_ERROR 1.0
+#endif
+#ifndef LOG_MAX_ENTRIES
+/**
+ * @brief LOG_MAX_ENTRIES is the maximum number of messages kept on the text panel of the main window.
+ *
+ * The oldest messages are dropped once more are logged.
+ */
+#  define LOG_MAX_ENTRIES 200
+#endif
+#ifndef LOG_FLUSH_INTERVAL
+/**
+ * @brief LOG_FLUSH_INTERVAL is the minimum interval, in milliseconds, between two repaints of the text panel of the main window.
+ */
+#  define LOG_FLUSH_INTERVAL 100
+#endif
 #ifndef DEFAULT_ROI_MARGIN_LEFT
 /**
  * @brief DEFAULT_ROI_MARGIN_LEFT is the default left margin, in pixel, of the region of interesting on the frame captured by the camera.
@@ -134,6 +247,48 @@
   */
 #  define DEFAULT_SKIN_COLOR_MAX_V 255
 #endif
+#ifndef DEFAULT_SKIN_COLOR_YCRCB
+/**
+  * @brief DEFAULT_SKIN_COLOR_YCRCB is the default flag of filtering skin colors in YCrCb color space instead of HSV color space.
+  */
+#  define DEFAULT_SKIN_COLOR_YCRCB false
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MIN_Y
+/**
+  * @brief DEFAULT_SKIN_COLOR_MIN_Y is the default lower bound of the skin color filter for luma in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MIN_Y 40
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MAX_Y
+/**
+  * @brief DEFAULT_SKIN_COLOR_MAX_Y is the default upper bound of the skin color filter for luma in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MAX_Y 255
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MIN_CR
+/**
+  * @brief DEFAULT_SKIN_COLOR_MIN_CR is the default lower bound of the skin color filter for red difference in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MIN_CR 133
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MAX_CR
+/**
+  * @brief DEFAULT_SKIN_COLOR_MAX_CR is the default upper bound of the skin color filter for red difference in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MAX_CR 173
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MIN_CB
+/**
+  * @brief DEFAULT_SKIN_COLOR_MIN_CB is the default lower bound of the skin color filter for blue difference in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MIN_CB 77
+#endif
+#ifndef DEFAULT_SKIN_COLOR_MAX_CB
+/**
+  * @brief DEFAULT_SKIN_COLOR_MAX_CB is the default upper bound of the skin color filter for blue difference in YCrCb color space.
+  */
+#  define DEFAULT_SKIN_COLOR_MAX_CB 127
+#endif
 
 #ifndef DEFAULT_SKIN_DETECTION_AREA
 /**
@@ -147,6 +302,25 @@
  */
 #  define DEFAULT_SKIN_MORPHOLOGY true
 #endif
+#ifndef SKIN_CALIBRATION_H_BINS
+/**
+ * @brief SKIN_CALIBRATION_H_BINS is the number of bins for hue of the histogram built by the skin color calibration.
+ */
+#  define SKIN_CALIBRATION_H_BINS 30
+#endif
+#ifndef SKIN_CALIBRATION_S_BINS
+/**
+ * @brief SKIN_CALIBRATION_S_BINS is the number of bins for saturation of the histogram built by the skin color calibration.
+ */
+#  define SKIN_CALIBRATION_S_BINS 32
+#endif
+#ifndef SKIN_CALIBRATION_THRESHOLD
+/**
+ * @brief SKIN_CALIBRATION_THRESHOLD is the minimum count, relative to the highest one, of a bin of the calibration
+ *        histogram whose colors are considered as skin colors.
+ */
+#  define SKIN_CALIBRATION_THRESHOLD 0.05
+#endif
 
 #ifndef DEFAULT_SAMPLING_AMOUNT_PER_TIME
 /**
@@ -160,6 +334,61 @@
  */
 #  define DEFAULT_SAMPLING_INTERVAL 150
 #endif
+#ifndef DEFAULT_SAMPLING_STABLE_FRAMES
+/**
+ * @brief DEFAULT_SAMPLING_STABLE_FRAMES is the number of consecutive frames on which the hand should stay still
+ *        before a sample is taken, or 0 to take samples at #DEFAULT_SAMPLING_INTERVAL regardless.
+ *
+ * @see #StabilityTrigger
+ */
+#  define DEFAULT_SAMPLING_STABLE_FRAMES 3
+#endif
+#ifndef DEFAULT_SAMPLING_CLIP_LENGTH
+/**
+ * @brief DEFAULT_SAMPLING_CLIP_LENGTH is the number of consecutive frames stored as one clip per sampling action
+ *        for dynamic gestures, or 0 to take a still per sampling action.
+ *
+ * @see #ClipCodec
+ */
+#  define DEFAULT_SAMPLING_CLIP_LENGTH 0
+#endif
+#ifndef SAMPLING_CLIP_MAX_LENGTH
+/**
+ * @brief SAMPLING_CLIP_MAX_LENGTH is the maximum number of frames in a clip.
+ */
+#  define SAMPLING_CLIP_MAX_LENGTH 256
+#endif
+#ifndef DEFAULT_BURST_SECONDS
+/**
+ * @brief DEFAULT_BURST_SECONDS is the default length, in seconds, of the frames kept before sampling starts,
+ *        or 0 to keep no frame.
+ *
+ * @see #BurstBuffer
+ */
+#  define DEFAULT_BURST_SECONDS 0
+#endif
+#ifndef BURST_MAX_SECONDS
+/**
+ * @brief BURST_MAX_SECONDS is the maximum length, in seconds, of the frames kept before sampling starts.
+ *
+ * A second of frames at #CAMERA_FPS takes about 30 MB at 640x480.
+ */
+#  define BURST_MAX_SECONDS 10
+#endif
+#ifndef STABILITY_MIN_IOU
+/**
+ * @brief STABILITY_MIN_IOU is the minimum intersection over union of the hand masks on two consecutive frames,
+ *        above which the hand is considered still.
+ */
+#  define STABILITY_MIN_IOU 0.9
+#endif
+#ifndef STABILITY_MAX_SHIFT
+/**
+ * @brief STABILITY_MAX_SHIFT is the maximum distance, in pixels, which the palm center moves between two consecutive
+ *        frames, within which the hand is considered still.
+ */
+#  define STABILITY_MAX_SHIFT 4
+#endif
 
 // #ifndef SAMPLE_SIZE_WIDTH
 // /**
@@ -193,6 +422,169 @@
  */
 #  define SAMPLE_PROC_FORMAT "PGM"
 #endif
+#ifndef SAMPLE_CLIP_FORMAT
+/**
+ * @brief SAMPLE_CLIP_FORMAT is the format of the sample clip, as well as the name of the directory storing clips.
+ *
+ * @see #ClipCodec
+ */
+#  define SAMPLE_CLIP_FORMAT "GSCC"
+#endif
+#ifndef DEFAULT_SAMPLE_ORIG_CODEC
+/**
+ * @brief DEFAULT_SAMPLE_ORIG_CODEC is the default codec, `BMP`, `PNG`, `WEBP` or `QOI`, using which to store the original sample image.
+ *
+ * All codecs are lossless. The original images are stored in the directory named by #SAMPLE_ORIG_FORMAT whatever the codec is.
+ */
+#  define DEFAULT_SAMPLE_ORIG_CODEC SAMPLE_ORIG_FORMAT
+#endif
+#ifndef DEFAULT_SAMPLE_ORIG_COMPRESSION
+/**
+ * @brief DEFAULT_SAMPLE_ORIG_COMPRESSION is the default compression level, from 0 to 9, of the `PNG` codec.
+ */
+#  define DEFAULT_SAMPLE_ORIG_COMPRESSION 3
+#endif
+#ifndef SAMPLE_SESSION_LOG_FILE_NAME
+/**
+ * @brief SAMPLE_SESSION_LOG_FILE_NAME is the name of the file, in the directory of each label, into which the statistics of each sampling session are appended.
+ */
+#  define SAMPLE_SESSION_LOG_FILE_NAME "sessions.tsv"
+#endif
+#ifndef DEFAULT_SAMPLE_RESIZE_SIZES
+/**
+ * @brief DEFAULT_SAMPLE_RESIZE_SIZES is the default sizes, separated by comma, e.g. `"128,64,32"`, to which a sample is resized additionally. No resizing is done if it is empty.
+ */
+#  define DEFAULT_SAMPLE_RESIZE_SIZES ""
+#endif
+#ifndef DEFAULT_SAMPLE_DEDUP_MODE
+/**
+ * @brief DEFAULT_SAMPLE_DEDUP_MODE is the default treatment, `OFF`, `FLAG` or `SKIP`, of a sample nearly identical to
+ *        a recent one of the same label.
+ *
+ * A flagged sample is stored as usual, with #SampleManifest::FLAG_DUPLICATE set in the manifest.
+ *
+ * @see #SampleHashIndex
+ */
+#  define DEFAULT_SAMPLE_DEDUP_MODE "FLAG"
+#endif
+#ifndef DEFAULT_SAMPLE_DEDUP_DISTANCE
+/**
+ * @brief DEFAULT_SAMPLE_DEDUP_DISTANCE is the default maximum Hamming distance, from 0 to 64, between the perceptual hashes
+ *        of two samples considered nearly identical.
+ */
+#  define DEFAULT_SAMPLE_DEDUP_DISTANCE 4
+#endif
+#ifndef SAMPLE_DEDUP_WINDOW
+/**
+ * @brief SAMPLE_DEDUP_WINDOW is the number of the latest samples of a label with which a new sample is compared.
+ */
+#  define SAMPLE_DEDUP_WINDOW 1024
+#endif
+#ifndef SAMPLE_WRITER_QUEUE_SIZE
+/**
+ * @brief SAMPLE_WRITER_QUEUE_SIZE is the maximum number of images waiting to be stored.
+ */
+#  define SAMPLE_WRITER_QUEUE_SIZE 256
+#endif
+#ifndef DEFAULT_RECORD_SESSIONS
+/**
+ * @brief DEFAULT_RECORD_SESSIONS is the default flag of recording the frames of each sampling session into a video.
+ *
+ * @see #SessionRecorder
+ */
+#  define DEFAULT_RECORD_SESSIONS false
+#endif
+#ifndef RECORDING_CODEC
+/**
+ * @brief RECORDING_CODEC is the FourCC of the lossless codec by which sampling sessions are recorded.
+ */
+#  define RECORDING_CODEC "FFV1"
+#endif
+#ifndef RECORDING_FILE_SUFFIX
+/**
+ * @brief RECORDING_FILE_SUFFIX is the suffix of the video files of recorded sampling sessions, which selects the container.
+ */
+#  define RECORDING_FILE_SUFFIX ".mkv"
+#endif
+#ifndef RECORDING_SIDECAR_SUFFIX
+/**
+ * @brief RECORDING_SIDECAR_SUFFIX is the suffix appended to the path of a recorded video to name the file
+ *        holding the timestamp, the region of interesting and the label of each frame.
+ */
+#  define RECORDING_SIDECAR_SUFFIX ".tsv"
+#endif
+#ifndef DEFAULT_STREAM_LANDMARKS
+/**
+ * @brief DEFAULT_STREAM_LANDMARKS is the default flag of streaming the hand landmarks of each frame of a sampling session into a file.
+ *
+ * @see #LandmarkStream
+ */
+#  define DEFAULT_STREAM_LANDMARKS false
+#endif
+#ifndef LANDMARK_STREAM_FILE_SUFFIX
+/**
+ * @brief LANDMARK_STREAM_FILE_SUFFIX is the suffix of the files of landmark streams.
+ */
+#  define LANDMARK_STREAM_FILE_SUFFIX ".lmk"
+#endif
+#ifndef LANDMARK_STREAM_QUEUE_SIZE
+/**
+ * @brief LANDMARK_STREAM_QUEUE_SIZE is the maximum number of frames whose landmarks wait to be written.
+ *
+ * The landmarks of a frame are dropped if the queue is full.
+ */
+#  define LANDMARK_STREAM_QUEUE_SIZE 256
+#endif
+#ifndef LANDMARK_STREAM_FLUSH_INTERVAL
+/**
+ * @brief LANDMARK_STREAM_FLUSH_INTERVAL is the interval, in milliseconds, at which the queued landmarks are written.
+ */
+#  define LANDMARK_STREAM_FLUSH_INTERVAL 100
+#endif
+#ifndef LANDMARK_MAX_FINGERS
+/**
+ * @brief LANDMARK_MAX_FINGERS is the maximum number of finger tops stored per frame in a landmark stream.
+ *
+ * Change in this parameter changes the format of landmark streams.
+ */
+#  define LANDMARK_MAX_FINGERS 8
+#endif
+#ifndef RECORDING_QUEUE_SIZE
+/**
+ * @brief RECORDING_QUEUE_SIZE is the maximum number of frames waiting to be recorded.
+ */
+#  define RECORDING_QUEUE_SIZE 64
+#endif
+#ifndef SAMPLE_MANIFEST_FILE_NAME
+/**
+ * @brief SAMPLE_MANIFEST_FILE_NAME is the name of the file storing the metadata of samples in the directory of each label.
+ */
+#  define SAMPLE_MANIFEST_FILE_NAME "manifest.gscm"
+#endif
+#ifndef SAMPLE_MANIFEST_CHUNK_SIZE
+/**
+ * @brief SAMPLE_MANIFEST_CHUNK_SIZE is the maximum number of metadata records buffered before being written into the manifest file.
+ */
+#  define SAMPLE_MANIFEST_CHUNK_SIZE 64
+#endif
+#ifndef DATASET_READER_PACK_BATCH_SIZE
+/**
+ * @brief DATASET_READER_PACK_BATCH_SIZE is the number of samples decoded per batch when packing a dataset.
+ */
+#  define DATASET_READER_PACK_BATCH_SIZE 512
+#endif
+#ifndef DATASET_INDEX_FILE_NAME
+/**
+ * @brief DATASET_INDEX_FILE_NAME is the name of the file, in the dataset directory, listing the samples verified by the checker.
+ */
+#  define DATASET_INDEX_FILE_NAME "index.gsix"
+#endif
+#ifndef DATASET_CHECKER_CHUNK_SIZE
+/**
+ * @brief DATASET_CHECKER_CHUNK_SIZE is the number of files validated by one task of the checker.
+ */
+#  define DATASET_CHECKER_CHUNK_SIZE 2048
+#endif
 /**
  * @brief INITIAL_GESTURE_LISTS is a default list of 47 gestures
  */
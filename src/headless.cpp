@@ -0,0 +1,307 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QScopedPointer>
+#include <QSettings>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+#include "config.h"
+#include "Settings.hpp"
+#include "HandDetector.hpp"
+#include "SampleCollector.hpp"
+#include "FramePipeline.hpp"
+#include "StabilityTrigger.hpp"
+#include "ClipBuffer.hpp"
+#include "SessionRecorder.hpp"
+
+namespace
+{
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    // copy the settings with the overrides applied into a temporary file, so that the given ones are never modified
+    bool prepareSettings(const QString &config_file, const QStringList &overrides, QTemporaryFile &file)
+    {
+        if (!config_file.isEmpty() && !QFileInfo(config_file).isFile())
+        {
+            err << "Config file not found: " << config_file << endl;
+            return false;
+        }
+        if (!file.open())
+        {
+            err << "Failed to create a temporary config file." << endl;
+            return false;
+        }
+        file.close();
+
+        QScopedPointer<QSettings> source(config_file.isEmpty() ?
+                                             new QSettings(QSettings::IniFormat,
+                                                           SETTING_SCOPE,
+                                                           SETTING_ORGANIZATION_NAME,
+                                                           SETTING_APPLICATION_NAME) :
+                                             new QSettings(config_file, QSettings::IniFormat));
+        QSettings target(file.fileName(), QSettings::IniFormat);
+        for (const auto &key : source->allKeys())
+            target.setValue(key, source->value(key));
+        for (const auto &item : overrides)
+        {
+            const int sep = item.indexOf('=');
+            if (sep < 1)
+            {
+                err << "Invalid setting, expected key=value: " << item << endl;
+                return false;
+            }
+            target.setValue(item.left(sep).trimmed(), item.mid(sep + 1).trimmed());
+        }
+        target.sync();
+        return target.status() == QSettings::NoError;
+    }
+
+    QString perUnit(const qint64 &nsecs, const qint64 &count)
+    {
+        return QString::number(count > 0 ? nsecs/1e6/count : 0, 'f', 3);
+    }
+
+    QString rate(const qint64 &count, const qint64 &nsecs)
+    {
+        return QString::number(nsecs > 0 ? count*1e9/nsecs : 0, 'f', 1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("headless");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Collect samples from a camera or a video without any window.\n"
+                                     "Settings are read from the settings of the sample collector, "
+                                     "or from the given INI file, using the same keys.\n"
+                                     "A sampling session recorded by the sample collector is read with "
+                                     "the region of interesting and the time of each frame recorded.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("folder", "Path of the folder storing samples.");
+    parser.addPositionalArgument("label", "Name of the gesture label.");
+    QCommandLineOption input_option(QStringList() << "i" << "input",
+                                    "Index of a camera, or path of a video file or an image sequence, e.g. img_%04d.png.",
+                                    "source", "0");
+    QCommandLineOption config_option(QStringList() << "c" << "config",
+                                     "INI file to read settings from instead of the settings of the sample collector.",
+                                     "file");
+    QCommandLineOption set_option(QStringList() << "s" << "set",
+                                  "Override a setting, e.g. -s sampling-interval=0. Can be repeated.",
+                                  "key=value");
+    QCommandLineOption amount_option(QStringList() << "n" << "amount",
+                                     "Number of samples to collect. Collect until the source ends if 0.",
+                                     "n", "0");
+    QCommandLineOption width_option(QStringList() << "W" << "width", "Width of the frames.", "pixels", "640");
+    QCommandLineOption height_option(QStringList() << "H" << "height", "Height of the frames.", "pixels", "480");
+    QCommandLineOption background_option(QStringList() << "b" << "background",
+                                         "Use the first frame as the background image for background subtraction.");
+    parser.addOption(input_option);
+    parser.addOption(config_option);
+    parser.addOption(set_option);
+    parser.addOption(amount_option);
+    parser.addOption(width_option);
+    parser.addOption(height_option);
+    QCommandLineOption sampled_option(QStringList() << "S" << "sampled",
+                                      "Take samples only from the frames of a recorded session which were sampled when recorded.");
+    parser.addOption(background_option);
+    parser.addOption(sampled_option);
+    parser.process(a);
+    if (parser.positionalArguments().size() != 2)
+        parser.showHelp(1);
+
+    QTemporaryFile config_file;
+    if (!prepareSettings(parser.value(config_option), parser.values(set_option), config_file))
+        return 1;
+    Settings::setConfigFile(config_file.fileName());
+    Settings *settings = Settings::getInstance();
+
+    const QString input = parser.value(input_option);
+    bool camera;
+    const int device = input.toInt(&camera);
+    cv::VideoCapture source;
+    if (camera)
+        source.open(device);
+    else
+        source.open(input.toStdString());
+    if (!source.isOpened())
+    {
+        err << "Failed to open the source: " << input << endl;
+        return 1;
+    }
+    // a recorded session comes with the region of interesting and the time of each frame in its sidecar
+    std::vector<SessionRecorder::Frame> recorded;
+    const bool recording = !camera && SessionRecorder::readSidecar(input, recorded);
+    const bool sampled_only = parser.isSet(sampled_option);
+    if (sampled_only && !recording)
+    {
+        err << "No recorded session at the source: " << input << endl;
+        return 1;
+    }
+    // the sampling interval is measured in the time of the source, so that a video is processed as fast as possible
+    double source_fps = camera ? 0 : source.get(cv::CAP_PROP_FPS);
+    if (source_fps <= 0)
+        source_fps = CAMERA_FPS;
+
+    HandDetector detector;
+    detector.setSkinColorFilterLowerBound(settings->skin_color_min_H, settings->skin_color_min_S, settings->skin_color_min_V);
+    detector.setSkinColorFilterUpperBound(settings->skin_color_max_H, settings->skin_color_max_S, settings->skin_color_max_V);
+    detector.setSkinColorFilterYCrCb(settings->skin_color_ycrcb);
+    detector.setSkinColorFilterYCrCbLowerBound(settings->skin_color_min_Y, settings->skin_color_min_Cr, settings->skin_color_min_Cb);
+    detector.setSkinColorFilterYCrCbUpperBound(settings->skin_color_max_Y, settings->skin_color_max_Cr, settings->skin_color_max_Cb);
+    detector.setDetectionArea(settings->skin_detection_area);
+    detector.setMorphology(settings->skin_morphology);
+    if (parser.isSet(background_option))
+        detector.setBackgroundImage();
+
+    SampleCollector collector;
+    const QString folder = parser.positionalArguments().at(0);
+    const QString label = parser.positionalArguments().at(1);
+    if (!collector.setStoragePath(folder, label))
+    {
+        err << "Failed to make the storage folder at " << folder << endl;
+        return 1;
+    }
+
+    // the frames of a recorded session were fitted when captured
+    const cv::Size frame_size = recording ? cv::Size(static_cast<int>(source.get(cv::CAP_PROP_FRAME_WIDTH)),
+                                                     static_cast<int>(source.get(cv::CAP_PROP_FRAME_HEIGHT)))
+                                          : cv::Size(std::max(1, parser.value(width_option).toInt()),
+                                                     std::max(1, parser.value(height_option).toInt()));
+    const int amount = std::max(0, parser.value(amount_option).toInt());
+    cv::Rect roi = cv::Rect(frame_size.width*settings->roi_start_x/100,
+                                  frame_size.height*settings->roi_start_y/100,
+                                  frame_size.width*(settings->roi_end_x - settings->roi_start_x)/100,
+                                  frame_size.height*(settings->roi_end_y - settings->roi_start_y)/100)
+                         & cv::Rect(0, 0, frame_size.width, frame_size.height);
+    if (roi.area() == 0 && !recording)
+    {
+        err << "Empty region of interesting." << endl;
+        return 1;
+    }
+
+    qint64 frames = 0, detections = 0, misses = 0, unstable = 0, samples = 0, last_sample = 0;
+    qint64 read_time = 0, detect_time = 0, sample_time = 0;
+    bool stored = true;
+    cv::Mat frame;
+    QElapsedTimer clock, timer;
+    StabilityTrigger stability(settings->sampling_stable_frames);
+    ClipBuffer clip(settings->sampling_clip_length);
+    const qint64 start_time = QDateTime::currentMSecsSinceEpoch();
+    collector.beginSession();
+    clock.start();
+    while (amount == 0 || samples < amount)
+    {
+        timer.start();
+        if ((recording && frames >= static_cast<qint64>(recorded.size())) || !source.read(frame) || frame.empty())
+            break;
+        if (!recording)
+            FramePipeline::fitFrame(frame, frame_size);
+        read_time += timer.nsecsElapsed();
+
+        qint64 now;
+        bool sampled = false;
+        if (recording)
+        {
+            const auto &r = recorded[frames];
+            now = r.timestamp - recorded.front().timestamp;
+            roi = r.roi & cv::Rect(0, 0, frame.cols, frame.rows);
+            sampled = r.sampled;
+        }
+        else
+            now = camera ? clock.elapsed() : static_cast<qint64>(frames*1000/source_fps);
+        ++frames;
+        // the frames of a clip being assembled are consecutive
+        if (clip.size() == 0 &&
+                (sampled_only ? !sampled
+                              : samples > 0 && now - last_sample < settings->sampling_interval && !detector.waitting_bg))
+        {
+            stability.reset();
+            continue;
+        }
+        if (roi.area() == 0)
+            continue;
+
+        timer.start();
+        const bool detected = detector.detect(frame(roi));
+        detect_time += timer.nsecsElapsed();
+        ++detections;
+        const bool still = clip.length() > 0 || stability.update(detector.filtered_img, detector.result);
+        if (!detected)
+        {
+            clip.clear();
+            ++misses;
+            continue;
+        }
+        if (!still && !sampled_only)
+        {
+            ++unstable;
+            continue;
+        }
+
+        timer.start();
+        SampleManifest::Record record = FramePipeline::sampleRecord(&detector, roi);
+        // a sample from a recorded session keeps the time when it was captured
+        if (recording)
+            record.timestamp = recorded[frames - 1].timestamp;
+        if (clip.length() > 0)
+        {
+            // the frames of a video are timed by the source
+            const bool completed = clip.push(detector.extracted_img, detector.result.hand_bound, roi,
+                                             recording ? record.timestamp : start_time + now);
+            if (completed)
+                stored = collector.sampleClip(clip.masks(), clip.timestamps(), clip.offset());
+            sample_time += timer.nsecsElapsed();
+            if (!completed)
+                continue;
+        }
+        else
+        {
+            stored = collector.sample(detector.interesting_img, detector.extracted_img, record);
+            sample_time += timer.nsecsElapsed();
+        }
+        if (!stored)
+            break;
+        last_sample = now;
+        // a sample skipped as a duplicate restarts the interval but is not counted
+        if (collector.skipped() == 0)
+            ++samples;
+    }
+    const qint64 process_time = clock.nsecsElapsed();
+    const auto stats = collector.endSession();
+    const qint64 total_time = clock.nsecsElapsed();
+
+    out << "Source: " << input << (camera ? " (camera)" : recording ? " (recorded session)" : "") << ", "
+        << frame_size.width << "x" << frame_size.height << " frames, ROI "
+        << roi.width << "x" << roi.height << "+" << roi.x << "+" << roi.y << endl
+        << "Processed " << frames << " frames in " << QString::number(process_time/1e6, 'f', 1) << " ms: "
+        << rate(frames, process_time) << " fps" << endl
+        << "  read and resize: " << perUnit(read_time, frames) << " ms/frame" << endl
+        << "  detection:       " << perUnit(detect_time, detections) << " ms/frame, "
+        << detections << " frames, " << misses << " without hand, " << unstable << " with hand moving" << endl
+        << "  sampling:        " << perUnit(sample_time, samples) << " ms/sample" << endl
+        << "Collected " << samples << (clip.length() > 0 ? " clips in " : " samples in ") << QString::number(total_time/1e6, 'f', 1) << " ms: "
+        << rate(samples, total_time) << (clip.length() > 0 ? " clips/s" : " samples/s") << endl;
+    if (stats.samples > 0)
+        out << "Original images were stored as " << QString::fromLatin1(stats.codec)
+            << (stats.compression < 0 ? QString() : QString(" (level %1)").arg(stats.compression)) << ": "
+            << QString::number(stats.encode_time, 'f', 2) << " ms, "
+            << QString::number(stats.file_size/1024, 'f', 1) << " KB per sample" << endl;
+    if (stats.duplicates > 0)
+        out << stats.duplicates << " samples were nearly identical to recent ones and were "
+            << (settings->sample_dedup_mode == "SKIP" ? "skipped" : "flagged in the manifest") << endl;
+    out << "Samples were stored at " << collector.storage_path << endl;
+
+    if (!stored)
+        err << "Sampling terminated. Failed to store a sample." << endl;
+    if (stats.failures > 0)
+        err << "Failed to write " << stats.failures << " sample images." << endl;
+    return !stored || stats.failures > 0 ? 2 : 0;
+}
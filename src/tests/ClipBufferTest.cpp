@@ -0,0 +1,66 @@
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ClipBufferTest.cpp file checks that #ClipBuffer assembles clips of a moving hand.
+ */
+#include <iostream>
+
+#include "ClipBuffer.hpp"
+
+namespace
+{
+    int failures = 0;
+
+    void check(const bool &condition, const char *what)
+    {
+        if (condition)
+            return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+
+    cv::Mat handMask(const cv::Rect &bound)
+    {
+        cv::Mat mask(bound.height, bound.width, CV_8UC1, cv::Scalar(255));
+        return mask;
+    }
+}
+
+int main()
+{
+    const cv::Rect roi(10, 20, 100, 80);
+    // a hand moving and changing its shape, so that each crop has its own size and position
+    const cv::Rect bounds[] = {cv::Rect(5, 5, 30, 40), cv::Rect(12, 8, 34, 38),
+                               cv::Rect(20, 10, 28, 45), cv::Rect(85, 60, 30, 30)};
+
+    ClipBuffer clip(4);
+    check(!clip.push(handMask(bounds[0]), bounds[0], roi, 1000), "the 1st frame does not complete a clip");
+    check(!clip.push(handMask(bounds[1]), bounds[1], roi, 1033), "the 2nd frame does not complete a clip");
+    check(!clip.push(handMask(bounds[2]), bounds[2], roi, 1066), "the 3rd frame does not complete a clip");
+    check(clip.push(handMask(bounds[3]), bounds[3], roi, 1100), "masks of different sizes complete a clip");
+    check(clip.size() == 4, "the completed clip has all frames");
+    check(clip.offset() == roi.tl(), "the offset is the region of interesting");
+    check(clip.timestamps().front() == 1000 && clip.timestamps().back() == 1100, "the timestamps are kept");
+    for (int i = 0; i < 4; ++i)
+    {
+        const cv::Mat &mask = clip.masks()[i];
+        check(mask.size() == roi.size() && mask.type() == CV_8UC1, "each mask covers the region of interesting");
+        // the last hand crosses the border of the region of interesting and is clipped
+        const cv::Rect bound = bounds[i] & cv::Rect(0, 0, roi.width, roi.height);
+        check(cv::countNonZero(mask) == bound.area(), "only the hand is set on the mask");
+        check(cv::countNonZero(mask(bound)) == bound.area(), "the hand is placed at its bound");
+    }
+
+    // the next push starts a new clip
+    check(!clip.push(handMask(bounds[0]), bounds[0], roi, 1133), "a new clip starts after a completed one");
+    check(clip.size() == 1, "the new clip has one frame");
+    // a moved region of interesting restarts the clip
+    check(!clip.push(handMask(bounds[1]), bounds[1], roi + cv::Point(1, 0), 1166), "a moved region restarts the clip");
+    check(clip.size() == 1, "the restarted clip has one frame");
+    clip.clear();
+    check(clip.size() == 0, "clear drops the current clip");
+
+    if (failures == 0)
+        std::cout << "All checks passed." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The ClipCodecTest.cpp file checks that #ClipCodec decodes the clips it encodes and rejects truncated ones.
+ */
+#include <algorithm>
+#include <iostream>
+
+#include "ClipCodec.hpp"
+
+namespace
+{
+    int failures = 0;
+
+    void check(const bool &condition, const char *what)
+    {
+        if (condition)
+            return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+
+    bool sameMask(const cv::Mat &a, const cv::Mat &b)
+    {
+        if (a.size() != b.size() || b.type() != CV_8UC1)
+            return false;
+        for (int y = 0; y < a.rows; ++y)
+            for (int x = 0; x < a.cols; ++x)
+                if ((a.ptr<uchar>(y)[x] != 0) != (b.ptr<uchar>(y)[x] == 255) ||
+                    (b.ptr<uchar>(y)[x] != 0 && b.ptr<uchar>(y)[x] != 255))
+                    return false;
+        return true;
+    }
+
+    bool roundTrip(const ClipCodec::Clip &clip, std::vector<uchar> &buffer)
+    {
+        ClipCodec::Clip decoded;
+        if (!ClipCodec::encode(clip, buffer) ||
+            !ClipCodec::decode(buffer.data(), buffer.size(), decoded) ||
+            decoded.masks.size() != clip.masks.size() ||
+            decoded.timestamps != clip.timestamps ||
+            decoded.offset != clip.offset)
+            return false;
+        for (size_t t = 0; t < clip.masks.size(); ++t)
+            if (!sameMask(clip.masks[t], decoded.masks[t]))
+                return false;
+        return true;
+    }
+
+    // a hand-like blob moving right by one pixel per frame
+    ClipCodec::Clip movingBlob(const int &width, const int &height, const int &frames)
+    {
+        ClipCodec::Clip clip;
+        for (int t = 0; t < frames; ++t)
+        {
+            cv::Mat mask(height, width, CV_8UC1, cv::Scalar(0));
+            for (int y = height/4; y < height*3/4; ++y)
+                for (int x = t + width/4; x < std::min(width, t + width/2); ++x)
+                    mask.ptr<uchar>(y)[x] = 255;
+            clip.masks.push_back(mask);
+            clip.timestamps.push_back(1000 + 33*t);
+        }
+        clip.offset = cv::Point(10, 20);
+        return clip;
+    }
+}
+
+int main()
+{
+    std::vector<uchar> buffer;
+    // header of 24 bytes followed by the timestamps
+    const auto payload = [](const ClipCodec::Clip &clip) { return 24 + 8*clip.masks.size(); };
+
+    // 13 x 7 = 91 bits per frame, so that each frame is padded to whole 64-bit words
+    ClipCodec::Clip odd = movingBlob(13, 7, 5);
+    check(roundTrip(odd, buffer), "masks not filling whole words round-trip");
+    check(ClipCodec::isClip(buffer.data(), buffer.size()), "an encoded clip has the magic");
+
+    // 64 x 3 bits per frame, each row filling a word exactly, including a fully set frame
+    ClipCodec::Clip aligned = movingBlob(64, 3, 3);
+    aligned.masks.push_back(cv::Mat(3, 64, CV_8UC1, cv::Scalar(255)));
+    aligned.timestamps.push_back(2000);
+    check(roundTrip(aligned, buffer), "masks filling whole words round-trip");
+
+    // the first pixel is set, so that the encoding starts with a run of no 0s
+    ClipCodec::Clip leading = movingBlob(13, 7, 3);
+    leading.masks.front().ptr<uchar>(0)[0] = 255;
+    leading.masks.back().ptr<uchar>(6)[12] = 255;
+    check(roundTrip(leading, buffer), "masks starting with a set pixel round-trip");
+    check(buffer.size() > payload(leading) && buffer[payload(leading)] == 0,
+          "a leading set pixel is encoded as a zero-length run");
+
+    // truncated files, with the payload size in the header kept or fixed up to the shortened payload
+    check(ClipCodec::encode(odd, buffer), "a clip is encoded");
+    ClipCodec::Clip decoded;
+    std::vector<uchar> truncated(buffer.begin(), buffer.end() - 1);
+    check(!ClipCodec::decode(truncated.data(), truncated.size(), decoded), "a truncated file is rejected");
+    const uint32_t payload_size = static_cast<uint32_t>(truncated.size() - payload(odd));
+    for (int i = 0; i < 4; ++i)
+        truncated[16 + i] = static_cast<uchar>(payload_size >> (8*i));
+    check(!ClipCodec::decode(truncated.data(), truncated.size(), decoded), "a truncated payload is rejected");
+    check(!ClipCodec::decode(buffer.data(), 20, decoded), "a truncated header is rejected");
+
+    if (failures == 0)
+        std::cout << "All checks passed." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
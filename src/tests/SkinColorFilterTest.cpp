@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @author Pei Xu, xupei0610 at gmail.com
+ * @brief The SkinColorFilterTest.cpp file checks that #HandDetector::filterSkinColorYCrCb marks the same pixels as
+ *        `cv::cvtColor` with `cv::COLOR_BGR2YCrCb` followed by `cv::inRange` over all 2^24 colors.
+ */
+#include <iostream>
+
+#include "HandDetector.hpp"
+
+namespace
+{
+    int failures = 0;
+
+    void check(const bool &condition, const char *what)
+    {
+        if (condition)
+            return;
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+
+    // every BGR color once, in a 4096 x 4096 image
+    cv::Mat allColors()
+    {
+        cv::Mat colors(4096, 4096, CV_8UC3);
+        for (int y = 0; y < colors.rows; ++y)
+        {
+            uchar *p = colors.ptr<uchar>(y);
+            for (int x = 0; x < colors.cols; ++x, p += 3)
+            {
+                const int c = y*colors.cols + x;
+                p[0] = c & 0xFF;
+                p[1] = (c >> 8) & 0xFF;
+                p[2] = c >> 16;
+            }
+        }
+        return colors;
+    }
+
+    void checkBounds(const cv::Mat &colors, const cv::Mat &mask,
+                     const cv::Scalar &lower, const cv::Scalar &upper, const char *what)
+    {
+        cv::Mat converted, expected, skin;
+        cv::cvtColor(colors, converted, cv::COLOR_BGR2YCrCb);
+        cv::inRange(converted, lower, upper, expected);
+
+        HandDetector::filterSkinColorYCrCb(colors, cv::Mat(), lower, upper, skin);
+        check(cv::countNonZero(expected != skin) == 0, what);
+
+        // the background mask is applied in the same pass
+        HandDetector::filterSkinColorYCrCb(colors, mask, lower, upper, skin);
+        check(cv::countNonZero((expected & mask) != skin) == 0, what);
+    }
+}
+
+int main()
+{
+    const cv::Mat colors = allColors();
+    cv::Mat mask(colors.size(), CV_8UC1);
+    cv::randu(mask, cv::Scalar::all(0), cv::Scalar::all(2));
+    mask *= 255;
+
+    checkBounds(colors, mask,
+                cv::Scalar(DEFAULT_SKIN_COLOR_MIN_Y, DEFAULT_SKIN_COLOR_MIN_CR, DEFAULT_SKIN_COLOR_MIN_CB),
+                cv::Scalar(DEFAULT_SKIN_COLOR_MAX_Y, DEFAULT_SKIN_COLOR_MAX_CR, DEFAULT_SKIN_COLOR_MAX_CB),
+                "the default bounds match cvtColor and inRange");
+    checkBounds(colors, mask, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 255),
+                "the full bounds match cvtColor and inRange");
+    // Cr of pure red saturates at 255, and Cb of colors without blue nearly reaches 0
+    checkBounds(colors, mask, cv::Scalar(0, 255, 0), cv::Scalar(255, 255, 255),
+                "the saturated upper bounds match cvtColor and inRange");
+    checkBounds(colors, mask, cv::Scalar(0, 0, 0), cv::Scalar(255, 255, 1),
+                "the saturated lower bounds match cvtColor and inRange");
+    checkBounds(colors, mask, cv::Scalar(60, 140, 90), cv::Scalar(200, 170, 120),
+                "narrow bounds match cvtColor and inRange");
+    checkBounds(colors, mask, cv::Scalar(0, 200, 0), cv::Scalar(255, 100, 255),
+                "empty bounds match cvtColor and inRange");
+
+    if (failures == 0)
+        std::cout << "All checks passed." << std::endl;
+    return failures == 0 ? 0 : 1;
+}